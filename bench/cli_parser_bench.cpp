@@ -0,0 +1,73 @@
+// Times the `docker ps` fallback parse: the istringstream + getline loop the
+// CLI paths used before DelimitedParser, against DelimitedParser itself.
+//
+//   cmake -S . -B build -DBUILD_BENCHMARKS=ON -DCMAKE_BUILD_TYPE=Release
+//   build/cli_parser_bench [lines]
+
+#include "cli_parser.h"
+#include "docker_commands.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+typedef DelimitedParser<ContainerInfo, &ContainerInfo::id, &ContainerInfo::name,
+                        &ContainerInfo::state, &ContainerInfo::status,
+                        &ContainerInfo::image> ContainerParser;
+
+std::vector<ContainerInfo> ParseWithStreams(const std::string& output) {
+    std::vector<ContainerInfo> containers;
+    std::istringstream stream(output);
+    std::string line;
+    while (std::getline(stream, line)) {
+        if (line.empty()) continue;
+        std::istringstream lineStream(line);
+        ContainerInfo info;
+        std::getline(lineStream, info.id, '|');
+        std::getline(lineStream, info.name, '|');
+        std::getline(lineStream, info.state, '|');
+        std::getline(lineStream, info.status, '|');
+        std::getline(lineStream, info.image, '|');
+        containers.push_back(info);
+    }
+    return containers;
+}
+
+template <typename Fn>
+double BestOfFive(Fn fn, size_t& rows) {
+    double best = 1e9;
+    for (int run = 0; run < 5; ++run) {
+        auto start = std::chrono::steady_clock::now();
+        rows = fn().size();
+        std::chrono::duration<double, std::milli> took = std::chrono::steady_clock::now() - start;
+        if (took.count() < best) best = took.count();
+    }
+    return best;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    std::string output;
+    char line[256];
+    for (size_t i = 0; i < count; ++i) {
+        snprintf(line, sizeof(line), "%012zx|service-%zu|running|Up %zu minutes|nginx:1.%zu\n",
+                 i, i, i % 60, i % 30);
+        output += line;
+    }
+
+    size_t streamRows = 0, parserRows = 0;
+    double streams = BestOfFive([&output] { return ParseWithStreams(output); }, streamRows);
+    double parser = BestOfFive([&output] { return ContainerParser::Parse(output); }, parserRows);
+    if (streamRows != count || parserRows != count) return 1;
+
+    printf("%zu lines\n", count);
+    printf("  istringstream + getline  %8.2f ms\n", streams);
+    printf("  DelimitedParser          %8.2f ms\n", parser);
+    return 0;
+}
@@ -0,0 +1,131 @@
+// Counts what one refresh costs, from the fetch result to the rows shown in
+// the list: copying the Info vectors the way the tracker, the event payload
+// and the list used to, against building one SnapshotTable and sharing it.
+//
+//   cmake -S . -B build -DBUILD_BENCHMARKS=ON -DCMAKE_BUILD_TYPE=Release
+//   build/snapshot_table_bench [containers]
+
+#include "resource_snapshot.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <malloc.h>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+
+size_t allocations = 0;
+size_t liveBytes = 0;
+
+}  // namespace
+
+void* operator new(size_t size) {
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    ++allocations;
+    liveBytes += malloc_usable_size(p);
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    if (!p) return;
+    liveBytes -= malloc_usable_size(p);
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    operator delete(p);
+}
+
+namespace {
+
+const int kTicks = 20;
+const char* const kStatuses[] = {"Up 2 minutes", "Up 3 hours", "Exited (0) 5 minutes ago",
+                                 "Created"};
+
+std::vector<ContainerInfo> MakeContainers(size_t count) {
+    std::vector<ContainerInfo> containers(count);
+    char buf[64];
+    for (size_t i = 0; i < count; ++i) {
+        ContainerInfo& c = containers[i];
+        snprintf(buf, sizeof(buf), "%012zx", i * 2654435761u);
+        c.id = buf;
+        snprintf(buf, sizeof(buf), "project_service-%zu_1", i);
+        c.name = buf;
+        c.status = kStatuses[i % 4];
+        c.state = i % 4 < 2 ? "running" : "exited";
+        snprintf(buf, sizeof(buf), "registry.example.com/team/app-%zu:latest", i % 50);
+        c.image = buf;
+    }
+    return containers;
+}
+
+double Millis(std::chrono::steady_clock::time_point start) {
+    std::chrono::duration<double, std::milli> took = std::chrono::steady_clock::now() - start;
+    return took.count();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000;
+    const std::vector<ContainerInfo> fetched = MakeContainers(count);
+
+    // Before: the model, the published copy, the event payload and the list
+    // each held their own vector; the model and the list outlived the tick.
+    std::vector<ContainerInfo> model, list;
+    size_t before = allocations;
+    size_t base = liveBytes;
+    auto start = std::chrono::steady_clock::now();
+    for (int tick = 0; tick < kTicks; ++tick) {
+        model = fetched;
+        std::vector<ContainerInfo> published = model;
+        std::vector<ContainerInfo> payload = published;
+        list = payload;
+    }
+    const double oldMs = Millis(start) / kTicks;
+    const size_t oldAllocs = (allocations - before) / kTicks;
+    const size_t oldBytes = liveBytes - base;
+    model.clear();
+    model.shrink_to_fit();
+    list.clear();
+    list.shrink_to_fit();
+
+    // After: one table, shared by pointer.
+    ResourceSnapshot snapshot, listed;
+    before = allocations;
+    base = liveBytes;
+    start = std::chrono::steady_clock::now();
+    for (int tick = 0; tick < kTicks; ++tick) {
+        snapshot.containers = ContainerTable::Build(fetched);
+        ResourceSnapshot published = snapshot;
+        ResourceSnapshot payload = published;
+        listed = payload;
+    }
+    const double newMs = Millis(start) / kTicks;
+    const size_t newAllocs = (allocations - before) / kTicks;
+    const size_t newBytes = liveBytes - base;
+
+    // A patch rebuilds the table with one row replaced.
+    ContainerInfo changed = fetched[count / 2];
+    changed.status = "Up 1 second";
+    before = allocations;
+    start = std::chrono::steady_clock::now();
+    ContainerTable::Builder next(snapshot.containers->size());
+    for (const auto& row : *snapshot.containers) {
+        next.Add(row.id == changed.id ? ContainerRow::From(changed) : row);
+    }
+    snapshot.containers = next.Finish();
+    const double patchMs = Millis(start);
+    const size_t patchAllocs = allocations - before;
+
+    printf("%zu containers, 50 images, 4 statuses, %d ticks\n", count, kTicks);
+    printf("  vectors: %8zu allocations/refresh  %6.2f MB retained  %6.2f ms\n", oldAllocs,
+           oldBytes / 1e6, oldMs);
+    printf("  tables:  %8zu allocations/refresh  %6.2f MB retained  %6.2f ms\n", newAllocs,
+           newBytes / 1e6, newMs);
+    printf("  patch one row: %zu allocations, %.2f ms\n", patchAllocs, patchMs);
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include "bulk_executor.h"
+#include "worker_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+namespace {
+
+// Failures listed by name in a summary before it is cut short.
+const size_t kMaxListedFailures = 5;
+
+std::atomic<size_t> maxConcurrency(BulkExecutor::kDefaultConcurrency);
+
+// The caller is one of the workers, so the pool needs one thread less.
+WorkerPool& Pool() {
+    static WorkerPool pool(maxConcurrency - 1);
+    return pool;
+}
+
+// Shared with the pool tasks, which may start after Run() has returned: by
+// then every object is taken and they leave without touching the rest.
+struct Batch {
+    std::vector<BulkItemResult> results;
+    BulkExecutor::Operation operation;
+    BulkExecutor::ProgressCallback progress;
+    std::atomic<size_t> next;
+    std::atomic<bool> cancelled;
+    std::mutex mutex;
+    std::condition_variable finished;
+    size_t completed = 0;
+    int done = 0;
+
+    Batch() : next(0), cancelled(false) {}
+
+    void Work() {
+        const size_t total = results.size();
+        for (;;) {
+            size_t i = next++;
+            if (i >= total) return;
+
+            BulkItemResult& result = results[i];
+            const bool skipped = cancelled;
+            if (skipped) {
+                result.error = "cancelled";
+            } else {
+                result.success = operation(result.target, &result.error);
+                if (result.success) result.error.clear();
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!skipped) {
+                ++done;
+                if (progress && !progress(done, static_cast<int>(total))) cancelled = true;
+            }
+            if (++completed == total) finished.notify_all();
+        }
+    }
+};
+
+}  // namespace
+
+const size_t BulkExecutor::kDefaultConcurrency;
+
+void BulkExecutor::SetMaxConcurrency(size_t concurrency) {
+    maxConcurrency = std::max(concurrency, kDefaultConcurrency);
+}
+
+BulkExecutor::BulkExecutor(size_t concurrency)
+    : concurrency(concurrency > 0 ? concurrency : 1) {}
+
+std::vector<BulkItemResult> BulkExecutor::Run(const std::vector<std::string>& targets,
+                                              const Operation& operation,
+                                              const ProgressCallback& progress) const {
+    const size_t total = targets.size();
+    auto batch = std::make_shared<Batch>();
+    batch->results.resize(total);
+    for (size_t i = 0; i < total; ++i) batch->results[i].target = targets[i];
+    if (total == 0) return batch->results;
+    batch->operation = operation;
+    batch->progress = progress;
+
+    // The calling thread takes one of the slots and finishes the batch on
+    // its own if the pool is busy, so nested or parallel runs cannot stall.
+    const size_t extra = std::min(concurrency, total) - 1;
+    for (size_t i = 0; i < extra; ++i) {
+        if (!Pool().Submit([batch] { batch->Work(); }, WorkerPool::Interactive)) break;
+    }
+    batch->Work();
+
+    std::unique_lock<std::mutex> lock(batch->mutex);
+    batch->finished.wait(lock, [&batch, total] { return batch->completed == total; });
+    return std::move(batch->results);
+}
+
+std::string BulkExecutor::Summarize(const std::vector<BulkItemResult>& results) {
+    size_t failed = 0;
+    std::string details;
+    for (const auto& r : results) {
+        if (r.success) continue;
+        if (failed < kMaxListedFailures) {
+            details += failed ? "; " : ": ";
+            details += r.target;
+            if (!r.error.empty()) details += ": " + r.error;
+        }
+        ++failed;
+    }
+    if (failed == 0) return "";
+
+    std::string summary = std::to_string(failed) + " of " + std::to_string(results.size()) +
+                          " failed" + details;
+    if (failed > kMaxListedFailures) summary += "; ...";
+    return summary;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+struct BulkItemResult {
+    std::string target;
+    bool success = false;
+    std::string error;
+};
+
+// Applies one operation to many objects (stop, rm, rmi, volume rm) with at
+// most `concurrency` of them in flight, reporting the outcome per object.
+// The calling thread works through the objects itself, helped by threads of
+// a WorkerPool shared by every executor in the process.
+class BulkExecutor {
+public:
+    static const size_t kDefaultConcurrency = 8;
+
+    // Sizes the shared pool for runs of up to `concurrency` objects at a
+    // time; never below kDefaultConcurrency. Only takes effect before the
+    // first Run() in the process.
+    static void SetMaxConcurrency(size_t concurrency);
+
+    typedef std::function<bool(const std::string& target, std::string* error)> Operation;
+    // Called after each finished object, one call at a time; returning false
+    // cancels the objects that have not been started yet.
+    typedef std::function<bool(int done, int total)> ProgressCallback;
+
+    explicit BulkExecutor(size_t concurrency = kDefaultConcurrency);
+
+    // Results are in the order of `targets`.
+    std::vector<BulkItemResult> Run(const std::vector<std::string>& targets,
+                                    const Operation& operation,
+                                    const ProgressCallback& progress = ProgressCallback()) const;
+
+    // "2 of 5 failed: abc: reason; def: reason", or empty if all succeeded.
+    static std::string Summarize(const std::vector<BulkItemResult>& results);
+
+private:
+    size_t concurrency;
+};
@@ -0,0 +1,99 @@
+#include "byte_size.h"
+#include <cstdio>
+
+namespace {
+
+const char kPrefixes[] = "kmgtpe";
+
+bool IsSpace(char c) {
+    return c == ' ' || c == '\t';
+}
+
+bool IsDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+std::string Format(double bytes, double base, const char* const units[], const char* separator) {
+    int unit = 0;
+    while (bytes >= base && unit < 6) {
+        bytes /= base;
+        ++unit;
+    }
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.3g%s%s", bytes, separator, units[unit]);
+    return buf;
+}
+
+}  // namespace
+
+bool ParseByteSize(const StringRef& text, int64_t& bytes) {
+    const char* p = text.begin();
+    const char* const end = text.end();
+    while (p < end && IsSpace(*p)) ++p;
+
+    // Whole and fractional digits are read as integers; only the fraction
+    // is scaled in floating point, so whole byte counts stay exact.
+    uint64_t whole = 0;
+    bool digits = false;
+    for (; p < end && IsDigit(*p); ++p) {
+        const uint64_t digit = static_cast<uint64_t>(*p - '0');
+        if (whole > (static_cast<uint64_t>(INT64_MAX) - digit) / 10) return false;
+        whole = whole * 10 + digit;
+        digits = true;
+    }
+    uint64_t fraction = 0;
+    uint64_t fractionScale = 1;
+    if (p < end && *p == '.') {
+        for (++p; p < end && IsDigit(*p); ++p) {
+            if (fractionScale < 1000000000000000000ULL) {
+                fraction = fraction * 10 + static_cast<uint64_t>(*p - '0');
+                fractionScale *= 10;
+            }
+            digits = true;
+        }
+    }
+    if (!digits) return false;
+    while (p < end && IsSpace(*p)) ++p;
+
+    int power = 0;
+    uint64_t base = 1000;
+    if (p < end) {
+        const char lower = static_cast<char>(*p | 0x20);
+        for (int i = 0; kPrefixes[i]; ++i) {
+            if (lower == kPrefixes[i]) power = i + 1;
+        }
+        if (power > 0) {
+            ++p;
+            if (p < end && (*p == 'i' || *p == 'I')) {
+                base = 1024;
+                ++p;
+            }
+        }
+        if (p < end && (*p == 'B' || *p == 'b')) ++p;
+    }
+    while (p < end && IsSpace(*p)) ++p;
+    if (p != end) return false;
+
+    uint64_t multiplier = 1;
+    for (int i = 0; i < power; ++i) multiplier *= base;
+    if (whole > static_cast<uint64_t>(INT64_MAX) / multiplier) return false;
+    const uint64_t scaled = whole * multiplier;
+    // At most one multiplier, so the conversion cannot overflow.
+    const uint64_t part = static_cast<uint64_t>(static_cast<double>(fraction) *
+                                                static_cast<double>(multiplier) /
+                                                static_cast<double>(fractionScale) + 0.5);
+    if (part > static_cast<uint64_t>(INT64_MAX) - scaled) return false;
+    bytes = static_cast<int64_t>(scaled + part);
+    return true;
+}
+
+std::string FormatDecimalBytes(double bytes) {
+    // Same rendering as the docker CLI (units.HumanSizeWithPrecision(size, 3)).
+    static const char* const units[] = {"B", "kB", "MB", "GB", "TB", "PB", "EB"};
+    return Format(bytes, 1000.0, units, "");
+}
+
+std::string FormatBinaryBytes(double bytes) {
+    static const char* const units[] = {"B", "KiB", "MiB", "GiB", "TiB", "PiB", "EiB"};
+    return Format(bytes, 1024.0, units, " ");
+}
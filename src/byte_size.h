@@ -0,0 +1,18 @@
+#pragma once
+
+#include "string_arena.h"
+#include <cstdint>
+#include <string>
+
+// Parses a size as Docker prints it: "512B", "850kB", "1.2GB", "3.5 MiB",
+// "1.944GiB". Prefixes k/M/G/T/P/E are powers of 1000, or of 1024 with an
+// "i"; the trailing "B" is optional and the letters are case-insensitive.
+// Independent of the C locale. False, leaving `bytes` alone, on anything
+// else or on overflow.
+bool ParseByteSize(const StringRef& text, int64_t& bytes);
+
+// "1.23GB", like the docker CLI's image and disk usage columns.
+std::string FormatDecimalBytes(double bytes);
+
+// "1.23 GiB", like memory in `docker stats`.
+std::string FormatBinaryBytes(double bytes);
@@ -0,0 +1,235 @@
+#include "cgroup_stats.h"
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// systemd cgroup driver: system.slice/docker-<id>.scope
+// cgroupfs driver:       docker/<id>
+const char* kParents[] = {"/system.slice", "/docker", nullptr};
+
+bool IsHexId(const char* s, size_t len) {
+    if (len != 64) return false;
+    for (size_t i = 0; i < len; ++i) {
+        char c = s[i];
+        if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f'))) return false;
+    }
+    return true;
+}
+
+// Reads a small pseudo-file from offset 0 into `buf` (NUL-terminated).
+bool ReadAt(int fd, char* buf, size_t size) {
+    if (fd < 0) return false;
+    ssize_t n = pread(fd, buf, size - 1, 0);
+    if (n < 0) return false;
+    buf[n] = '\0';
+    return true;
+}
+
+// Value of "key <number>" in a flat-keyed file such as cpu.stat.
+uint64_t FlatKey(const char* text, const char* key) {
+    size_t keyLen = std::strlen(key);
+    const char* p = text;
+    while (p && *p) {
+        if (std::strncmp(p, key, keyLen) == 0 && p[keyLen] == ' ') {
+            return std::strtoull(p + keyLen + 1, nullptr, 10);
+        }
+        p = std::strchr(p, '\n');
+        if (p) ++p;
+    }
+    return 0;
+}
+
+// Sums "<key>=<number>" over all device lines of io.stat.
+uint64_t SumNestedKey(const char* text, const char* key) {
+    size_t keyLen = std::strlen(key);
+    uint64_t total = 0;
+    for (const char* p = std::strstr(text, key); p; p = std::strstr(p + keyLen, key)) {
+        if ((p == text || p[-1] == ' ') && p[keyLen] == '=') {
+            total += std::strtoull(p + keyLen + 1, nullptr, 10);
+        }
+    }
+    return total;
+}
+
+}  // namespace
+
+CgroupStatsReader::CgroupStatsReader(const std::string& root) : root(root) {}
+
+CgroupStatsReader::~CgroupStatsReader() {
+    CloseAll();
+}
+
+void CgroupStatsReader::SetRoot(const std::string& newRoot) {
+    CloseAll();
+    root = newRoot;
+}
+
+bool CgroupStatsReader::IsAvailable() const {
+    // cgroup.controllers only exists at the root of a v2 hierarchy.
+    if (access((root + "/cgroup.controllers").c_str(), R_OK) != 0) return false;
+    return !ScopeDirectories().empty();
+}
+
+bool CgroupStatsReader::Covers(const std::vector<std::string>& runningIds,
+                               std::vector<ContainerStats>& out) {
+    if (!Sample(out)) return false;
+    if (runningIds.empty()) return true;
+    for (const auto& id : runningIds) {
+        for (const auto& row : out) {
+            if (id.compare(0, row.id.size(), row.id) == 0) return true;
+        }
+    }
+    return false;
+}
+
+std::vector<std::string> CgroupStatsReader::ScopeDirectories() const {
+    std::vector<std::string> dirs;
+    for (int i = 0; kParents[i]; ++i) {
+        std::string dir = root + kParents[i];
+        if (access(dir.c_str(), R_OK | X_OK) == 0) dirs.push_back(dir);
+    }
+    return dirs;
+}
+
+bool CgroupStatsReader::ContainerIdFromName(const std::string& name, std::string& id) {
+    const char* s = name.c_str();
+    size_t len = name.size();
+    if (name.compare(0, 7, "docker-") == 0 && len > 13 &&
+        name.compare(len - 6, 6, ".scope") == 0) {
+        s += 7;
+        len -= 13;
+    }
+    if (!IsHexId(s, len)) return false;
+    id.assign(s, len);
+    return true;
+}
+
+bool CgroupStatsReader::OpenEntry(Entry& entry, const std::string& directory) {
+    CloseEntry(entry);
+    const std::string path = directory + "/";
+    entry.cpuFd = open((path + "cpu.stat").c_str(), O_RDONLY | O_CLOEXEC);
+    entry.memFd = open((path + "memory.current").c_str(), O_RDONLY | O_CLOEXEC);
+    entry.memStatFd = open((path + "memory.stat").c_str(), O_RDONLY | O_CLOEXEC);
+    entry.ioFd = open((path + "io.stat").c_str(), O_RDONLY | O_CLOEXEC);
+    if (entry.cpuFd < 0) {
+        CloseEntry(entry);
+        return false;
+    }
+    // A new cgroup counts from zero; the next sample starts a new rate.
+    entry.lastUsageUsec = 0;
+    entry.stale = false;
+    return true;
+}
+
+void CgroupStatsReader::CloseEntry(Entry& entry) {
+    for (int* fd : {&entry.cpuFd, &entry.memFd, &entry.memStatFd, &entry.ioFd}) {
+        if (*fd >= 0) close(*fd);
+        *fd = -1;
+    }
+}
+
+void CgroupStatsReader::CloseAll() {
+    for (auto& kv : entries) CloseEntry(kv.second);
+    entries.clear();
+}
+
+bool CgroupStatsReader::Sample(std::vector<ContainerStats>& out) {
+    out.clear();
+    for (auto& kv : entries) kv.second.seen = false;
+
+    std::vector<std::string> parents = ScopeDirectories();
+    if (parents.empty()) return false;
+
+    char buf[8192];
+    std::string id;
+    const auto now = std::chrono::steady_clock::now();
+
+    for (const auto& parent : parents) {
+        DIR* dir = opendir(parent.c_str());
+        if (!dir) continue;
+
+        while (dirent* de = readdir(dir)) {
+            if (!ContainerIdFromName(de->d_name, id)) continue;
+
+            struct stat st;
+            if (fstatat(dirfd(dir), de->d_name, &st, 0) != 0) continue;
+
+            // A container restarted within one interval keeps its ID but
+            // gets a new cgroup; files of the old one read zero or fail.
+            Entry& e = entries[id];
+            const bool replaced = e.device != st.st_dev || e.inode != st.st_ino;
+            if (e.cpuFd < 0 || replaced || e.stale) {
+                if (!OpenEntry(e, parent + "/" + de->d_name)) {
+                    entries.erase(id);
+                    continue;
+                }
+                e.device = st.st_dev;
+                e.inode = st.st_ino;
+            }
+            e.seen = true;
+
+            ContainerStats row;
+            row.id = id.substr(0, 12);
+            row.cpu_percent = 0.0;
+
+            bool cpuRead = ReadAt(e.cpuFd, buf, sizeof(buf));
+            if (!cpuRead && OpenEntry(e, parent + "/" + de->d_name)) {
+                cpuRead = ReadAt(e.cpuFd, buf, sizeof(buf));
+            }
+            if (cpuRead) {
+                uint64_t usage = FlatKey(buf, "usage_usec");
+                if (e.lastUsageUsec != 0 && usage >= e.lastUsageUsec) {
+                    double wallUsec = std::chrono::duration<double, std::micro>(
+                        now - e.lastSample).count();
+                    if (wallUsec > 0) {
+                        row.cpu_percent = (usage - e.lastUsageUsec) * 100.0 / wallUsec;
+                    }
+                }
+                e.lastUsageUsec = usage;
+                e.lastSample = now;
+            } else {
+                e.stale = true;
+            }
+
+            // Like `docker stats`, leave reclaimable page cache out of usage.
+            if (ReadAt(e.memFd, buf, sizeof(buf))) {
+                uint64_t current = std::strtoull(buf, nullptr, 10);
+                uint64_t inactive = 0;
+                if (ReadAt(e.memStatFd, buf, sizeof(buf))) {
+                    inactive = FlatKey(buf, "inactive_file");
+                } else if (e.memStatFd >= 0) {
+                    e.stale = true;
+                }
+                row.mem_bytes = current > inactive ? current - inactive : current;
+            } else if (e.memFd >= 0) {
+                e.stale = true;
+            }
+
+            if (ReadAt(e.ioFd, buf, sizeof(buf))) {
+                row.block_read = SumNestedKey(buf, "rbytes");
+                row.block_write = SumNestedKey(buf, "wbytes");
+            } else if (e.ioFd >= 0) {
+                e.stale = true;
+            }
+
+            out.push_back(row);
+        }
+        closedir(dir);
+    }
+
+    // Containers that stopped since the last sample.
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (!it->second.seen) {
+            CloseEntry(it->second);
+            it = entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "stats_collector.h"
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+// Reads container CPU, memory and block IO straight from the cgroup v2
+// hierarchy of a local daemon. Each container's stat files stay open and are
+// re-read with pread(); rates come from the delta to the previous sample.
+// They are re-opened when the container's cgroup directory is replaced (a
+// restart) or a read fails.
+class CgroupStatsReader {
+public:
+    explicit CgroupStatsReader(const std::string& root = "/sys/fs/cgroup");
+    ~CgroupStatsReader();
+
+    void SetRoot(const std::string& root);
+    const std::string& GetRoot() const { return root; }
+
+    // True when the hierarchy is cgroup v2 and a docker parent slice is readable.
+    bool IsAvailable() const;
+
+    // Samples into `out` and reports whether that found a scope for at least
+    // one of `runningIds` (short or full), or there were none to look for.
+    // A daemon that keeps its containers elsewhere, such as rootless Docker,
+    // a custom --cgroup-parent or a VM behind a forwarded socket, fails this.
+    bool Covers(const std::vector<std::string>& runningIds, std::vector<ContainerStats>& out);
+
+    // Fills one row per running container. The first sample of a container
+    // has no CPU rate yet and reports 0%.
+    bool Sample(std::vector<ContainerStats>& out);
+
+private:
+    struct Entry {
+        int cpuFd = -1;
+        int memFd = -1;
+        int memStatFd = -1;
+        int ioFd = -1;
+        // The cgroup directory the files were opened in.
+        dev_t device = 0;
+        ino_t inode = 0;
+        bool stale = false;  // a read failed; re-open on the next sample
+        uint64_t lastUsageUsec = 0;
+        std::chrono::steady_clock::time_point lastSample;
+        bool seen = false;
+    };
+
+    std::string root;
+    std::map<std::string, Entry> entries;  // keyed by full container ID
+
+    std::vector<std::string> ScopeDirectories() const;
+    static bool ContainerIdFromName(const std::string& name, std::string& id);
+    static bool OpenEntry(Entry& entry, const std::string& directory);
+    static void CloseEntry(Entry& entry);
+    void CloseAll();
+};
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Parses `docker ... --format '{{.A}}|{{.B}}|...'` output into records. The
+// field order is a compile-time list of member pointers:
+//
+//   DelimitedParser<VolumeInfo, &VolumeInfo::name, &VolumeInfo::driver>
+//
+// The buffer is scanned once with memchr and each field is assigned straight
+// into the record being built; no per-line stream or temporary strings.
+// Lines with the wrong number of fields are skipped and handed back through
+// `malformed` instead of yielding half-filled records.
+template <typename T, std::string T::*... Fields>
+struct DelimitedParser {
+    static const size_t kFieldCount = sizeof...(Fields);
+
+    static std::vector<T> Parse(const std::string& output,
+                                std::vector<std::string>* malformed = nullptr,
+                                char delimiter = '|') {
+        std::vector<T> records;
+        Parse(output.data(), output.size(), records, malformed, delimiter);
+        return records;
+    }
+
+    static void Parse(const char* data, size_t size, std::vector<T>& records,
+                      std::vector<std::string>* malformed = nullptr,
+                      char delimiter = '|') {
+        const char* const end = data + size;
+
+        size_t lines = 0;
+        for (const char* p = data; p < end; ++lines) {
+            const void* nl = std::memchr(p, '\n', end - p);
+            p = nl ? static_cast<const char*>(nl) + 1 : end;
+        }
+        records.reserve(records.size() + lines);
+
+        const char* line = data;
+        while (line < end) {
+            const void* nl = std::memchr(line, '\n', end - line);
+            const char* lineEnd = nl ? static_cast<const char*>(nl) : end;
+            const char* next = nl ? lineEnd + 1 : end;
+            if (lineEnd > line && lineEnd[-1] == '\r') --lineEnd;
+
+            if (lineEnd == line) {
+                line = next;
+                continue;
+            }
+
+            records.emplace_back();
+            if (!ParseRecord(line, lineEnd - line, records.back(), delimiter)) {
+                records.pop_back();
+                if (malformed) malformed->emplace_back(line, lineEnd - line);
+            }
+            line = next;
+        }
+    }
+
+    // One line without its newline. False, with `record` partly assigned,
+    // unless it has exactly kFieldCount fields.
+    static bool ParseRecord(const char* line, size_t size, T& record, char delimiter = '|') {
+        std::string T::* const fields[] = {Fields...};
+        const char* const lineEnd = line + size;
+        const char* field = line;
+        size_t count = 0;
+
+        for (;;) {
+            const void* hit = std::memchr(field, delimiter, lineEnd - field);
+            const char* fieldEnd = hit ? static_cast<const char*>(hit) : lineEnd;
+            (record.*fields[count]).assign(field, fieldEnd - field);
+            ++count;
+            if (!hit) return count == kFieldCount;
+            if (count == kFieldCount) return false;
+            field = fieldEnd + 1;
+        }
+    }
+};
+
+// Calls `fn(const char* begin, size_t size)` for every non-empty piece of
+// `text` between delimiters, such as the tags in "app:1,app:latest".
+template <typename Fn>
+void ForEachField(const std::string& text, char delimiter, Fn fn) {
+    const char* p = text.data();
+    const char* const end = p + text.size();
+    while (p < end) {
+        const void* hit = std::memchr(p, delimiter, end - p);
+        const char* fieldEnd = hit ? static_cast<const char*>(hit) : end;
+        if (fieldEnd > p) fn(p, static_cast<size_t>(fieldEnd - p));
+        p = fieldEnd + 1;
+    }
+}
+
+// "12.34%" or "12.34" as `docker stats` prints it. Independent of the C
+// locale, unlike std::stod. False, leaving `value` alone, on anything else,
+// such as the "--" shown for a container that is still starting.
+inline bool ParsePercent(const std::string& text, double& value) {
+    const char* p = text.data();
+    const char* const end = p + text.size();
+    while (p < end && *p == ' ') ++p;
+
+    double whole = 0.0;
+    bool digits = false;
+    for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+        whole = whole * 10.0 + (*p - '0');
+        digits = true;
+    }
+    double fraction = 0.0;
+    if (p < end && *p == '.') {
+        double scale = 0.1;
+        for (++p; p < end && *p >= '0' && *p <= '9'; ++p) {
+            fraction += (*p - '0') * scale;
+            scale *= 0.1;
+            digits = true;
+        }
+    }
+    if (!digits) return false;
+    if (p < end && *p == '%') ++p;
+    while (p < end && *p == ' ') ++p;
+    if (p != end) return false;
+    value = whole + fraction;
+    return true;
+}
@@ -0,0 +1,227 @@
+#include "dependency_graph.h"
+#include <algorithm>
+#include <unordered_map>
+
+namespace {
+
+// What `docker container prune` removes; paused and restarting containers
+// count as running.
+bool Prunable(const std::string& state) {
+    return state == "created" || state == "exited" || state == "dead";
+}
+
+// A container's image: by the ID the daemon reported, or else by the
+// reference it was created from, a tag (":latest" if none) or an ID.
+int FindImage(const DiskUsage::Container& container,
+              const std::unordered_map<std::string, int>& byId,
+              const std::unordered_map<std::string, int>& byTag) {
+    if (!container.image_id.empty()) {
+        auto it = byId.find(container.image_id);
+        return it == byId.end() ? -1 : it->second;
+    }
+    const std::string& ref = container.image;
+    auto tag = byTag.find(ref);
+    if (tag != byTag.end()) return tag->second;
+    const size_t colon = ref.rfind(':');
+    const size_t slash = ref.rfind('/');
+    if (colon == std::string::npos || (slash != std::string::npos && colon < slash)) {
+        tag = byTag.find(ref + ":latest");
+        if (tag != byTag.end()) return tag->second;
+    }
+    std::string id = ref.compare(0, 7, "sha256:") == 0 ? ref.substr(7) : ref;
+    if (id.size() > 12) id.resize(12);
+    auto it = byId.find(id);
+    return it == byId.end() ? -1 : it->second;
+}
+
+std::string ImageLabel(const DiskUsage::Image& image) {
+    if (image.tags.empty()) return "<none> " + image.id;
+    std::string label;
+    for (const auto& tag : image.tags) {
+        if (!label.empty()) label += ", ";
+        label += tag;
+    }
+    return label;
+}
+
+PruneItem MakeItem(PruneKind kind, const std::string& id, const std::string& label,
+                   int64_t bytes) {
+    PruneItem item;
+    item.kind = kind;
+    item.id = id;
+    item.label = label;
+    item.bytes = bytes;
+    item.remove = true;
+    return item;
+}
+
+}  // namespace
+
+std::vector<std::string> PrunePlan::Removed(PruneKind kind) const {
+    std::vector<std::string> ids;
+    for (const auto& item : items) {
+        if (item.kind == kind && item.remove) ids.push_back(item.id);
+    }
+    return ids;
+}
+
+DependencyGraph::DependencyGraph(const DiskUsage& usage)
+    : buildCacheBytes(usage.build_cache_bytes) {
+    std::unordered_map<std::string, int> imageById;
+    std::unordered_map<std::string, int> imageByTag;
+    images.resize(usage.images.size());
+    for (size_t i = 0; i < usage.images.size(); ++i) {
+        const int index = static_cast<int>(i);
+        imageById[usage.images[i].id] = index;
+        for (const auto& tag : usage.images[i].tags) imageByTag[tag] = index;
+        images[i].parent = -1;
+        images[i].exclusive = usage.images[i].shared_size == 0;
+        images[i].item = -1;
+    }
+    for (size_t i = 0; i < usage.images.size(); ++i) {
+        auto parent = imageById.find(usage.images[i].parent_id);
+        if (parent == imageById.end()) continue;
+        images[i].parent = parent->second;
+        images[parent->second].children.push_back(static_cast<int>(i));
+    }
+
+    std::unordered_map<std::string, int> volumeByName;
+    volumes.resize(usage.volumes.size());
+    for (size_t i = 0; i < usage.volumes.size(); ++i) {
+        volumeByName[usage.volumes[i].name] = static_cast<int>(i);
+        volumes[i].item = -1;
+    }
+
+    containers.resize(usage.containers.size());
+    for (size_t i = 0; i < usage.containers.size(); ++i) {
+        const DiskUsage::Container& info = usage.containers[i];
+        containers[i].image = FindImage(info, imageById, imageByTag);
+        containers[i].item = -1;
+        for (const auto& name : info.volumes) {
+            auto it = volumeByName.find(name);
+            if (it != volumeByName.end()) containers[i].volumes.push_back(it->second);
+        }
+    }
+
+    // Whatever a running container uses stays, and so do its image's parents.
+    std::vector<char> imageUsed(images.size(), 0);
+    std::vector<char> volumeUsed(volumes.size(), 0);
+    for (size_t i = 0; i < containers.size(); ++i) {
+        if (Prunable(usage.containers[i].state)) continue;
+        for (int image = containers[i].image; image >= 0 && !imageUsed[image];
+             image = images[image].parent) {
+            imageUsed[image] = 1;
+        }
+        for (int volume : containers[i].volumes) volumeUsed[volume] = 1;
+    }
+
+    for (size_t i = 0; i < containers.size(); ++i) {
+        const DiskUsage::Container& info = usage.containers[i];
+        if (!Prunable(info.state)) continue;
+        containers[i].item = static_cast<int>(candidates.size());
+        candidates.push_back(MakeItem(PruneKind::Container, info.id,
+                                      info.name.empty() ? info.id : info.name, info.size));
+    }
+    for (size_t i = 0; i < images.size(); ++i) {
+        if (imageUsed[i]) continue;
+        const DiskUsage::Image& info = usage.images[i];
+        images[i].item = static_cast<int>(candidates.size());
+        candidates.push_back(MakeItem(PruneKind::Image, info.id, ImageLabel(info),
+                                      info.shared_size >= 0 ? info.size - info.shared_size : -1));
+    }
+    for (size_t i = 0; i < volumes.size(); ++i) {
+        if (volumeUsed[i]) continue;
+        const DiskUsage::Volume& info = usage.volumes[i];
+        volumes[i].item = static_cast<int>(candidates.size());
+        candidates.push_back(MakeItem(PruneKind::Volume, info.name, info.name, info.size));
+    }
+}
+
+void DependencyGraph::HoldImage(PrunePlan& plan, int image, const std::string& holder) const {
+    // Images in use have only parents in use, so the walk stops there.
+    for (; image >= 0 && images[image].item >= 0; image = images[image].parent) {
+        PruneItem& item = plan.items[images[image].item];
+        if (!item.remove) continue;
+        item.remove = false;
+        item.neededBy = holder;
+    }
+}
+
+PrunePlan DependencyGraph::Plan(const std::vector<bool>& keep,
+                                const ImageBytes& imageBytes) const {
+    PrunePlan plan;
+    plan.items = candidates;
+    for (size_t i = 0; i < keep.size() && i < plan.items.size(); ++i) {
+        if (keep[i]) plan.items[i].remove = false;
+    }
+
+    // Kept containers hold their images and volumes, kept images their
+    // parents.
+    for (const Container& container : containers) {
+        if (container.item < 0 || plan.items[container.item].remove) continue;
+        const std::string holder = "container " + candidates[container.item].label;
+        HoldImage(plan, container.image, holder);
+        for (int volume : container.volumes) {
+            if (volumes[volume].item < 0) continue;
+            PruneItem& item = plan.items[volumes[volume].item];
+            if (!item.remove) continue;
+            item.remove = false;
+            item.neededBy = holder;
+        }
+    }
+    for (const Image& image : images) {
+        if (image.item < 0 || plan.items[image.item].remove) continue;
+        HoldImage(plan, image.parent, "image " + candidates[image.item].label);
+    }
+
+    auto removed = [this, &plan](int image) {
+        return image >= 0 && images[image].item >= 0 && plan.items[images[image].item].remove;
+    };
+
+    std::vector<std::string> imageIds;
+    int64_t imageSum = 0;
+    bool imageSumExact = true;
+    for (size_t i = 0; i < images.size(); ++i) {
+        if (!removed(static_cast<int>(i))) continue;
+        const PruneItem& item = plan.items[images[i].item];
+        imageIds.push_back(item.id);
+        if (item.bytes >= 0) imageSum += item.bytes;
+        imageSumExact = imageSumExact && images[i].exclusive;
+    }
+    for (const PruneItem& item : plan.items) {
+        if (!item.remove || item.kind == PruneKind::Image) continue;
+        if (item.bytes >= 0) {
+            plan.bytes += item.bytes;
+        } else {
+            plan.bytesExact = false;
+        }
+    }
+    int64_t imageTotal = 0;
+    if (!imageIds.empty() && imageBytes && imageBytes(imageIds, imageTotal)) {
+        plan.bytes += imageTotal;
+    } else {
+        plan.bytes += imageSum;
+        plan.bytesExact = plan.bytesExact && imageSumExact;
+    }
+
+    // An image's round is one past the latest of its children's. Walks
+    // start at images with no removed children and climb the parents.
+    std::vector<int> round(images.size(), -1);
+    int rounds = 0;
+    for (size_t i = 0; i < images.size(); ++i) {
+        if (!removed(static_cast<int>(i))) continue;
+        const std::vector<int>& children = images[i].children;
+        if (std::any_of(children.begin(), children.end(), removed)) continue;
+        int next = 0;
+        for (int image = static_cast<int>(i); removed(image); image = images[image].parent) {
+            if (round[image] >= next) break;
+            round[image] = next++;
+        }
+        rounds = std::max(rounds, next);
+    }
+    plan.imageRounds.resize(rounds);
+    for (size_t i = 0; i < images.size(); ++i) {
+        if (round[i] >= 0) plan.imageRounds[round[i]].push_back(plan.items[images[i].item].id);
+    }
+    return plan;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "docker_commands.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+enum class PruneKind : uint8_t { Container, Image, Volume };
+
+// An object `docker system prune --all --volumes` would remove.
+struct PruneItem {
+    PruneKind kind;
+    std::string id;     // container or image ID, volume name
+    std::string label;  // container name, image tags or volume name
+    int64_t bytes;      // freed by removing it alone; -1 if unknown
+    bool remove;        // chosen, and nothing that stays needs it
+    std::string neededBy;  // when chosen but kept: what needs it, e.g. "container web"
+};
+
+struct PrunePlan {
+    std::vector<PruneItem> items;  // containers, then images, then volumes
+    int64_t bytes = 0;             // freed by the items to remove
+    bool bytesExact = true;        // otherwise some sizes were unknown and
+                                   // `bytes` is a lower bound
+    // Images to remove, grouped so that each round only holds images whose
+    // children went in earlier rounds; a round can be removed in parallel.
+    std::vector<std::vector<std::string>> imageRounds;
+
+    std::vector<std::string> Removed(PruneKind kind) const;
+};
+
+// The containers, images and volumes of one DiskUsage read and what holds
+// on to what: a container keeps its image, that image's parents and the
+// volumes it mounts. Plans are worked out from this in memory, so the
+// preview can be recomputed on every click.
+class DependencyGraph {
+public:
+    // Bytes freed by removing `ids` together, false if not known for all of
+    // them. Images sharing layers free less than the sum of their sizes.
+    typedef std::function<bool(const std::vector<std::string>& ids, int64_t& bytes)> ImageBytes;
+
+    explicit DependencyGraph(const DiskUsage& usage);
+
+    // Objects prune would remove: containers that are not running, then the
+    // images and volumes nothing else uses. The order is fixed, so indexes
+    // into it stay valid for Plan().
+    const std::vector<PruneItem>& Candidates() const { return candidates; }
+
+    // The candidates minus those at a true index of `keep`, and minus what
+    // the kept ones still need. Without `imageBytes`, image bytes come from
+    // the daemon's per-image shared sizes and are a lower bound.
+    PrunePlan Plan(const std::vector<bool>& keep = std::vector<bool>(),
+                   const ImageBytes& imageBytes = ImageBytes()) const;
+
+    int64_t BuildCacheBytes() const { return buildCacheBytes; }
+
+private:
+    struct Container {
+        int image;                 // index into `images`, -1 if not found
+        std::vector<int> volumes;  // indexes into `volumes`
+        int item;                  // index into `candidates`, -1 if running
+    };
+    struct Image {
+        int parent;
+        std::vector<int> children;
+        bool exclusive;            // the daemon says no layer is shared
+        int item;                  // -1 if in use
+    };
+    struct Volume {
+        int item;
+    };
+
+    std::vector<Container> containers;
+    std::vector<Image> images;
+    std::vector<Volume> volumes;
+    std::vector<PruneItem> candidates;
+    int64_t buildCacheBytes;
+
+    void HoldImage(PrunePlan& plan, int image, const std::string& holder) const;
+};
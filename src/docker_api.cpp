@@ -0,0 +1,437 @@
+#include "docker_api.h"
+#include "json_reader.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+const size_t kMaxIdleConnections = 8;
+const size_t kReadChunk = 64 * 1024;
+const int kStreamIdleMs = 1000;
+// Error bodies are a short JSON message; more than this is not kept.
+const size_t kMaxErrorBody = 4096;
+
+typedef std::function<bool(const char*, size_t)> BodySink;
+typedef std::chrono::steady_clock Clock;
+
+// Buffered reader over a connected socket. When an idle callback is set,
+// reads wake up periodically so long-lived streams can be abandoned;
+// otherwise they give up at the deadline.
+class SocketReader {
+public:
+    SocketReader(int fd, const DockerApiClient::StreamCallback* idle,
+                 Clock::time_point deadline = Clock::time_point::max())
+        : fd(fd), idle(idle), deadline(deadline), pos(0) {}
+
+    bool TimedOut() const { return timedOut; }
+
+    bool ReadLine(std::string& line) {
+        for (;;) {
+            size_t nl = buffer.find("\r\n", pos);
+            if (nl != std::string::npos) {
+                line.assign(buffer, pos, nl - pos);
+                pos = nl + 2;
+                return true;
+            }
+            if (!Fill()) return false;
+        }
+    }
+
+    // Passes exactly `count` body bytes to the sink.
+    bool Forward(size_t count, const BodySink& sink) {
+        while (count > 0) {
+            if (pos >= buffer.size() && !Fill()) return false;
+            size_t n = std::min(count, buffer.size() - pos);
+            if (!sink(buffer.data() + pos, n)) return false;
+            pos += n;
+            count -= n;
+        }
+        return true;
+    }
+
+    bool ForwardUntilEof(const BodySink& sink) {
+        for (;;) {
+            if (pos < buffer.size()) {
+                if (!sink(buffer.data() + pos, buffer.size() - pos)) return false;
+                pos = buffer.size();
+            }
+            if (!Fill()) return eof;
+        }
+    }
+
+private:
+    int fd;
+    const DockerApiClient::StreamCallback* idle;
+    Clock::time_point deadline;
+    std::string buffer;
+    size_t pos;
+    bool eof = false;
+    bool timedOut = false;
+
+    bool Fill() {
+        if (pos > 0) {
+            buffer.erase(0, pos);
+            pos = 0;
+        }
+        for (;;) {
+            if (idle) {
+                pollfd pfd = {fd, POLLIN, 0};
+                int ready = poll(&pfd, 1, kStreamIdleMs);
+                if (ready < 0 && errno == EINTR) continue;
+                if (ready < 0) return false;
+                if (ready == 0) {
+                    if (!(*idle)(nullptr, 0)) return false;
+                    continue;
+                }
+            } else if (deadline != Clock::time_point::max()) {
+                const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - Clock::now()).count();
+                pollfd pfd = {fd, POLLIN, 0};
+                int ready = left > 0 ? poll(&pfd, 1, static_cast<int>(left)) : 0;
+                if (ready < 0 && errno == EINTR) continue;
+                if (ready < 0) return false;
+                if (ready == 0) {
+                    // poll() rounds down to whole milliseconds.
+                    if (Clock::now() < deadline) continue;
+                    timedOut = true;
+                    return false;
+                }
+            }
+            size_t old = buffer.size();
+            buffer.resize(old + kReadChunk);
+            ssize_t n = recv(fd, &buffer[old], kReadChunk, 0);
+            if (n < 0 && errno == EINTR) {
+                buffer.resize(old);
+                continue;
+            }
+            buffer.resize(old + (n > 0 ? n : 0));
+            if (n == 0) eof = true;
+            return n > 0;
+        }
+    }
+};
+
+bool SendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        sent += n;
+    }
+    return true;
+}
+
+std::string ToLower(std::string s) {
+    for (char& c : s) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return s;
+}
+
+// Reads one response from the socket, handing the body to `sink`.
+// `headerRead` tells the caller whether anything arrived at all, which is how
+// a stale keep-alive connection is told apart from a real failure.
+bool ReadResponse(SocketReader& reader, const BodySink& sink, int& status,
+                  bool& keepAlive, bool& headerRead) {
+    headerRead = false;
+    keepAlive = false;
+
+    std::string line;
+    if (!reader.ReadLine(line)) return false;
+    headerRead = true;
+
+    // "HTTP/1.1 200 OK"
+    size_t sp = line.find(' ');
+    if (line.compare(0, 5, "HTTP/") != 0 || sp == std::string::npos) return false;
+    status = std::atoi(line.c_str() + sp + 1);
+    keepAlive = line.compare(0, 8, "HTTP/1.1") == 0;
+
+    bool chunked = false;
+    bool hasLength = false;
+    size_t contentLength = 0;
+
+    bool headersDone = false;
+    while (reader.ReadLine(line)) {
+        if (line.empty()) {
+            headersDone = true;
+            break;
+        }
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) continue;
+        std::string name = ToLower(line.substr(0, colon));
+        size_t vstart = line.find_first_not_of(' ', colon + 1);
+        std::string value = vstart == std::string::npos ? "" : line.substr(vstart);
+
+        if (name == "content-length") {
+            hasLength = true;
+            contentLength = static_cast<size_t>(std::strtoull(value.c_str(), nullptr, 10));
+        } else if (name == "transfer-encoding") {
+            chunked = ToLower(value).find("chunked") != std::string::npos;
+        } else if (name == "connection") {
+            if (ToLower(value) == "close") keepAlive = false;
+        }
+    }
+    if (!headersDone) return false;
+
+    // 1xx, 204 and 304 carry no body.
+    if (status == 204 || status == 304 || (status >= 100 && status < 200)) return true;
+
+    if (chunked) {
+        for (;;) {
+            if (!reader.ReadLine(line)) return false;
+            size_t size = static_cast<size_t>(std::strtoul(line.c_str(), nullptr, 16));
+            if (size == 0) {
+                // Trailer section ends with an empty line.
+                while (reader.ReadLine(line) && !line.empty()) {}
+                return true;
+            }
+            if (!reader.Forward(size, sink)) return false;
+            if (!reader.ReadLine(line)) return false;
+        }
+    }
+
+    if (hasLength) return reader.Forward(contentLength, sink);
+
+    keepAlive = false;
+    return reader.ForwardUntilEof(sink);
+}
+
+std::string BuildRequest(const std::string& method, const std::string& path) {
+    std::string req;
+    req.reserve(128 + path.size());
+    req += method;
+    req += ' ';
+    req += path;
+    req += " HTTP/1.1\r\nHost: docker\r\nUser-Agent: docker-manager\r\n";
+    if (method == "POST") req += "Content-Length: 0\r\n";
+    req += "\r\n";
+    return req;
+}
+
+std::string DefaultSocketPath() {
+    const char* host = std::getenv("DOCKER_HOST");
+    if (host && *host) {
+        std::string value(host);
+        if (value.compare(0, 7, "unix://") == 0) return value.substr(7);
+        // tcp://, ssh:// etc. are left to the docker CLI.
+        return "";
+    }
+    return "/var/run/docker.sock";
+}
+
+}  // namespace
+
+DockerApiClient& DockerApiClient::Instance() {
+    static DockerApiClient instance;
+    return instance;
+}
+
+DockerApiClient::DockerApiClient() : socketPath(DefaultSocketPath()) {}
+
+DockerApiClient::~DockerApiClient() {
+    CloseIdleConnections();
+}
+
+void DockerApiClient::SetSocketPath(const std::string& path) {
+    CloseIdleConnections();
+    std::lock_guard<std::mutex> lock(mutex);
+    socketPath = path;
+}
+
+std::string DockerApiClient::GetSocketPath() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return socketPath;
+}
+
+bool DockerApiClient::IsEnabled() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return !socketPath.empty();
+}
+
+void DockerApiClient::CloseIdleConnections() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (int fd : idleConnections) close(fd);
+    idleConnections.clear();
+}
+
+int DockerApiClient::Connect(std::string* error, int timeoutMs) const {
+    std::string path = GetSocketPath();
+    if (path.empty()) {
+        if (error) *error = "Docker API socket is not configured";
+        return -1;
+    }
+
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        if (error) *error = "Socket path too long: " + path;
+        return -1;
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        if (error) *error = std::strerror(errno);
+        return -1;
+    }
+    // Bounds connect() on a daemon with a full backlog, and every send().
+    timeval timeout;
+    timeout.tv_sec = timeoutMs / 1000;
+    timeout.tv_usec = (timeoutMs % 1000) * 1000;
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        if (error) {
+            *error = "Cannot connect to the Docker daemon at unix://" + path + ": " +
+                     std::strerror(errno);
+        }
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int DockerApiClient::AcquireConnection(bool& reused, std::string* error, int timeoutMs) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!idleConnections.empty()) {
+            int fd = idleConnections.back();
+            idleConnections.pop_back();
+            reused = true;
+            return fd;
+        }
+    }
+    reused = false;
+    return Connect(error, timeoutMs);
+}
+
+void DockerApiClient::ReleaseConnection(int fd) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (idleConnections.size() < kMaxIdleConnections) {
+        idleConnections.push_back(fd);
+    } else {
+        close(fd);
+    }
+}
+
+bool DockerApiClient::Request(const std::string& method, const std::string& path,
+                              HttpResponse& response, std::string* error, int timeoutMs) {
+    const std::string request = BuildRequest(method, path);
+    const Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+
+    // A pooled connection may have been closed by the daemon while idle;
+    // in that case retry once on a fresh one.
+    bool timedOut = false;
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        bool reused = false;
+        int fd = AcquireConnection(reused, error, timeoutMs);
+        if (fd < 0) return false;
+
+        response.status = 0;
+        response.body.clear();
+
+        bool headerRead = false;
+        bool keepAlive = false;
+        bool ok = SendAll(fd, request);
+        if (ok) {
+            SocketReader reader(fd, nullptr, deadline);
+            BodySink sink = [&response](const char* data, size_t size) {
+                response.body.append(data, size);
+                return true;
+            };
+            ok = ReadResponse(reader, sink, response.status, keepAlive, headerRead);
+            timedOut = reader.TimedOut();
+        }
+
+        if (ok) {
+            if (keepAlive) {
+                ReleaseConnection(fd);
+            } else {
+                close(fd);
+            }
+            return true;
+        }
+
+        // Half a response may still be on its way; the connection is not
+        // reused after a failure.
+        close(fd);
+        if (!reused || headerRead || timedOut) break;
+    }
+
+    if (error) {
+        *error = timedOut ? "Docker API request timed out after " +
+                                std::to_string(timeoutMs) + " ms: " + method + " " + path
+                          : "Docker API request failed: " + method + " " + path;
+    }
+    return false;
+}
+
+bool DockerApiClient::Stream(const std::string& method, const std::string& path,
+                             const StreamCallback& onData, int* status,
+                             std::string* error) {
+    int fd = Connect(error);
+    if (fd < 0) return false;
+
+    bool ok = SendAll(fd, BuildRequest(method, path));
+    int localStatus = 0;
+    int& code = status ? *status : localStatus;
+    code = 0;
+    std::string errorBody;
+    if (ok) {
+        SocketReader reader(fd, &onData);
+        // ReadResponse() sets `code` before any of the body arrives.
+        BodySink sink = [&code, &onData, &errorBody](const char* data, size_t size) {
+            if (code == 200) return onData(data, size);
+            errorBody.append(data, std::min(size, kMaxErrorBody - errorBody.size()));
+            return errorBody.size() < kMaxErrorBody;
+        };
+        bool keepAlive = false;
+        bool headerRead = false;
+        ok = ReadResponse(reader, sink, code, keepAlive, headerRead) || headerRead;
+    }
+    close(fd);
+
+    if (!ok && error) *error = "Docker API stream failed: " + method + " " + path;
+    if (ok && code != 200 && error) *error = ErrorMessage(code, errorBody);
+    return ok;
+}
+
+std::string DockerApiClient::ErrorMessage(int status, const std::string& body) {
+    JsonReader json(body);
+    std::string key;
+    std::string message;
+    if (json.BeginObject()) {
+        while (json.NextKey(key)) {
+            if (key == "message") {
+                json.ReadString(message);
+            } else {
+                json.Skip();
+            }
+        }
+    }
+    if (!message.empty()) return message;
+    return "HTTP " + std::to_string(status);
+}
+
+std::string DockerApiClient::UrlEncode(const std::string& value) {
+    static const char hex[] = "0123456789ABCDEF";
+    std::string out;
+    out.reserve(value.size() * 3);
+    for (unsigned char c : value) {
+        if (std::isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~') {
+            out += static_cast<char>(c);
+        } else {
+            out += '%';
+            out += hex[c >> 4];
+            out += hex[c & 0x0F];
+        }
+    }
+    return out;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "process_runner.h"
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct HttpResponse {
+    int status = 0;
+    std::string body;
+};
+
+// Minimal HTTP/1.1 client for the Docker Engine API over its Unix socket.
+// Idle connections are kept alive and reused between requests.
+class DockerApiClient {
+public:
+    // Called with each piece of a streamed body, or with (nullptr, 0) when the
+    // stream has been idle for a while. Returning false ends the stream.
+    typedef std::function<bool(const char* data, size_t size)> StreamCallback;
+
+    static DockerApiClient& Instance();
+
+    // Defaults to DOCKER_HOST when it is a unix:// URL, otherwise
+    // /var/run/docker.sock. An empty path disables the API client.
+    void SetSocketPath(const std::string& path);
+    std::string GetSocketPath() const;
+    bool IsEnabled() const;
+
+    // Returns false if the daemon could not be reached or did not answer
+    // within timeoutMs (the connection is then dropped, not reused); HTTP
+    // errors are reported through response.status.
+    bool Request(const std::string& method, const std::string& path,
+                 HttpResponse& response, std::string* error = nullptr,
+                 int timeoutMs = ProcessRunner::kDefaultTimeoutMs);
+
+    // Long-lived request on a dedicated connection (events, logs). Only a
+    // 200 response's body reaches onData; *status is set as soon as the
+    // response line arrives, so onData can tell a stream that is up from
+    // one still waiting for the daemon. For any other status the daemon's
+    // message goes to *error instead.
+    bool Stream(const std::string& method, const std::string& path,
+                const StreamCallback& onData, int* status = nullptr,
+                std::string* error = nullptr);
+
+    static std::string UrlEncode(const std::string& value);
+    // The daemon's {"message": "..."} from an error body, or "HTTP <status>".
+    static std::string ErrorMessage(int status, const std::string& body);
+
+private:
+    DockerApiClient();
+    ~DockerApiClient();
+    DockerApiClient(const DockerApiClient&) = delete;
+    DockerApiClient& operator=(const DockerApiClient&) = delete;
+
+    int Connect(std::string* error, int timeoutMs = ProcessRunner::kDefaultTimeoutMs) const;
+    int AcquireConnection(bool& reused, std::string* error, int timeoutMs);
+    void ReleaseConnection(int fd);
+    void CloseIdleConnections();
+
+    mutable std::mutex mutex;
+    std::string socketPath;
+    std::vector<int> idleConnections;
+};
@@ -1,10 +1,821 @@
 #include "docker_commands.h"
-#include <array>
+#include "byte_size.h"
+#include "cli_parser.h"
+#include "docker_api.h"
+#include "json_reader.h"
+#include "request_gate.h"
+#include "stats_collector.h"
+#include <atomic>
+#include <cctype>
+#include <chrono>
 #include <cstdio>
-#include <sstream>
+#include <map>
+#include <mutex>
 #include <algorithm>
 #include <unistd.h>
 
+namespace {
+
+const char kContainerFormat[] = "{{.ID}}|{{.Names}}|{{.State}}|{{.Status}}|{{.Image}}";
+const char kImageFormat[] = "{{.ID}}|{{.Repository}}|{{.Tag}}|{{.Size}}";
+const char kVolumeFormat[] = "{{.Name}}|{{.Driver}}";
+
+// `docker stop` waits up to 10s for a graceful exit before killing.
+const int kStopTimeoutMs = 20000;
+const int kLongTimeoutMs = 10 * 60 * 1000;
+
+const size_t kDefaultMaxDaemonCalls =
+    BulkExecutor::kDefaultConcurrency + DockerCommands::kCallHeadroom;
+
+// IsDockerAvailable() and GetDockerError() are called back to back; the
+// second one reuses the first probe instead of running `docker info` again.
+const int kProbeReuseMs = 1000;
+
+const char kNone[] = "<none>";
+
+std::string ShortId(const std::string& id) {
+    std::string s = id;
+    if (s.compare(0, 7, "sha256:") == 0) s.erase(0, 7);
+    if (s.size() > 12) s.resize(12);
+    return s;
+}
+
+// "registry:5000/app:1.2" -> ("registry:5000/app", "1.2")
+void SplitRepoTag(const std::string& ref, std::string& repo, std::string& tag) {
+    size_t colon = ref.rfind(':');
+    size_t slash = ref.rfind('/');
+    if (colon == std::string::npos || (slash != std::string::npos && colon < slash)) {
+        repo = ref;
+        tag = kNone;
+        return;
+    }
+    repo = ref.substr(0, colon);
+    tag = ref.substr(colon + 1);
+}
+
+bool ReadStringArray(JsonReader& json, std::vector<std::string>& out) {
+    out.clear();
+    if (json.Peek() == JsonReader::Type::Null) return json.Skip();
+    if (!json.BeginArray()) return false;
+    std::string value;
+    while (json.NextElement()) {
+        if (!json.ReadString(value)) return false;
+        out.push_back(value);
+    }
+    return !json.Failed();
+}
+
+typedef DelimitedParser<ContainerInfo, &ContainerInfo::id, &ContainerInfo::name,
+                        &ContainerInfo::state, &ContainerInfo::status,
+                        &ContainerInfo::image> ContainerParser;
+// `docker images` prints sizes for people ("1.2GB"); they become byte
+// counts once, here.
+struct ImageLine {
+    std::string id;
+    std::string repository;
+    std::string tag;
+    std::string size;
+};
+typedef DelimitedParser<ImageLine, &ImageLine::id, &ImageLine::repository,
+                        &ImageLine::tag, &ImageLine::size> ImageParser;
+typedef DelimitedParser<VolumeInfo, &VolumeInfo::name, &VolumeInfo::driver> VolumeParser;
+
+// GetDiskUsage() over the CLI. `docker ps` shows a volume mount by its
+// name and a bind mount by its host path.
+const char kContainerUsageFormat[] = "{{.ID}}|{{.Names}}|{{.State}}|{{.Image}}|{{.Mounts}}";
+struct ContainerUsageLine {
+    std::string id;
+    std::string name;
+    std::string state;
+    std::string image;
+    std::string mounts;
+};
+typedef DelimitedParser<ContainerUsageLine, &ContainerUsageLine::id, &ContainerUsageLine::name,
+                        &ContainerUsageLine::state, &ContainerUsageLine::image,
+                        &ContainerUsageLine::mounts> ContainerUsageParser;
+struct ImageParentLine {
+    std::string id;
+    std::string parent;
+};
+typedef DelimitedParser<ImageParentLine, &ImageParentLine::id,
+                        &ImageParentLine::parent> ImageParentParser;
+
+struct StatsLine {
+    std::string cpu;
+    std::string mem;
+};
+typedef DelimitedParser<StatsLine, &StatsLine::cpu, &StatsLine::mem> StatsLineParser;
+
+// GetImage() over the CLI; the tags are joined with commas.
+struct ImageInspectLine {
+    std::string id;
+    std::string tags;
+    std::string size;
+};
+typedef DelimitedParser<ImageInspectLine, &ImageInspectLine::id, &ImageInspectLine::tags,
+                        &ImageInspectLine::size> ImageInspectParser;
+
+// Output with one value per line: IDs, layer digests, sizes.
+struct ValueLine {
+    std::string value;
+};
+typedef DelimitedParser<ValueLine, &ValueLine::value> ValueParser;
+
+// Skips lines with the wrong number of fields and returns false if there
+// were any, so callers that can fail treat the output as incomplete.
+template <typename Parser, typename T>
+bool ParseCliOutput(const std::string& output, std::vector<T>& records) {
+    std::vector<std::string> malformed;
+    Parser::Parse(output.data(), output.size(), records, &malformed);
+    return malformed.empty();
+}
+
+bool ParseImageLines(const std::string& output, std::vector<ImageInfo>& images) {
+    std::vector<ImageLine> lines;
+    const bool complete = ParseCliOutput<ImageParser>(output, lines);
+    images.reserve(images.size() + lines.size());
+    for (auto& line : lines) {
+        ImageInfo info;
+        info.id.swap(line.id);
+        info.repository.swap(line.repository);
+        info.tag.swap(line.tag);
+        ParseByteSize(line.size, info.size);
+        images.push_back(std::move(info));
+    }
+    return complete;
+}
+
+// Names come as ["/web"]; several names are joined with commas.
+std::string ContainerName(const std::vector<std::string>& names) {
+    std::string name;
+    for (const auto& n : names) {
+        if (!name.empty()) name += ',';
+        name += (!n.empty() && n[0] == '/') ? n.substr(1) : n;
+    }
+    return name;
+}
+
+bool ParseContainerList(const std::string& body, std::vector<ContainerInfo>& containers) {
+    JsonReader json(body);
+    if (!json.BeginArray()) return false;
+
+    std::string key;
+    std::vector<std::string> names;
+    while (json.NextElement()) {
+        ContainerInfo info;
+        if (!json.BeginObject()) return false;
+        while (json.NextKey(key)) {
+            if (key == "Id") {
+                json.ReadString(info.id);
+                info.id = ShortId(info.id);
+            } else if (key == "Names") {
+                ReadStringArray(json, names);
+                info.name = ContainerName(names);
+            } else if (key == "State") {
+                json.ReadString(info.state);
+            } else if (key == "Status") {
+                json.ReadString(info.status);
+            } else if (key == "Image") {
+                json.ReadString(info.image);
+            } else {
+                json.Skip();
+            }
+        }
+        if (json.Failed()) return false;
+        containers.push_back(info);
+    }
+    return !json.Failed();
+}
+
+// Appends one row per tag of a single image object, like `docker images`.
+bool ParseImageObject(JsonReader& json, std::vector<ImageInfo>& images) {
+    std::string key;
+    std::string id;
+    std::vector<std::string> tags;
+    std::vector<std::string> digests;
+    int64_t size = 0;
+
+    if (!json.BeginObject()) return false;
+    while (json.NextKey(key)) {
+        if (key == "Id") {
+            json.ReadString(id);
+        } else if (key == "RepoTags") {
+            ReadStringArray(json, tags);
+        } else if (key == "RepoDigests") {
+            ReadStringArray(json, digests);
+        } else if (key == "Size") {
+            json.ReadInt64(size);
+        } else {
+            json.Skip();
+        }
+    }
+    if (json.Failed()) return false;
+
+    ImageInfo info;
+    info.id = ShortId(id);
+    info.size = size;
+
+    tags.erase(std::remove(tags.begin(), tags.end(), "<none>:<none>"), tags.end());
+    if (tags.empty()) {
+        info.repository = kNone;
+        info.tag = kNone;
+        if (!digests.empty()) {
+            info.repository = digests.front().substr(0, digests.front().find('@'));
+        }
+        images.push_back(info);
+        return true;
+    }
+    for (const auto& ref : tags) {
+        SplitRepoTag(ref, info.repository, info.tag);
+        images.push_back(info);
+    }
+    return true;
+}
+
+bool ParseImageList(const std::string& body, std::vector<ImageInfo>& images) {
+    JsonReader json(body);
+    if (!json.BeginArray()) return false;
+    while (json.NextElement()) {
+        if (!ParseImageObject(json, images)) return false;
+    }
+    return !json.Failed();
+}
+
+bool ParseVolumeObject(JsonReader& json, VolumeInfo& info) {
+    std::string key;
+    if (!json.BeginObject()) return false;
+    while (json.NextKey(key)) {
+        if (key == "Name") {
+            json.ReadString(info.name);
+        } else if (key == "Driver") {
+            json.ReadString(info.driver);
+        } else {
+            json.Skip();
+        }
+    }
+    return !json.Failed();
+}
+
+bool ParseVolumeList(const std::string& body, std::vector<VolumeInfo>& volumes) {
+    JsonReader json(body);
+    if (!json.BeginObject()) return false;
+
+    std::string key;
+    while (json.NextKey(key)) {
+        if (key != "Volumes" || json.Peek() != JsonReader::Type::Array) {
+            json.Skip();
+            continue;
+        }
+        json.BeginArray();
+        while (json.NextElement()) {
+            VolumeInfo info;
+            if (!ParseVolumeObject(json, info)) return false;
+            volumes.push_back(info);
+        }
+    }
+    return !json.Failed();
+}
+
+// One of /system/df's Volumes; UsageData.Size is -1 when not computed.
+bool ParseVolumeUsageObject(JsonReader& json, DiskUsage::Volume& volume) {
+    std::string key;
+    if (!json.BeginObject()) return false;
+    while (json.NextKey(key)) {
+        if (key == "Name") {
+            json.ReadString(volume.name);
+        } else if (key == "UsageData" && json.Peek() == JsonReader::Type::Object) {
+            json.BeginObject();
+            while (json.NextKey(key)) {
+                if (key == "Size") {
+                    json.ReadInt64(volume.size);
+                } else {
+                    json.Skip();
+                }
+            }
+        } else {
+            json.Skip();
+        }
+    }
+    return !json.Failed();
+}
+
+bool ParseVolumeUsage(const std::string& body, std::map<std::string, int64_t>& sizes) {
+    JsonReader json(body);
+    if (!json.BeginObject()) return false;
+
+    std::string key;
+    while (json.NextKey(key)) {
+        if (key != "Volumes" || json.Peek() != JsonReader::Type::Array) {
+            json.Skip();
+            continue;
+        }
+        json.BeginArray();
+        while (json.NextElement()) {
+            DiskUsage::Volume volume;
+            if (!ParseVolumeUsageObject(json, volume)) return false;
+            if (!volume.name.empty()) sizes[volume.name] = volume.size;
+        }
+    }
+    return !json.Failed();
+}
+
+// RootFS.Layers of an image object: diff IDs, base layer first.
+bool ParseRootFsLayers(const std::string& body, std::vector<std::string>& layers) {
+    JsonReader json(body);
+    if (!json.BeginObject()) return false;
+
+    std::string key;
+    while (json.NextKey(key)) {
+        if (key != "RootFS" || json.Peek() != JsonReader::Type::Object) {
+            json.Skip();
+            continue;
+        }
+        json.BeginObject();
+        while (json.NextKey(key)) {
+            if (key == "Layers") {
+                if (!ReadStringArray(json, layers)) return false;
+            } else {
+                json.Skip();
+            }
+        }
+    }
+    return !json.Failed();
+}
+
+// Size of each /images/{id}/history entry, oldest first (the API lists the
+// newest first).
+bool ParseHistorySizes(const std::string& body, std::vector<int64_t>& sizes) {
+    JsonReader json(body);
+    if (!json.BeginArray()) return false;
+
+    std::string key;
+    while (json.NextElement()) {
+        int64_t size = 0;
+        if (!json.BeginObject()) return false;
+        while (json.NextKey(key)) {
+            if (key == "Size") {
+                json.ReadInt64(size);
+            } else {
+                json.Skip();
+            }
+        }
+        sizes.push_back(size);
+    }
+    if (json.Failed()) return false;
+    std::reverse(sizes.begin(), sizes.end());
+    return true;
+}
+
+// Pairs diff IDs with history sizes. History also lists steps that made no
+// layer (ENV, CMD, ...) with size 0, and an empty RUN makes a 0-byte layer,
+// so a 0 takes a layer only while the layers left outnumber the non-zero
+// entries left. False if the two lists cannot describe the same image.
+bool MatchLayerSizes(const std::vector<std::string>& diffIds,
+                     const std::vector<int64_t>& sizes, std::vector<ImageLayer>& layers) {
+    std::vector<size_t> nonZeroAfter(sizes.size() + 1, 0);
+    for (size_t i = sizes.size(); i > 0; --i) {
+        nonZeroAfter[i - 1] = nonZeroAfter[i] + (sizes[i - 1] > 0 ? 1 : 0);
+    }
+    if (nonZeroAfter[0] > diffIds.size()) return false;
+
+    layers.clear();
+    layers.reserve(diffIds.size());
+    for (size_t i = 0; i < sizes.size() && layers.size() < diffIds.size(); ++i) {
+        const size_t layersLeft = diffIds.size() - layers.size();
+        if (sizes[i] == 0 && layersLeft <= nonZeroAfter[i]) continue;
+        ImageLayer layer;
+        layer.diffId = diffIds[layers.size()];
+        layer.size = sizes[i];
+        layers.push_back(layer);
+    }
+    return layers.size() == diffIds.size();
+}
+
+bool ParseDiskUsageContainer(JsonReader& json, DiskUsage::Container& container) {
+    std::string key;
+    std::string type;
+    std::string name;
+    std::vector<std::string> names;
+    if (!json.BeginObject()) return false;
+    while (json.NextKey(key)) {
+        if (key == "Id") {
+            json.ReadString(container.id);
+            container.id = ShortId(container.id);
+        } else if (key == "Names") {
+            ReadStringArray(json, names);
+            container.name = ContainerName(names);
+        } else if (key == "State") {
+            json.ReadString(container.state);
+        } else if (key == "Image") {
+            json.ReadString(container.image);
+        } else if (key == "ImageID") {
+            json.ReadString(container.image_id);
+            container.image_id = ShortId(container.image_id);
+        } else if (key == "SizeRw") {
+            json.ReadInt64(container.size);
+        } else if (key == "Mounts" && json.Peek() == JsonReader::Type::Array) {
+            json.BeginArray();
+            while (json.NextElement()) {
+                type.clear();
+                name.clear();
+                if (!json.BeginObject()) return false;
+                while (json.NextKey(key)) {
+                    if (key == "Type") {
+                        json.ReadString(type);
+                    } else if (key == "Name") {
+                        json.ReadString(name);
+                    } else {
+                        json.Skip();
+                    }
+                }
+                if (type == "volume" && !name.empty()) container.volumes.push_back(name);
+            }
+        } else {
+            json.Skip();
+        }
+    }
+    return !json.Failed();
+}
+
+bool ParseDiskUsageImage(JsonReader& json, DiskUsage::Image& image) {
+    std::string key;
+    if (!json.BeginObject()) return false;
+    while (json.NextKey(key)) {
+        if (key == "Id") {
+            json.ReadString(image.id);
+            image.id = ShortId(image.id);
+        } else if (key == "ParentId") {
+            json.ReadString(image.parent_id);
+            image.parent_id = ShortId(image.parent_id);
+        } else if (key == "RepoTags") {
+            ReadStringArray(json, image.tags);
+            image.tags.erase(std::remove(image.tags.begin(), image.tags.end(), "<none>:<none>"),
+                             image.tags.end());
+        } else if (key == "Size") {
+            json.ReadInt64(image.size);
+        } else if (key == "SharedSize") {
+            json.ReadInt64(image.shared_size);
+        } else {
+            json.Skip();
+        }
+    }
+    return !json.Failed();
+}
+
+// Sums BuildCache[].Size over the records no build is using.
+bool ParseBuildCacheBytes(JsonReader& json, int64_t& bytes) {
+    std::string key;
+    bytes = 0;
+    if (!json.BeginArray()) return false;
+    while (json.NextElement()) {
+        int64_t size = 0;
+        bool inUse = false;
+        if (!json.BeginObject()) return false;
+        while (json.NextKey(key)) {
+            if (key == "Size") {
+                json.ReadInt64(size);
+            } else if (key == "InUse") {
+                json.ReadBool(inUse);
+            } else {
+                json.Skip();
+            }
+        }
+        if (!inUse) bytes += size;
+    }
+    return !json.Failed();
+}
+
+// The whole /system/df answer.
+bool ParseDiskUsage(const std::string& body, DiskUsage& usage) {
+    JsonReader json(body);
+    if (!json.BeginObject()) return false;
+
+    std::string key;
+    while (json.NextKey(key)) {
+        const bool array = json.Peek() == JsonReader::Type::Array;
+        if (key == "Containers" && array) {
+            json.BeginArray();
+            while (json.NextElement()) {
+                usage.containers.emplace_back();
+                if (!ParseDiskUsageContainer(json, usage.containers.back())) return false;
+            }
+        } else if (key == "Images" && array) {
+            json.BeginArray();
+            while (json.NextElement()) {
+                usage.images.emplace_back();
+                if (!ParseDiskUsageImage(json, usage.images.back())) return false;
+            }
+        } else if (key == "Volumes" && array) {
+            json.BeginArray();
+            while (json.NextElement()) {
+                usage.volumes.emplace_back();
+                if (!ParseVolumeUsageObject(json, usage.volumes.back())) return false;
+            }
+        } else if (key == "BuildCache" && array) {
+            if (!ParseBuildCacheBytes(json, usage.build_cache_bytes)) return false;
+        } else {
+            json.Skip();
+        }
+    }
+    return !json.Failed();
+}
+
+bool ReadInt64OrNull(JsonReader& json, int64_t& out) {
+    if (json.Peek() == JsonReader::Type::Null) return json.Skip();
+    return json.ReadInt64(out);
+}
+
+bool ParseInspectState(JsonReader& json, ContainerDetails& details) {
+    std::string key;
+    if (!json.BeginObject()) return false;
+    while (json.NextKey(key)) {
+        if (key == "StartedAt") {
+            json.ReadString(details.startedAt);
+        } else if (key == "Health" && json.Peek() == JsonReader::Type::Object) {
+            json.BeginObject();
+            while (json.NextKey(key)) {
+                if (key == "Status") {
+                    json.ReadString(details.health);
+                } else if (key == "FailingStreak") {
+                    int64_t streak = 0;
+                    json.ReadInt64(streak);
+                    details.failingStreak = static_cast<int>(streak);
+                } else {
+                    json.Skip();
+                }
+            }
+        } else {
+            json.Skip();
+        }
+    }
+    return !json.Failed();
+}
+
+bool ParseInspectHostConfig(JsonReader& json, ContainerDetails& details) {
+    std::string key;
+    if (!json.BeginObject()) return false;
+    while (json.NextKey(key)) {
+        if (key == "Memory") {
+            ReadInt64OrNull(json, details.memoryLimit);
+        } else if (key == "NanoCpus") {
+            ReadInt64OrNull(json, details.nanoCpus);
+        } else if (key == "CpuShares") {
+            ReadInt64OrNull(json, details.cpuShares);
+        } else if (key == "PidsLimit") {
+            ReadInt64OrNull(json, details.pidsLimit);
+        } else if (key == "RestartPolicy" && json.Peek() == JsonReader::Type::Object) {
+            json.BeginObject();
+            while (json.NextKey(key)) {
+                if (key == "Name") {
+                    json.ReadString(details.restartPolicy);
+                } else {
+                    json.Skip();
+                }
+            }
+        } else {
+            json.Skip();
+        }
+    }
+    return !json.Failed();
+}
+
+// NetworkSettings.Ports: {"80/tcp": [{"HostIp": "0.0.0.0", "HostPort": "8080"}]},
+// with null for a port that is exposed but not published.
+bool ParseInspectPorts(JsonReader& json, std::vector<std::string>& ports) {
+    std::string key;
+    std::string port;
+    std::string hostIp;
+    std::string hostPort;
+    if (!json.BeginObject()) return false;
+    while (json.NextKey(port)) {
+        if (json.Peek() != JsonReader::Type::Array) {
+            json.Skip();
+            ports.push_back(port);
+            continue;
+        }
+        json.BeginArray();
+        while (json.NextElement()) {
+            hostIp.clear();
+            hostPort.clear();
+            if (!json.BeginObject()) return false;
+            while (json.NextKey(key)) {
+                if (key == "HostIp") {
+                    json.ReadString(hostIp);
+                } else if (key == "HostPort") {
+                    json.ReadString(hostPort);
+                } else {
+                    json.Skip();
+                }
+            }
+            // Written the way `docker ps` writes them.
+            if (hostIp.find(':') != std::string::npos) hostIp = "[" + hostIp + "]";
+            ports.push_back(hostIp + ":" + hostPort + "->" + port);
+        }
+    }
+    return !json.Failed();
+}
+
+bool ParseInspectMounts(JsonReader& json, std::vector<ContainerDetails::Mount>& mounts) {
+    std::string key;
+    std::string name;
+    bool readWrite = true;
+    if (!json.BeginArray()) return false;
+    while (json.NextElement()) {
+        ContainerDetails::Mount mount;
+        name.clear();
+        readWrite = true;
+        if (!json.BeginObject()) return false;
+        while (json.NextKey(key)) {
+            if (key == "Type") {
+                json.ReadString(mount.type);
+            } else if (key == "Name") {
+                json.ReadString(name);
+            } else if (key == "Source") {
+                json.ReadString(mount.source);
+            } else if (key == "Destination") {
+                json.ReadString(mount.destination);
+            } else if (key == "RW") {
+                json.ReadBool(readWrite);
+            } else {
+                json.Skip();
+            }
+        }
+        // A volume's host path says less than its name.
+        if (!name.empty()) mount.source = name;
+        mount.readOnly = !readWrite;
+        mounts.push_back(std::move(mount));
+    }
+    return !json.Failed();
+}
+
+bool ParseContainerDetails(JsonReader& json, ContainerDetails& details) {
+    std::string key;
+    if (!json.BeginObject()) return false;
+    while (json.NextKey(key)) {
+        const JsonReader::Type type = json.Peek();
+        const bool object = type == JsonReader::Type::Object;
+        if (key == "Id") {
+            json.ReadString(details.id);
+            details.id = ShortId(details.id);
+        } else if (key == "Name") {
+            json.ReadString(details.name);
+            if (!details.name.empty() && details.name[0] == '/') details.name.erase(0, 1);
+        } else if (key == "RestartCount") {
+            int64_t count = 0;
+            json.ReadInt64(count);
+            details.restartCount = static_cast<int>(count);
+        } else if (key == "State" && object) {
+            if (!ParseInspectState(json, details)) return false;
+        } else if (key == "HostConfig" && object) {
+            if (!ParseInspectHostConfig(json, details)) return false;
+        } else if (key == "Mounts" && type == JsonReader::Type::Array) {
+            if (!ParseInspectMounts(json, details.mounts)) return false;
+        } else if (key == "Config" && object) {
+            json.BeginObject();
+            while (json.NextKey(key)) {
+                if (key == "Image") {
+                    json.ReadString(details.image);
+                } else if (key == "Env") {
+                    ReadStringArray(json, details.env);
+                } else {
+                    json.Skip();
+                }
+            }
+        } else if (key == "NetworkSettings" && object) {
+            json.BeginObject();
+            while (json.NextKey(key)) {
+                if (key == "Ports" && json.Peek() == JsonReader::Type::Object) {
+                    if (!ParseInspectPorts(json, details.ports)) return false;
+                } else {
+                    json.Skip();
+                }
+            }
+        } else {
+            json.Skip();
+        }
+    }
+    return !json.Failed();
+}
+
+// "Error: No such image: ...", "Error response from daemon: no such volume".
+bool IsNoSuchObject(const CommandResult& res) {
+    std::string message = res.error;
+    for (char& c : message) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return !res.timed_out && message.find("no such ") != std::string::npos;
+}
+
+// First line of the CLI's stderr, e.g. "Error response from daemon: ...".
+std::string CliErrorMessage(const CommandResult& res) {
+    std::string message = res.error.substr(0, res.error.find('\n'));
+    if (message.empty()) message = "exit code " + std::to_string(res.exit_code);
+    return message;
+}
+
+struct ApiResult {
+    int status = -1;
+    std::string body;
+};
+
+AdmissionGate& Gate() {
+    static AdmissionGate gate(kDefaultMaxDaemonCalls);
+    return gate;
+}
+
+std::atomic<uint64_t> coalescedCalls(0);
+
+template <typename T>
+T Coalesce(SingleFlight<T>& flight, const std::string& key, const std::function<T()>& fn) {
+    bool shared = false;
+    T result = flight.Do(key, fn, &shared);
+    if (shared) ++coalescedCalls;
+    return result;
+}
+
+// CLI commands that only read state, so identical ones can share a result.
+bool IsReadOnlyCommand(const std::vector<std::string>& args) {
+    if (args.empty()) return false;
+    const std::string& command = args[0];
+    if (command == "ps" || command == "images" || command == "info" ||
+        command == "inspect" || command == "version" || command == "history") return true;
+    if (command == "stats") {
+        return std::find(args.begin(), args.end(), "--no-stream") != args.end();
+    }
+    if ((command == "volume" || command == "image" || command == "container") &&
+        args.size() > 1) {
+        return args[1] == "ls" || args[1] == "inspect";
+    }
+    return false;
+}
+
+}  // namespace
+
+const size_t DockerCommands::kCallHeadroom;
+
+void DockerCommands::SetMaxConcurrentCalls(size_t limit) {
+    Gate().SetLimit(limit);
+}
+
+DaemonCallStats DockerCommands::GetCallStats() {
+    AdmissionGate& gate = Gate();
+    DaemonCallStats stats;
+    stats.active = gate.Active();
+    stats.waiting = gate.Waiting();
+    stats.limit = gate.Limit();
+    stats.coalesced = coalescedCalls.load();
+    return stats;
+}
+
+int DockerCommands::ApiCall(const std::string& method, const std::string& path,
+                            std::string* body, int timeoutMs) {
+    DockerApiClient& api = DockerApiClient::Instance();
+    if (!api.IsEnabled()) return -1;
+
+    std::function<ApiResult()> request = [&api, &method, &path, timeoutMs]() {
+        ApiResult result;
+        AdmissionGate::Slot slot(Gate());
+        HttpResponse response;
+        if (api.Request(method, path, response, nullptr, timeoutMs)) {
+            result.status = response.status;
+            result.body.swap(response.body);
+        }
+        return result;
+    };
+
+    static SingleFlight<ApiResult> flight;
+    ApiResult result = method == "GET" ? Coalesce(flight, path, request) : request();
+    if (body) body->swap(result.body);
+    return result.status;
+}
+
+bool DockerCommands::ApiListContainers(const std::string& query,
+                                       std::vector<ContainerInfo>& containers) {
+    std::string body;
+    if (ApiCall("GET", "/containers/json" + query, &body) == 200 &&
+        ParseContainerList(body, containers)) {
+        return true;
+    }
+    containers.clear();
+    return false;
+}
+
+bool DockerCommands::ApiListImages(const std::string& query, std::vector<ImageInfo>& images) {
+    std::string body;
+    if (ApiCall("GET", "/images/json" + query, &body) == 200 && ParseImageList(body, images)) {
+        return true;
+    }
+    images.clear();
+    return false;
+}
+
+bool DockerCommands::ApiListVolumes(const std::string& query, std::vector<VolumeInfo>& volumes) {
+    std::string body;
+    if (ApiCall("GET", "/volumes" + query, &body) == 200 && ParseVolumeList(body, volumes)) {
+        return true;
+    }
+    volumes.clear();
+    return false;
+}
+
 bool DockerCommands::IsValidDockerIdentifier(const std::string& str) {
     if (str.empty() || str.size() > 256) return false;
     return std::all_of(str.begin(), str.end(), [](char c) {
@@ -33,337 +844,503 @@ std::string DockerCommands::FindDockerBinary() {
     return cached;
 }
 
+DockerCommands::DaemonStatus DockerCommands::ProbeDaemon() {
+    static std::mutex mutex;
+    static DaemonStatus last;
+    static std::chrono::steady_clock::time_point lastTime;
+
+    auto now = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (lastTime != std::chrono::steady_clock::time_point() &&
+            now - lastTime < std::chrono::milliseconds(kProbeReuseMs)) return last;
+    }
+
+    DaemonStatus status;
+    std::string body;
+    int code = ApiCall("GET", "/_ping", &body);
+    if (code == 200) {
+        status.available = true;
+    } else if (code > 0) {
+        status.error = "Docker daemon returned HTTP " + std::to_string(code) + ": " + body;
+    } else {
+        CommandResult res = RunDocker({"info"});
+        status.available = res.exit_code == 0;
+        if (!status.available) status.error = res.error.empty() ? res.output : res.error;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    last = status;
+    lastTime = std::chrono::steady_clock::now();
+    return status;
+}
+
 bool DockerCommands::IsDockerAvailable() {
-    CommandResult res = ExecuteCommand(
-        FindDockerBinary() + " info 2>/dev/null");
-    return res.exit_code == 0;
+    return ProbeDaemon().available;
 }
 
 std::string DockerCommands::GetDockerError() {
-    CommandResult res = ExecuteCommand(
-        FindDockerBinary() + " info 2>&1");
-    if (res.exit_code == 0) return "";
-    return res.output;
+    return ProbeDaemon().error;
 }
 
-CommandResult DockerCommands::ExecuteCommand(const std::string& command) {
-    CommandResult result;
-    result.exit_code = -1;
-    std::array<char, 256> buffer;
+CommandResult DockerCommands::RunDocker(const std::vector<std::string>& args, int timeoutMs) {
+    std::vector<std::string> argv;
+    argv.reserve(args.size() + 1);
+    argv.push_back(FindDockerBinary());
+    argv.insert(argv.end(), args.begin(), args.end());
 
-    FILE* pipe = popen(command.c_str(), "r");
-    if (!pipe) {
-        return result;
-    }
+    std::function<CommandResult()> run = [&argv, timeoutMs]() {
+        AdmissionGate::Slot slot(Gate());
+        return ProcessRunner::Run(argv, timeoutMs);
+    };
+    if (!IsReadOnlyCommand(args)) return run();
 
-    while (fgets(buffer.data(), buffer.size(), pipe) != nullptr) {
-        result.output += buffer.data();
+    std::string key;
+    for (const auto& arg : args) {
+        key += arg;
+        key += '\0';
     }
-
-    int status = pclose(pipe);
-    result.exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
-    return result;
+    static SingleFlight<CommandResult> flight;
+    return Coalesce(flight, key, run);
 }
 
 std::vector<ContainerInfo> DockerCommands::GetRunningContainers() {
     std::vector<ContainerInfo> containers;
-    CommandResult res = ExecuteCommand(
-        FindDockerBinary() + " ps --format '{{.ID}}|{{.Names}}|{{.State}}|{{.Status}}|{{.Image}}' 2>/dev/null");
-
-    if (res.exit_code != 0) return containers;
-
-    std::istringstream stream(res.output);
-    std::string line;
+    if (ApiListContainers("", containers)) return containers;
 
-    while (std::getline(stream, line)) {
-        if (line.empty()) continue;
+    CommandResult res = RunDocker({"ps", "--format", kContainerFormat});
 
-        ContainerInfo info;
-        std::istringstream lineStream(line);
+    if (res.exit_code != 0) return containers;
 
-        std::getline(lineStream, info.id, '|');
-        std::getline(lineStream, info.name, '|');
-        std::getline(lineStream, info.state, '|');
-        std::getline(lineStream, info.status, '|');
-        std::getline(lineStream, info.image, '|');
-
-        containers.push_back(info);
-    }
+    ParseCliOutput<ContainerParser>(res.output, containers);
 
     return containers;
 }
 
 std::vector<ContainerInfo> DockerCommands::GetStoppedContainers() {
     std::vector<ContainerInfo> containers;
-    CommandResult res = ExecuteCommand(
-        FindDockerBinary() + " ps -a --filter 'status=exited' --filter 'status=created' "
-        "--filter 'status=dead' "
-        "--format '{{.ID}}|{{.Names}}|{{.State}}|{{.Status}}|{{.Image}}' 2>/dev/null");
-
-    if (res.exit_code != 0) return containers;
-
-    std::istringstream stream(res.output);
-    std::string line;
+    if (ApiListContainers("?all=1&filters=" +
+                          DockerApiClient::UrlEncode("{\"status\":[\"exited\",\"created\",\"dead\"]}"),
+                          containers)) return containers;
 
-    while (std::getline(stream, line)) {
-        if (line.empty()) continue;
+    CommandResult res = RunDocker({"ps", "-a", "--filter", "status=exited",
+                                   "--filter", "status=created", "--filter", "status=dead",
+                                   "--format", kContainerFormat});
 
-        ContainerInfo info;
-        std::istringstream lineStream(line);
-
-        std::getline(lineStream, info.id, '|');
-        std::getline(lineStream, info.name, '|');
-        std::getline(lineStream, info.state, '|');
-        std::getline(lineStream, info.status, '|');
-        std::getline(lineStream, info.image, '|');
+    if (res.exit_code != 0) return containers;
 
-        containers.push_back(info);
-    }
+    ParseCliOutput<ContainerParser>(res.output, containers);
 
     return containers;
 }
 
-std::vector<ContainerInfo> DockerCommands::GetAllContainers() {
-    std::vector<ContainerInfo> containers;
-    CommandResult res = ExecuteCommand(
-        FindDockerBinary() + " ps -a --format '{{.ID}}|{{.Names}}|{{.State}}|{{.Status}}|{{.Image}}' 2>/dev/null");
+bool DockerCommands::GetAllContainers(std::vector<ContainerInfo>& containers) {
+    containers.clear();
+    if (ApiListContainers("?all=1", containers)) return true;
 
-    if (res.exit_code != 0) return containers;
+    CommandResult res = RunDocker({"ps", "-a", "--format", kContainerFormat});
 
-    std::istringstream stream(res.output);
-    std::string line;
+    if (res.exit_code != 0) return false;
 
-    while (std::getline(stream, line)) {
-        if (line.empty()) continue;
+    return ParseCliOutput<ContainerParser>(res.output, containers);
+}
 
-        ContainerInfo info;
-        std::istringstream lineStream(line);
+bool DockerCommands::GetAllImages(std::vector<ImageInfo>& images) {
+    images.clear();
+    if (ApiListImages("?all=1", images)) return true;
 
-        std::getline(lineStream, info.id, '|');
-        std::getline(lineStream, info.name, '|');
-        std::getline(lineStream, info.state, '|');
-        std::getline(lineStream, info.status, '|');
-        std::getline(lineStream, info.image, '|');
+    CommandResult res = RunDocker({"images", "-a", "--format", kImageFormat});
 
-        containers.push_back(info);
-    }
+    if (res.exit_code != 0) return false;
 
-    return containers;
+    // Half a listing would drop rows from the model.
+    return ParseImageLines(res.output, images);
 }
 
-std::vector<ImageInfo> DockerCommands::GetUnusedImages() {
-    std::vector<ImageInfo> images;
-    CommandResult res = ExecuteCommand(
-        FindDockerBinary() + " images -f 'dangling=true' "
-        "--format '{{.ID}}|{{.Repository}}|{{.Tag}}|{{.Size}}' 2>/dev/null");
+bool DockerCommands::GetAllVolumes(std::vector<VolumeInfo>& volumes) {
+    volumes.clear();
+    if (ApiListVolumes("", volumes)) return true;
 
-    if (res.exit_code != 0) return images;
+    CommandResult res = RunDocker({"volume", "ls", "--format", kVolumeFormat});
 
-    std::istringstream stream(res.output);
-    std::string line;
+    if (res.exit_code != 0) return false;
 
-    while (std::getline(stream, line)) {
-        if (line.empty()) continue;
-
-        ImageInfo info;
-        std::istringstream lineStream(line);
-
-        std::getline(lineStream, info.id, '|');
-        std::getline(lineStream, info.repository, '|');
-        std::getline(lineStream, info.tag, '|');
-        std::getline(lineStream, info.size, '|');
+    return ParseCliOutput<VolumeParser>(res.output, volumes);
+}
 
-        images.push_back(info);
+DockerCommands::Lookup DockerCommands::GetContainer(const std::string& id, ContainerInfo& info) {
+    if (!IsValidDockerIdentifier(id)) return Lookup::Failed;
+
+    // A filtered listing answers "no such container" with an empty list.
+    std::vector<ContainerInfo> found;
+    std::string filter = DockerApiClient::UrlEncode("{\"id\":[\"" + id + "\"]}");
+    if (!ApiListContainers("?all=1&filters=" + filter, found)) {
+        CommandResult res = RunDocker({"ps", "-a", "--filter", "id=" + id,
+                                       "--format", kContainerFormat});
+        if (res.exit_code != 0 || !ParseCliOutput<ContainerParser>(res.output, found)) {
+            return Lookup::Failed;
+        }
     }
 
-    return images;
+    if (found.empty()) return Lookup::Missing;
+    info = found.front();
+    return Lookup::Found;
 }
 
-std::vector<ImageInfo> DockerCommands::GetAllImages() {
-    std::vector<ImageInfo> images;
-    CommandResult res = ExecuteCommand(
-        FindDockerBinary() + " images -a "
-        "--format '{{.ID}}|{{.Repository}}|{{.Tag}}|{{.Size}}' 2>/dev/null");
-
-    if (res.exit_code != 0) return images;
-
-    std::istringstream stream(res.output);
-    std::string line;
+DockerCommands::Lookup DockerCommands::GetImage(const std::string& id,
+                                                std::vector<ImageInfo>& images) {
+    images.clear();
+    if (!IsValidDockerIdentifier(id)) return Lookup::Failed;
+
+    std::string body;
+    int status = ApiCall("GET", "/images/" + DockerApiClient::UrlEncode(id) + "/json", &body);
+    if (status >= 0) {
+        if (status == 404) return Lookup::Missing;
+        JsonReader json(body);
+        if (status != 200 || !ParseImageObject(json, images) || images.empty()) {
+            images.clear();
+            return Lookup::Failed;
+        }
+        return Lookup::Found;
+    }
 
-    while (std::getline(stream, line)) {
-        if (line.empty()) continue;
+    CommandResult res = RunDocker({"image", "inspect", "--format",
+                                   "{{.Id}}|{{join .RepoTags \",\"}}|{{.Size}}", id});
+    if (res.exit_code != 0) return IsNoSuchObject(res) ? Lookup::Missing : Lookup::Failed;
 
-        ImageInfo info;
-        std::istringstream lineStream(line);
+    std::vector<ImageInspectLine> lines;
+    if (!ParseCliOutput<ImageInspectParser>(res.output, lines) || lines.empty()) {
+        return Lookup::Failed;
+    }
 
-        std::getline(lineStream, info.id, '|');
-        std::getline(lineStream, info.repository, '|');
-        std::getline(lineStream, info.tag, '|');
-        std::getline(lineStream, info.size, '|');
+    ImageInfo info;
+    info.id = ShortId(lines[0].id);
+    ParseByteSize(lines[0].size, info.size);
 
+    ForEachField(lines[0].tags, ',', [&info, &images](const char* ref, size_t size) {
+        SplitRepoTag(std::string(ref, size), info.repository, info.tag);
+        images.push_back(info);
+    });
+    if (images.empty()) {
+        info.repository = kNone;
+        info.tag = kNone;
         images.push_back(info);
     }
-
-    return images;
+    return Lookup::Found;
 }
 
-std::vector<VolumeInfo> DockerCommands::GetUnusedVolumes() {
-    std::vector<VolumeInfo> volumes;
-    CommandResult res = ExecuteCommand(
-        FindDockerBinary() + " volume ls -f 'dangling=true' "
-        "--format '{{.Name}}|{{.Driver}}' 2>/dev/null");
-
-    if (res.exit_code != 0) return volumes;
+DockerCommands::Lookup DockerCommands::GetVolume(const std::string& name, VolumeInfo& info) {
+    if (!IsValidDockerIdentifier(name)) return Lookup::Failed;
 
-    std::istringstream stream(res.output);
-    std::string line;
+    std::string body;
+    int status = ApiCall("GET", "/volumes/" + DockerApiClient::UrlEncode(name), &body);
+    if (status >= 0) {
+        if (status == 404) return Lookup::Missing;
+        JsonReader json(body);
+        return status == 200 && ParseVolumeObject(json, info) ? Lookup::Found : Lookup::Failed;
+    }
 
-    while (std::getline(stream, line)) {
-        if (line.empty()) continue;
+    CommandResult res = RunDocker({"volume", "inspect", "--format", kVolumeFormat, name});
+    if (res.exit_code != 0) return IsNoSuchObject(res) ? Lookup::Missing : Lookup::Failed;
 
-        VolumeInfo info;
-        std::istringstream lineStream(line);
+    std::vector<VolumeInfo> volumes;
+    if (!ParseCliOutput<VolumeParser>(res.output, volumes) || volumes.empty()) {
+        return Lookup::Failed;
+    }
+    info = volumes.front();
+    return Lookup::Found;
+}
 
-        std::getline(lineStream, info.name, '|');
-        std::getline(lineStream, info.driver, '|');
+bool DockerCommands::InspectContainer(const std::string& id, ContainerDetails& details) {
+    if (!IsValidDockerIdentifier(id)) return false;
 
-        volumes.push_back(info);
+    std::string body;
+    int status = ApiCall("GET", "/containers/" + DockerApiClient::UrlEncode(id) + "/json", &body);
+    if (status >= 0) {
+        if (status != 200) return false;
+        JsonReader json(body);
+        return ParseContainerDetails(json, details);
     }
 
-    return volumes;
+    // The CLI prints the same objects the API returns, in an array.
+    CommandResult res = RunDocker({"container", "inspect", id});
+    if (res.exit_code != 0) return false;
+    JsonReader json(res.output);
+    if (!json.BeginArray() || !json.NextElement()) return false;
+    return ParseContainerDetails(json, details);
 }
 
-std::vector<VolumeInfo> DockerCommands::GetAllVolumes() {
-    std::vector<VolumeInfo> volumes;
-    CommandResult res = ExecuteCommand(
-        FindDockerBinary() + " volume ls "
-        "--format '{{.Name}}|{{.Driver}}' 2>/dev/null");
-
-    if (res.exit_code != 0) return volumes;
+bool DockerCommands::GetImageLayers(const std::string& id, std::vector<ImageLayer>& layers) {
+    if (!IsValidDockerIdentifier(id)) return false;
 
-    std::istringstream stream(res.output);
-    std::string line;
+    std::vector<std::string> diffIds;
+    std::vector<int64_t> sizes;
+    const std::string path = "/images/" + DockerApiClient::UrlEncode(id);
+    std::string body;
+    int status = ApiCall("GET", path + "/json", &body);
+    if (status >= 0) {
+        if (status != 200 || !ParseRootFsLayers(body, diffIds)) return false;
+        if (ApiCall("GET", path + "/history", &body) != 200) return false;
+        if (!ParseHistorySizes(body, sizes)) return false;
+        return MatchLayerSizes(diffIds, sizes, layers);
+    }
 
-    while (std::getline(stream, line)) {
-        if (line.empty()) continue;
+    CommandResult res = RunDocker({"image", "inspect", "--format",
+                                   "{{range .RootFS.Layers}}{{println .}}{{end}}", id});
+    if (res.exit_code != 0) return false;
+    std::vector<ValueLine> lines;
+    if (!ParseCliOutput<ValueParser>(res.output, lines)) return false;
+    for (auto& line : lines) diffIds.push_back(std::move(line.value));
+
+    res = RunDocker({"history", "--no-trunc", "--human=false", "--format", "{{.Size}}", id});
+    if (res.exit_code != 0) return false;
+    lines.clear();
+    if (!ParseCliOutput<ValueParser>(res.output, lines)) return false;
+    for (const auto& line : lines) {
+        int64_t size = 0;
+        if (!ParseByteSize(line.value, size)) return false;
+        sizes.push_back(size);
+    }
+    std::reverse(sizes.begin(), sizes.end());
+    return MatchLayerSizes(diffIds, sizes, layers);
+}
 
-        VolumeInfo info;
-        std::istringstream lineStream(line);
+bool DockerCommands::GetVolumeSizes(std::map<std::string, int64_t>& sizes) {
+    // `docker system df -v` has no stable machine-readable format, so this
+    // is only available over the API.
+    std::string body;
+    int status = ApiCall("GET", "/system/df?type=volume", &body);
+    if (status != 200) return false;
+    return ParseVolumeUsage(body, sizes);
+}
 
-        std::getline(lineStream, info.name, '|');
-        std::getline(lineStream, info.driver, '|');
+bool DockerCommands::GetDiskUsage(DiskUsage& usage) {
+    std::string body;
+    int status = ApiCall("GET", "/system/df", &body);
+    if (status >= 0) return status == 200 && ParseDiskUsage(body, usage);
+
+    // --no-trunc keeps volume names whole, and image IDs whole for inspect.
+    CommandResult res = RunDocker({"ps", "--all", "--no-trunc", "--format", kContainerUsageFormat});
+    if (res.exit_code != 0) return false;
+    std::vector<ContainerUsageLine> containerLines;
+    if (!ParseCliOutput<ContainerUsageParser>(res.output, containerLines)) return false;
+    for (auto& line : containerLines) {
+        DiskUsage::Container container;
+        container.id = ShortId(line.id);
+        container.name.swap(line.name);
+        container.state.swap(line.state);
+        container.image.swap(line.image);
+        ForEachField(line.mounts, ',', [&container](const char* mount, size_t size) {
+            if (mount[0] != '/') container.volumes.emplace_back(mount, size);
+        });
+        usage.containers.push_back(std::move(container));
+    }
 
-        volumes.push_back(info);
+    res = RunDocker({"images", "--all", "--no-trunc", "--format", kImageFormat});
+    if (res.exit_code != 0) return false;
+    std::vector<ImageLine> imageLines;
+    if (!ParseCliOutput<ImageParser>(res.output, imageLines)) return false;
+    std::map<std::string, size_t> byId;
+    std::vector<std::string> inspectArgs = {"image", "inspect", "--format", "{{.Id}}|{{.Parent}}"};
+    for (const auto& line : imageLines) {
+        auto inserted = byId.insert({ShortId(line.id), usage.images.size()});
+        if (inserted.second) {
+            usage.images.emplace_back();
+            usage.images.back().id = inserted.first->first;
+            ParseByteSize(line.size, usage.images.back().size);
+            inspectArgs.push_back(line.id);
+        }
+        if (line.repository != kNone && line.tag != kNone) {
+            usage.images[inserted.first->second].tags.push_back(line.repository + ':' + line.tag);
+        }
+    }
+    // Parents are only in the inspect output; one call covers every image.
+    if (!usage.images.empty()) {
+        res = RunDocker(inspectArgs);
+        if (res.exit_code != 0) return false;
+        std::vector<ImageParentLine> parents;
+        if (!ParseCliOutput<ImageParentParser>(res.output, parents)) return false;
+        for (const auto& line : parents) {
+            auto it = byId.find(ShortId(line.id));
+            if (it != byId.end()) usage.images[it->second].parent_id = ShortId(line.parent);
+        }
     }
 
-    return volumes;
+    res = RunDocker({"volume", "ls", "--format", kVolumeFormat});
+    if (res.exit_code != 0) return false;
+    std::vector<VolumeInfo> volumes;
+    if (!ParseCliOutput<VolumeParser>(res.output, volumes)) return false;
+    for (auto& info : volumes) {
+        usage.volumes.emplace_back();
+        usage.volumes.back().name.swap(info.name);
+    }
+    return true;
 }
 
 SystemInfo DockerCommands::GetSystemInfo() {
+    StatsCollector& collector = StatsCollector::Instance();
+    collector.Start();
+
+    SystemInfo info;
+    if (collector.GetTotals(info)) return info;
+    return SampleSystemInfo();
+}
+
+SystemInfo DockerCommands::SampleSystemInfo() {
     SystemInfo info;
     info.cpu_usage = 0.0;
-    info.mem_usage = "0 MiB";
+    info.mem_bytes = 0;
     info.container_count = 0;
 
-    CommandResult res = ExecuteCommand(
-        FindDockerBinary() + " stats --no-stream --format '{{.CPUPerc}}|{{.MemUsage}}' 2>/dev/null");
+    CommandResult res = RunDocker({"stats", "--no-stream", "--format", "{{.CPUPerc}}|{{.MemUsage}}"});
 
     if (res.exit_code != 0) return info;
 
-    std::istringstream stream(res.output);
-    std::string line;
+    std::vector<StatsLine> lines;
+    ParseCliOutput<StatsLineParser>(res.output, lines);
+
     double totalCpu = 0.0;
-    double totalMemMiB = 0.0;
+    int64_t totalMem = 0;
     int count = 0;
 
-    while (std::getline(stream, line)) {
-        if (line.empty()) continue;
+    for (const auto& line : lines) {
+        const std::string& mem = line.mem;
 
-        std::istringstream lineStream(line);
-        std::string cpu, mem;
+        double percent = 0.0;
+        if (ParsePercent(line.cpu, percent)) totalCpu += percent;
 
-        std::getline(lineStream, cpu, '|');
-        std::getline(lineStream, mem, '|');
-
-        if (!cpu.empty() && cpu.back() == '%') {
-            cpu.pop_back();
-            try {
-                totalCpu += std::stod(cpu);
-            } catch (...) {}
-        }
-
-        if (!mem.empty()) {
-            try {
-                double val = std::stod(mem);
-                if (mem.find("GiB") != std::string::npos) {
-                    totalMemMiB += val * 1024.0;
-                } else {
-                    totalMemMiB += val;
-                }
-            } catch (...) {}
+        // "12.5MiB / 1.944GiB": usage, then the limit.
+        int64_t used = 0;
+        if (ParseByteSize(StringRef(mem.data(), std::min(mem.find('/'), mem.size())), used)) {
+            totalMem += used;
         }
 
         count++;
     }
 
     info.cpu_usage = totalCpu;
+    info.mem_bytes = totalMem;
     info.container_count = count;
 
-    if (totalMemMiB >= 1024.0) {
-        char buf[64];
-        snprintf(buf, sizeof(buf), "%.2f GiB", totalMemMiB / 1024.0);
-        info.mem_usage = buf;
-    } else {
-        char buf[64];
-        snprintf(buf, sizeof(buf), "%.1f MiB", totalMemMiB);
-        info.mem_usage = buf;
-    }
-
     return info;
 }
 
-bool DockerCommands::StopContainer(const std::string& id) {
-    if (!IsValidDockerIdentifier(id)) return false;
-    CommandResult res = ExecuteCommand(FindDockerBinary() + " stop " + id + " 2>/dev/null");
+bool DockerCommands::StopContainer(const std::string& id, std::string* error) {
+    if (!IsValidDockerIdentifier(id)) {
+        if (error) *error = "invalid container ID";
+        return false;
+    }
+    // 304 means the container was already stopped, which the CLI treats as success.
+    std::string body;
+    int status = ApiCall("POST", "/containers/" + id + "/stop", &body, kStopTimeoutMs);
+    if (status >= 0) {
+        bool ok = status == 204 || status == 304;
+        if (!ok && error) *error = DockerApiClient::ErrorMessage(status, body);
+        return ok;
+    }
+
+    CommandResult res = RunDocker({"stop", id}, kStopTimeoutMs);
+    if (res.exit_code != 0 && error) *error = CliErrorMessage(res);
     return res.exit_code == 0;
 }
 
-bool DockerCommands::StopAllContainers() {
-    CommandResult ids = ExecuteCommand(FindDockerBinary() + " ps -q 2>/dev/null");
-    if (ids.exit_code != 0 || ids.output.empty()) return false;
+bool DockerCommands::StopAllContainers(const ProgressCallback& progress,
+                                       std::vector<BulkItemResult>* results,
+                                       size_t concurrency) {
+    std::vector<std::string> ids;
+    std::vector<ContainerInfo> running;
+    if (ApiListContainers("", running)) {
+        for (const auto& c : running) ids.push_back(c.id);
+    } else {
+        CommandResult res = RunDocker({"ps", "-q"});
+        if (res.exit_code != 0) return false;
+        std::vector<ValueLine> lines;
+        ParseCliOutput<ValueParser>(res.output, lines);
+        for (auto& line : lines) ids.push_back(std::move(line.value));
+    }
+    if (ids.empty()) return false;
+
+    // One stop per container in parallel, so the total is bounded by the
+    // slowest container rather than the sum of their grace periods.
+    BulkExecutor executor(concurrency);
+    std::vector<BulkItemResult> outcome = executor.Run(
+        ids, [](const std::string& id, std::string* error) { return StopContainer(id, error); },
+        progress);
+
+    bool allStopped = true;
+    for (const auto& r : outcome) allStopped = allStopped && r.success;
+    if (results) results->swap(outcome);
+    return allStopped;
+}
 
-    std::string idList = ids.output;
-    for (char& c : idList) {
-        if (c == '\n') c = ' ';
+bool DockerCommands::RemoveContainer(const std::string& id, std::string* error) {
+    if (!IsValidDockerIdentifier(id)) {
+        if (error) *error = "invalid container ID";
+        return false;
     }
-    while (!idList.empty() && idList.back() == ' ') {
-        idList.pop_back();
+    std::string body;
+    int status = ApiCall("DELETE", "/containers/" + id, &body);
+    if (status >= 0) {
+        if (status == 204) return true;
+        if (error) *error = DockerApiClient::ErrorMessage(status, body);
+        return false;
     }
-    if (idList.empty()) return false;
 
-    CommandResult res = ExecuteCommand(FindDockerBinary() + " stop " + idList + " 2>/dev/null");
+    CommandResult res = RunDocker({"rm", id});
+    if (res.exit_code != 0 && error) *error = CliErrorMessage(res);
     return res.exit_code == 0;
 }
 
-bool DockerCommands::RemoveContainer(const std::string& id) {
-    if (!IsValidDockerIdentifier(id)) return false;
-    CommandResult res = ExecuteCommand(FindDockerBinary() + " rm " + id + " 2>/dev/null");
-    return res.exit_code == 0;
-}
+bool DockerCommands::RemoveImage(const std::string& id, std::string* error, bool force) {
+    if (!IsValidDockerIdentifier(id)) {
+        if (error) *error = "invalid image ID";
+        return false;
+    }
+    std::string body;
+    int status = ApiCall("DELETE", "/images/" + DockerApiClient::UrlEncode(id) +
+                         (force ? "?force=1&noprune=1" : ""), &body);
+    if (status >= 0) {
+        if (status == 200) return true;
+        if (error) *error = DockerApiClient::ErrorMessage(status, body);
+        return false;
+    }
 
-bool DockerCommands::RemoveImage(const std::string& id) {
-    if (!IsValidDockerIdentifier(id)) return false;
-    CommandResult res = ExecuteCommand(FindDockerBinary() + " rmi " + id + " 2>/dev/null");
+    CommandResult res = force ? RunDocker({"rmi", "--force", "--no-prune", id})
+                              : RunDocker({"rmi", id});
+    if (res.exit_code != 0 && error) *error = CliErrorMessage(res);
     return res.exit_code == 0;
 }
 
-bool DockerCommands::RemoveVolume(const std::string& name) {
-    if (!IsValidDockerIdentifier(name)) return false;
-    CommandResult res = ExecuteCommand(FindDockerBinary() + " volume rm " + name + " 2>/dev/null");
+bool DockerCommands::RemoveVolume(const std::string& name, std::string* error) {
+    if (!IsValidDockerIdentifier(name)) {
+        if (error) *error = "invalid volume name";
+        return false;
+    }
+    std::string body;
+    int status = ApiCall("DELETE", "/volumes/" + DockerApiClient::UrlEncode(name), &body);
+    if (status >= 0) {
+        if (status == 204) return true;
+        if (error) *error = DockerApiClient::ErrorMessage(status, body);
+        return false;
+    }
+
+    CommandResult res = RunDocker({"volume", "rm", name});
+    if (res.exit_code != 0 && error) *error = CliErrorMessage(res);
     return res.exit_code == 0;
 }
 
-bool DockerCommands::PruneAll() {
-    CommandResult res = ExecuteCommand(FindDockerBinary() + " system prune -af --volumes 2>/dev/null");
+bool DockerCommands::PruneNetworksAndBuildCache(std::string* error) {
+    std::string body;
+    int status = ApiCall("POST", "/networks/prune", &body, kLongTimeoutMs);
+    if (status >= 0) {
+        if (status == 200) status = ApiCall("POST", "/build/prune?all=1", &body, kLongTimeoutMs);
+        if (status == 200) return true;
+        if (error) *error = DockerApiClient::ErrorMessage(status, body);
+        return false;
+    }
+
+    CommandResult res = RunDocker({"network", "prune", "--force"}, kLongTimeoutMs);
+    if (res.exit_code == 0) res = RunDocker({"builder", "prune", "--all", "--force"}, kLongTimeoutMs);
+    if (res.exit_code != 0 && error) *error = CliErrorMessage(res);
     return res.exit_code == 0;
 }
@@ -1,5 +1,11 @@
 #pragma once
 
+#include "bulk_executor.h"
+#include "process_runner.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -15,7 +21,13 @@ struct ImageInfo {
     std::string id;
     std::string repository;
     std::string tag;
-    std::string size;
+    int64_t size = 0;  // bytes
+};
+
+// One layer of an image's root filesystem.
+struct ImageLayer {
+    std::string diffId;  // "sha256:..."
+    int64_t size = 0;    // bytes, uncompressed
 };
 
 struct VolumeInfo {
@@ -25,36 +37,163 @@ struct VolumeInfo {
 
 struct SystemInfo {
     double cpu_usage;
-    std::string mem_usage;
+    int64_t mem_bytes;
     int container_count;
 };
 
-struct CommandResult {
-    std::string output;
-    int exit_code;
+// What `docker system df -v` reports: every container, image and volume,
+// what each container uses, and sizes where the daemon measured them. IDs
+// are short, like everywhere else.
+struct DiskUsage {
+    struct Container {
+        std::string id;
+        std::string name;
+        std::string state;
+        std::string image;     // as given to `docker run`, e.g. "nginx:1.25"
+        std::string image_id;  // empty if only `image` is known
+        std::vector<std::string> volumes;  // names of mounted volumes
+        int64_t size = -1;     // writable layer, bytes
+    };
+    struct Image {
+        std::string id;
+        std::string parent_id;  // set by the classic builder only
+        std::vector<std::string> tags;  // "repo:tag"
+        int64_t size = 0;
+        int64_t shared_size = -1;  // of `size`, bytes in layers other images have too
+    };
+    struct Volume {
+        std::string name;
+        int64_t size = -1;
+    };
+
+    std::vector<Container> containers;
+    std::vector<Image> images;
+    std::vector<Volume> volumes;
+    int64_t build_cache_bytes = -1;  // not in use by a build
+};
+
+// The parts of `docker inspect` that the container list has no room for.
+struct ContainerDetails {
+    struct Mount {
+        std::string type;         // "volume", "bind", "tmpfs"
+        std::string source;       // volume name, or host path for binds
+        std::string destination;
+        bool readOnly = false;
+    };
+
+    std::string id;
+    std::string name;
+    std::string image;
+    std::string startedAt;        // RFC 3339, as the daemon gives it
+    int restartCount = 0;
+    std::string restartPolicy;    // "no", "always", "on-failure", ...
+    std::string health;           // "healthy", "starting"...; empty without a check
+    int failingStreak = 0;        // health checks failed in a row
+    std::vector<std::string> ports;  // "0.0.0.0:8080->80/tcp", or "80/tcp" unpublished
+    std::vector<Mount> mounts;
+    std::vector<std::string> env;    // "NAME=value"
+    int64_t memoryLimit = 0;      // bytes, 0 if unlimited
+    int64_t nanoCpus = 0;         // 1e9 per CPU, 0 if unlimited
+    int64_t cpuShares = 0;        // relative weight, 0 for the default
+    int64_t pidsLimit = 0;        // 0 or negative if unlimited
+};
+
+struct DaemonCallStats {
+    size_t active = 0;     // requests talking to the daemon now
+    size_t waiting = 0;    // requests queued for a free slot
+    size_t limit = 0;
+    uint64_t coalesced = 0;  // requests answered by an identical one in flight
 };
 
 class DockerCommands {
 public:
-    static CommandResult ExecuteCommand(const std::string& command);
+    // Reports finished steps of a multi-step operation; returning false
+    // stops it before the next step.
+    typedef std::function<bool(int done, int total)> ProgressCallback;
+
+    static std::string FindDockerBinary();
+    // Runs the docker CLI with `args` (no shell), killing it after timeoutMs.
+    static CommandResult RunDocker(const std::vector<std::string>& args,
+                                   int timeoutMs = ProcessRunner::kDefaultTimeoutMs);
     static std::vector<ContainerInfo> GetRunningContainers();
     static std::vector<ContainerInfo> GetStoppedContainers();
-    static std::vector<ImageInfo> GetUnusedImages();
-    static std::vector<VolumeInfo> GetUnusedVolumes();
+    // Served from the streaming StatsCollector once it has a sample.
     static SystemInfo GetSystemInfo();
-    static bool StopContainer(const std::string& id);
-    static bool StopAllContainers();
-    static bool RemoveContainer(const std::string& id);
-    static bool RemoveImage(const std::string& id);
-    static bool RemoveVolume(const std::string& name);
-    static bool PruneAll();
+    // The optional error receives the daemon's reason on failure.
+    static bool StopContainer(const std::string& id, std::string* error = nullptr);
+    // Stops up to `concurrency` containers at a time.
+    static bool StopAllContainers(const ProgressCallback& progress = ProgressCallback(),
+                                  std::vector<BulkItemResult>* results = nullptr,
+                                  size_t concurrency = BulkExecutor::kDefaultConcurrency);
+    static bool RemoveContainer(const std::string& id, std::string* error = nullptr);
+    // With `force`, an image tagged in several repositories loses every tag
+    // instead of failing, and its untagged parents are left alone: for
+    // removing an exact set of images, such as a PrunePlan's.
+    static bool RemoveImage(const std::string& id, std::string* error = nullptr,
+                            bool force = false);
+    static bool RemoveVolume(const std::string& name, std::string* error = nullptr);
+    // What `docker system prune` removes besides containers, images and
+    // volumes, which are removed one by one from a DependencyGraph plan.
+    static bool PruneNetworksAndBuildCache(std::string* error = nullptr);
     static bool IsDockerAvailable();
     static std::string GetDockerError();
-    static std::vector<ContainerInfo> GetAllContainers();
-    static std::vector<ImageInfo> GetAllImages();
-    static std::vector<VolumeInfo> GetAllVolumes();
+    // False if the daemon gave no list, which an empty list does not mean.
+    static bool GetAllContainers(std::vector<ContainerInfo>& containers);
+    static bool GetAllImages(std::vector<ImageInfo>& images);
+    static bool GetAllVolumes(std::vector<VolumeInfo>& volumes);
+
+    // Single-object lookups used to patch cached state from Docker events.
+    // Missing only when the daemon said so; Failed when it gave no answer.
+    enum class Lookup { Found, Missing, Failed };
+    static Lookup GetContainer(const std::string& id, ContainerInfo& info);
+    // One ImageInfo per tag.
+    static Lookup GetImage(const std::string& id, std::vector<ImageInfo>& images);
+    static Lookup GetVolume(const std::string& name, VolumeInfo& info);
+
+    // Everything in ContainerDetails, in one request; far heavier than a
+    // list row, so fetch it for the containers someone looks at.
+    static bool InspectContainer(const std::string& id, ContainerDetails& details);
+
+    // An image's layers, base first, sized from its history.
+    static bool GetImageLayers(const std::string& id, std::vector<ImageLayer>& layers);
+
+    // Bytes used per volume name, -1 where the daemon has not measured it.
+    // Engine API only; this walks every volume, so call it sparingly.
+    static bool GetVolumeSizes(std::map<std::string, int64_t>& sizes);
+
+    // One daemon request over the API, which measures every size; the CLI
+    // fallback leaves container, volume and build cache sizes unknown.
+    static bool GetDiskUsage(DiskUsage& usage);
+
+    // Every daemon request, API call or CLI process, holds one of a fixed
+    // number of slots and queues when none is free. Identical read-only
+    // requests in flight at the same time share one result.
+    static void SetMaxConcurrentCalls(size_t limit);
+    // Slots kept beyond a bulk operation's concurrency for the refreshes
+    // that run beside it.
+    static const size_t kCallHeadroom = 4;
+    static DaemonCallStats GetCallStats();
 
 private:
+    struct DaemonStatus {
+        bool available = false;
+        std::string error;
+    };
+
+
     static bool IsValidDockerIdentifier(const std::string& str);
-    static std::string FindDockerBinary();
+    static SystemInfo SampleSystemInfo();
+    static DaemonStatus ProbeDaemon();
+
+    // Engine API path. ApiCall returns -1 when the socket is unreachable;
+    // the lists are false unless the daemon answered 200 with a list, and
+    // the caller then falls back to the docker CLI, which reports failures
+    // its own way.
+    static int ApiCall(const std::string& method, const std::string& path,
+                       std::string* body = nullptr,
+                       int timeoutMs = ProcessRunner::kDefaultTimeoutMs);
+    static bool ApiListContainers(const std::string& query,
+                                  std::vector<ContainerInfo>& containers);
+    static bool ApiListImages(const std::string& query, std::vector<ImageInfo>& images);
+    static bool ApiListVolumes(const std::string& query, std::vector<VolumeInfo>& volumes);
 };
@@ -0,0 +1,183 @@
+#include "docker_events.h"
+#include "docker_api.h"
+#include "docker_commands.h"
+#include "json_reader.h"
+#include "process_runner.h"
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <poll.h>
+#include <unistd.h>
+
+namespace {
+
+const char kEventFilter[] = "{\"type\":[\"container\",\"image\",\"volume\"]}";
+const int kReconnectDelayMs = 2000;
+
+}  // namespace
+
+EventWatcher::EventWatcher(EventCallback onEvent, StatusCallback onStatus)
+    : onEvent(onEvent), onStatus(onStatus), stopping(false), connected(false), cliPid(0) {}
+
+EventWatcher::~EventWatcher() {
+    Stop();
+}
+
+void EventWatcher::Start() {
+    if (thread.joinable()) return;
+    stopping = false;
+    thread = std::thread(&EventWatcher::Run, this);
+}
+
+void EventWatcher::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(waitMutex);
+        stopping = true;
+    }
+    waitCond.notify_all();
+    int pid = cliPid.load();
+    if (pid > 0) kill(pid, SIGTERM);
+    if (thread.joinable()) thread.join();
+}
+
+void EventWatcher::Run() {
+    while (!stopping) {
+        bool followed = DockerApiClient::Instance().IsEnabled() && FollowApi();
+        if (!followed && !stopping) FollowCli();
+
+        if (connected.exchange(false) && onStatus) onStatus(false);
+
+        std::unique_lock<std::mutex> lock(waitMutex);
+        waitCond.wait_for(lock, std::chrono::milliseconds(kReconnectDelayMs),
+                          [this] { return stopping.load(); });
+    }
+}
+
+bool EventWatcher::Consume(std::string& pending, const char* data, size_t size) {
+    pending.append(data, size);
+
+    size_t start = 0;
+    for (;;) {
+        size_t nl = pending.find('\n', start);
+        if (nl == std::string::npos) break;
+        DockerEvent event;
+        if (nl > start && ParseEvent(pending.data() + start, nl - start, event) && onEvent) {
+            onEvent(event);
+        }
+        start = nl + 1;
+    }
+    pending.erase(0, start);
+    return !stopping;
+}
+
+bool EventWatcher::FollowApi() {
+    std::string pending;
+    int status = 0;
+    auto onData = [this, &pending, &status](const char* data, size_t size) {
+        if (stopping) return false;
+        // Stream() sets the status as soon as it arrives; idle ticks before
+        // that, or while an error body drains, do not mean connected.
+        if (status != 200) return true;
+        bool first = !connected.exchange(true);
+        if ((first || !data) && onStatus) onStatus(true);
+        if (!data) return !stopping;
+        return Consume(pending, data, size);
+    };
+
+    bool reached = DockerApiClient::Instance().Stream(
+        "GET", "/events?filters=" + DockerApiClient::UrlEncode(kEventFilter), onData, &status);
+    return reached && status == 200;
+}
+
+bool EventWatcher::FollowCli() {
+    ChildProcess child;
+    if (!child.Start({DockerCommands::FindDockerBinary(), "events", "--format", "{{json .}}",
+                      "--filter", "type=container", "--filter", "type=image",
+                      "--filter", "type=volume"},
+                     false)) {
+        return false;
+    }
+    cliPid = child.Pid();
+
+    int fd = child.StdoutFd();
+    std::string pending;
+    char buffer[16 * 1024];
+
+    if (!stopping) {
+        connected = true;
+        if (onStatus) onStatus(true);
+    }
+
+    while (!stopping) {
+        pollfd pfd = {fd, POLLIN, 0};
+        int ready = poll(&pfd, 1, 1000);
+        if (ready < 0 && errno == EINTR) continue;
+        if (ready < 0) break;
+        if (ready == 0) {
+            if (connected && onStatus) onStatus(true);
+            continue;
+        }
+
+        ssize_t n = read(fd, buffer, sizeof(buffer));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        Consume(pending, buffer, n);
+    }
+
+    cliPid = 0;
+    child.Signal(SIGTERM);
+    child.Wait();
+    return true;
+}
+
+bool EventWatcher::ParseEvent(const char* data, size_t size, DockerEvent& event) {
+    JsonReader json(data, size);
+    if (!json.BeginObject()) return false;
+
+    std::string key;
+    std::string legacyStatus;
+    std::string legacyId;
+    while (json.NextKey(key)) {
+        if (key == "Type") {
+            json.ReadString(event.type);
+        } else if (key == "Action") {
+            json.ReadString(event.action);
+        } else if (key == "status") {
+            json.ReadScalarAsString(legacyStatus);
+        } else if (key == "id") {
+            json.ReadScalarAsString(legacyId);
+        } else if (key == "timeNano") {
+            json.ReadInt64(event.timeNano);
+        } else if (key == "Actor" && json.Peek() == JsonReader::Type::Object) {
+            json.BeginObject();
+            while (json.NextKey(key)) {
+                if (key == "ID") {
+                    json.ReadString(event.id);
+                } else if (key == "Attributes" && json.Peek() == JsonReader::Type::Object) {
+                    json.BeginObject();
+                    while (json.NextKey(key)) {
+                        if (key == "name") {
+                            json.ReadScalarAsString(event.name);
+                        } else {
+                            json.Skip();
+                        }
+                    }
+                } else {
+                    json.Skip();
+                }
+            }
+        } else {
+            json.Skip();
+        }
+    }
+    if (json.Failed()) return false;
+
+    if (event.action.empty()) event.action = legacyStatus;
+    if (event.id.empty()) event.id = legacyId;
+    if (event.type.empty()) event.type = "container";
+
+    // "health_status: healthy", "exec_start: sh" -> keep only the verb.
+    size_t colon = event.action.find(':');
+    if (colon != std::string::npos) event.action.resize(colon);
+    return !event.id.empty();
+}
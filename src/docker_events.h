@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+struct DockerEvent {
+    std::string type;    // "container", "image", "volume"
+    std::string action;  // "start", "die", "destroy", "untag", ...
+    std::string id;      // Actor.ID
+    std::string name;    // Actor.Attributes.name, when present
+    int64_t timeNano = 0;
+};
+
+// Follows the daemon's event stream on a background thread, over the Engine
+// API socket when available and `docker events` otherwise. Reconnects on its
+// own; every (re)connect is reported so the consumer can resync.
+class EventWatcher {
+public:
+    typedef std::function<void(const DockerEvent&)> EventCallback;
+    // Called on the watcher thread once the stream is up and, with no
+    // event, about once a second while it stays quiet.
+    typedef std::function<void(bool connected)> StatusCallback;
+
+    EventWatcher(EventCallback onEvent, StatusCallback onStatus);
+    ~EventWatcher();
+
+    void Start();
+    void Stop();
+    bool IsConnected() const { return connected; }
+
+    static bool ParseEvent(const char* data, size_t size, DockerEvent& event);
+
+private:
+    EventCallback onEvent;
+    StatusCallback onStatus;
+    std::thread thread;
+    std::atomic<bool> stopping;
+    std::atomic<bool> connected;
+    std::atomic<int> cliPid;
+    std::mutex waitMutex;
+    std::condition_variable waitCond;
+
+    void Run();
+    bool FollowApi();
+    bool FollowCli();
+    // Splits the byte stream into newline-delimited JSON events.
+    bool Consume(std::string& pending, const char* data, size_t size);
+};
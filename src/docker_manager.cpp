@@ -1,77 +1,388 @@
 #include "docker_manager.h"
-#include <wx/thread.h>
-#include <future>
+#include "byte_size.h"
+#include "docker_api.h"
+#include "log_viewer.h"
+#include "prune_dialog.h"
+#include "stats_collector.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <memory>
+#include <unordered_set>
 
 wxDEFINE_EVENT(wxEVT_UPDATE_COMPLETE, wxThreadEvent);
 
+namespace {
+
+// A refresh issues at most four fetches at once; the spare threads keep
+// user actions from waiting behind them.
+const size_t kWorkerThreads = 6;
+
+// Per resource: first interval, and the ceiling it backs off to while
+// successive fetches return the same data.
+struct RefreshPolicy {
+    RefreshScheduler::Resource resource;
+    int baseMs;
+    int maxMs;
+};
+
+const RefreshPolicy kRefreshPolicies[] = {
+    {RefreshScheduler::Containers, 3000, 60000},
+    {RefreshScheduler::Images, 15000, 300000},
+    {RefreshScheduler::Volumes, 30000, 600000},
+    {RefreshScheduler::Stats, 3000, 30000},
+    {RefreshScheduler::VolumeSizes, 60000, 900000},
+};
+
+// Shortest one-shot timer; several resources falling due close together
+// share one wake-up.
+const int kMinTimerMs = 100;
+
+// How often background fetches are retried while requests to the daemon
+// are queued.
+const int kBusyRetryMs = 1000;
+
+// How often an unreachable daemon is probed again.
+const int kProbeRetryMs = 10000;
+
+// Static initialization runs before wxWidgets does, so first-paint timing
+// includes toolkit startup.
+const std::chrono::steady_clock::time_point kProcessStart = std::chrono::steady_clock::now();
+
+struct DaemonProbe {
+    bool available;
+    std::string error;
+};
+
+struct LayerReport {
+    bool changed;  // usage below is only filled in if so
+    std::unordered_map<std::string, LayerUsage> usage;
+    int64_t diskBytes;
+};
+
+struct DiskUsageRead {
+    bool ok;
+    DiskUsage usage;
+};
+
+struct VolumeScan {
+    bool available;  // the volume root is readable
+    std::unordered_map<std::string, int64_t> sizes;
+};
+
+struct ContainerInspection {
+    std::string id;
+    ContainerState state;  // when the request was made
+    bool ok;
+    ContainerDetails details;
+};
+
+wxString DecimalBytes(int64_t bytes) {
+    return wxString::FromUTF8(FormatDecimalBytes(static_cast<double>(bytes)).c_str());
+}
+
+// "2026-10-17T08:00:01.5Z" -> "2026-10-17 08:00:01 UTC"; the daemon's zero
+// time means the container never started.
+std::string DescribeStartTime(const std::string& startedAt) {
+    if (startedAt.size() < 19 || startedAt.compare(0, 4, "0001") == 0) return "never";
+    std::string text = startedAt.substr(0, 19);
+    text[10] = ' ';
+    return text + " UTC";
+}
+
+std::string DescribeContainer(const ContainerDetails& details) {
+    std::string text = details.name + "\n" + details.image + "\n\n";
+    text += "Started: " + DescribeStartTime(details.startedAt) + "\n";
+    text += "Restarts: " + std::to_string(details.restartCount) + " (policy: " +
+            (details.restartPolicy.empty() ? "no" : details.restartPolicy) + ")\n";
+    text += "Health: ";
+    if (details.health.empty()) {
+        text += "no health check";
+    } else {
+        text += details.health;
+        if (details.failingStreak > 0) {
+            text += ", " + std::to_string(details.failingStreak) + " failed checks in a row";
+        }
+    }
+    text += "\n";
+
+    std::vector<std::string> limits;
+    if (details.memoryLimit > 0) {
+        limits.push_back(FormatBinaryBytes(static_cast<double>(details.memoryLimit)) + " memory");
+    }
+    if (details.nanoCpus > 0) {
+        char cpus[32];
+        snprintf(cpus, sizeof(cpus), "%g CPUs", details.nanoCpus / 1e9);
+        limits.push_back(cpus);
+    }
+    if (details.cpuShares > 0) {
+        limits.push_back(std::to_string(details.cpuShares) + " CPU shares");
+    }
+    if (details.pidsLimit > 0) {
+        limits.push_back(std::to_string(details.pidsLimit) + " processes");
+    }
+    text += "Limits: ";
+    for (size_t i = 0; i < limits.size(); ++i) text += (i ? ", " : "") + limits[i];
+    text += limits.empty() ? "none\n" : "\n";
+
+    text += "\nPorts:\n";
+    for (const auto& port : details.ports) text += "  " + port + "\n";
+    if (details.ports.empty()) text += "  none\n";
+
+    text += "\nMounts:\n";
+    for (const auto& mount : details.mounts) {
+        text += "  " + mount.source + " -> " + mount.destination + " (" + mount.type +
+                (mount.readOnly ? ", read-only)\n" : ")\n");
+    }
+    if (details.mounts.empty()) text += "  none\n";
+
+    text += "\nEnvironment:\n";
+    for (const auto& variable : details.env) text += "  " + variable + "\n";
+    if (details.env.empty()) text += "  none\n";
+    return text;
+}
+
+unsigned Bit(RefreshScheduler::Resource resource) {
+    return 1u << resource;
+}
+
 struct UpdateData {
-    std::vector<ContainerInfo> allContainers;
-    std::vector<ImageInfo> allImages;
-    std::vector<VolumeInfo> allVolumes;
+    unsigned fetched;  // RefreshScheduler resource bits
+    ResourceSnapshot resources;
     SystemInfo systemInfo;
 };
 
-class UpdateThread : public wxThread {
-public:
-    UpdateThread(DockerManagerFrame* handler)
-        : wxThread(wxTHREAD_DETACHED), m_handler(handler) {}
+// Collects the parallel fetches of one refresh; whichever finishes last
+// hands the result to the frame.
+struct PendingUpdate {
+    DockerManagerFrame* handler;
+    UpdateData* data;
+    std::atomic<int> remaining;
 
-protected:
-    virtual ExitCode Entry() override {
-        UpdateData* data = new UpdateData();
+    // Only reached with data still set if the pool dropped a fetch.
+    ~PendingUpdate() { delete data; }
 
-        auto futAll     = std::async(std::launch::async, DockerCommands::GetAllContainers);
-        auto futImages  = std::async(std::launch::async, DockerCommands::GetAllImages);
-        auto futVolumes = std::async(std::launch::async, DockerCommands::GetAllVolumes);
-        auto futSystem  = std::async(std::launch::async, DockerCommands::GetSystemInfo);
+    void Done() {
+        if (--remaining > 0) return;
+        wxThreadEvent* event = new wxThreadEvent(wxEVT_THREAD, ID_UPDATE_COMPLETE);
+        event->SetPayload(data);
+        data = nullptr;
+        wxQueueEvent(handler, event);
+    }
+};
 
-        data->allContainers = futAll.get();
-        data->allImages     = futImages.get();
-        data->allVolumes    = futVolumes.get();
-        data->systemInfo    = futSystem.get();
+// Forwards step progress to the job and stops it once cancelled.
+DockerCommands::ProgressCallback ReportTo(JobContext& context) {
+    return [&context](int done, int total) {
+        context.SetProgress(done, total);
+        return !context.IsCancelled();
+    };
+}
 
-        wxThreadEvent* event = new wxThreadEvent(wxEVT_UPDATE_COMPLETE);
-        event->SetPayload(data);
-        wxQueueEvent(m_handler, event);
+// Applies one docker call to every target as a single job; the message
+// lists the objects that failed.
+JobQueue::JobFunction BulkJob(const std::vector<std::string>& targets,
+                              BulkExecutor::Operation operation, size_t concurrency) {
+    return [targets, operation, concurrency](JobContext& context) {
+        context.SetProgress(0, static_cast<int>(targets.size()));
+        BulkExecutor executor(concurrency);
+        std::string summary = BulkExecutor::Summarize(
+            executor.Run(targets, operation, ReportTo(context)));
+        if (!summary.empty()) context.SetMessage(summary);
+        return summary.empty();
+    };
+}
 
-        return (ExitCode)0;
+struct PruneStep {
+    std::vector<std::string> targets;
+    BulkExecutor::Operation operation;
+};
+
+// Removes a plan's objects in dependency order: containers first, so their
+// images and volumes are free, then images a round at a time, children
+// before parents, then volumes. Each step runs `concurrency` removals at once.
+JobQueue::JobFunction PruneJob(const PrunePlan& plan, bool extras, size_t concurrency) {
+    std::vector<PruneStep> steps;
+    steps.push_back({plan.Removed(PruneKind::Container),
+                     [](const std::string& id, std::string* error) {
+                         return DockerCommands::RemoveContainer(id, error);
+                     }});
+    for (const auto& round : plan.imageRounds) {
+        steps.push_back({round, [](const std::string& id, std::string* error) {
+                             return DockerCommands::RemoveImage(id, error, true);
+                         }});
     }
+    steps.push_back({plan.Removed(PruneKind::Volume),
+                     [](const std::string& name, std::string* error) {
+                         return DockerCommands::RemoveVolume(name, error);
+                     }});
+
+    return [steps, extras, concurrency](JobContext& context) {
+        int total = extras ? 1 : 0;
+        for (const auto& step : steps) total += static_cast<int>(step.targets.size());
+        context.SetProgress(0, total);
+
+        BulkExecutor executor(concurrency);
+        std::vector<BulkItemResult> results;
+        int done = 0;
+        for (const auto& step : steps) {
+            if (step.targets.empty()) continue;
+            if (context.IsCancelled()) break;
+            const int before = done;
+            std::vector<BulkItemResult> stepResults = executor.Run(
+                step.targets, step.operation, [&context, before, total](int stepDone, int) {
+                    context.SetProgress(before + stepDone, total);
+                    return !context.IsCancelled();
+                });
+            results.insert(results.end(), stepResults.begin(), stepResults.end());
+            done += static_cast<int>(step.targets.size());
+        }
 
-private:
-    DockerManagerFrame* m_handler;
+        std::string summary = BulkExecutor::Summarize(results);
+        if (extras && !context.IsCancelled()) {
+            std::string error;
+            if (!DockerCommands::PruneNetworksAndBuildCache(&error)) {
+                if (!summary.empty()) summary += "; ";
+                summary += "networks and build cache: " + error;
+            }
+            context.SetProgress(total, total);
+        }
+        if (!summary.empty()) context.SetMessage(summary);
+        return summary.empty() && !context.IsCancelled();
+    };
+}
+
+bool IsActive(const ContainerRow& c) {
+    return c.state == ContainerState::Running || c.state == ContainerState::Paused;
+}
+
+// Archive ranges offered by the history view.
+struct HistoryRange {
+    const char* label;
+    time_t seconds;
+};
+
+const HistoryRange kHistoryRanges[] = {
+    {"Last hour", 3600},
+    {"Last 24 hours", 24 * 3600},
+    {"Last 7 days", 7 * 24 * 3600},
 };
 
+// "Showing the session saved at 14:02 on Oct 16."
+wxString SavedSessionText(int64_t savedAt) {
+    time_t when = static_cast<time_t>(savedAt);
+    struct tm tm;
+    localtime_r(&when, &tm);
+    char buf[64];
+    strftime(buf, sizeof(buf), "%H:%M on %b %d", &tm);
+    return wxString::Format(wxT("Showing the session saved at %s."), wxString::FromUTF8(buf));
+}
+
+// "Stop container 'web'" for one object, "Stop 3 containers" for several.
+std::string JobTitle(const std::string& verb, const std::string& noun,
+                     const std::vector<std::string>& labels) {
+    if (labels.size() == 1) return verb + " " + noun + " " + labels.front();
+    return verb + " " + std::to_string(labels.size()) + " " + noun + "s";
+}
+
+}  // namespace
+
 wxBEGIN_EVENT_TABLE(DockerManagerFrame, wxFrame)
     EVT_BUTTON(ID_STOP, DockerManagerFrame::OnStop)
     EVT_BUTTON(ID_STOP_ALL, DockerManagerFrame::OnStopAll)
     EVT_BUTTON(ID_REMOVE_CONTAINER, DockerManagerFrame::OnRemoveContainer)
+    EVT_BUTTON(ID_SHOW_HISTORY, DockerManagerFrame::OnShowHistory)
+    EVT_BUTTON(ID_SHOW_LOGS, DockerManagerFrame::OnShowLogs)
     EVT_BUTTON(ID_REMOVE_IMAGE, DockerManagerFrame::OnRemoveImage)
     EVT_BUTTON(ID_REMOVE_VOLUME, DockerManagerFrame::OnRemoveVolume)
     EVT_BUTTON(ID_PRUNE_ALL, DockerManagerFrame::OnPruneAll)
     EVT_BUTTON(ID_REFRESH, DockerManagerFrame::OnRefresh)
     EVT_TIMER(ID_TIMER, DockerManagerFrame::OnTimer)
     EVT_CLOSE(DockerManagerFrame::OnClose)
+    EVT_ICONIZE(DockerManagerFrame::OnIconize)
+    EVT_NOTEBOOK_PAGE_CHANGED(wxID_ANY, DockerManagerFrame::OnPageChanged)
     EVT_LIST_ITEM_SELECTED(ID_RUNNING_LIST, DockerManagerFrame::OnRunningItemSelected)
     EVT_LIST_ITEM_SELECTED(ID_IMAGES_LIST,  DockerManagerFrame::OnImageItemSelected)
     EVT_LIST_ITEM_SELECTED(ID_VOLUMES_LIST, DockerManagerFrame::OnVolumeItemSelected)
     EVT_THREAD(ID_UPDATE_COMPLETE, DockerManagerFrame::OnUpdateComplete)
+    EVT_THREAD(ID_STATE_CHANGED, DockerManagerFrame::OnStateChanged)
+    EVT_BUTTON(ID_CANCEL_JOB, DockerManagerFrame::OnCancelJob)
+    EVT_BUTTON(ID_CLEAR_JOBS, DockerManagerFrame::OnClearJobs)
+    EVT_LIST_ITEM_SELECTED(ID_JOBS_LIST, DockerManagerFrame::OnJobItemSelected)
+    EVT_LIST_ITEM_DESELECTED(ID_RUNNING_LIST, DockerManagerFrame::OnRunningItemSelected)
+    EVT_LIST_ITEM_DESELECTED(ID_IMAGES_LIST,  DockerManagerFrame::OnImageItemSelected)
+    EVT_LIST_ITEM_DESELECTED(ID_VOLUMES_LIST, DockerManagerFrame::OnVolumeItemSelected)
+    EVT_LIST_ITEM_DESELECTED(ID_JOBS_LIST, DockerManagerFrame::OnJobItemSelected)
+    EVT_THREAD(ID_JOB_UPDATED, DockerManagerFrame::OnJobUpdated)
+    EVT_THREAD(ID_DAEMON_PROBED, DockerManagerFrame::OnDaemonProbed)
+    EVT_THREAD(ID_LAYERS_ANALYZED, DockerManagerFrame::OnLayersAnalyzed)
+    EVT_THREAD(ID_DISK_USAGE_READ, DockerManagerFrame::OnDiskUsageRead)
+    EVT_THREAD(ID_VOLUMES_SCANNED, DockerManagerFrame::OnVolumesScanned)
+    EVT_THREAD(ID_CONTAINER_INSPECTED, DockerManagerFrame::OnContainerInspected)
+    EVT_BUTTON(ID_RETRY_PROBE, DockerManagerFrame::OnRetryProbe)
+    EVT_TEXT(ID_CONTAINER_FILTER, DockerManagerFrame::OnFilterText)
+    EVT_TEXT(ID_IMAGE_FILTER, DockerManagerFrame::OnFilterText)
+    EVT_TEXT(ID_VOLUME_FILTER, DockerManagerFrame::OnFilterText)
 wxEND_EVENT_TABLE()
 
 DockerManagerFrame::DockerManagerFrame(const wxString& title)
     : wxFrame(NULL, wxID_ANY, title, wxDefaultPosition, wxSize(1000, 850)),
-      isUpdating(false) {
+      infoBar(nullptr), refreshTimer(nullptr), stateTracker(nullptr),
+      workers(new WorkerPool(kWorkerThreads)), jobs(nullptr), archive(nullptr),
+      layerAnalyzer(nullptr), volumeScanner(new VolumeScanner()),
+      bulkConcurrency(BulkExecutor::kDefaultConcurrency),
+      daemonReady(false), probing(false), probeFailed(false), stale(false), staleSavedAt(0),
+      analyzingLayers(false), layersDirty(false), layerDiskBytes(0), layerListedBytes(0),
+      scanningVolumes(false), volumesDirty(false), inspecting(false) {
+
+    if (const char* env = getenv("DOCKER_MANAGER_CONCURRENCY")) {
+        int n = atoi(env);
+        if (n > 0) bulkConcurrency = static_cast<size_t>(n);
+    }
+    // Otherwise the daemon gate, sized for the default, caps every bulk run.
+    if (bulkConcurrency != BulkExecutor::kDefaultConcurrency) {
+        DockerCommands::SetMaxConcurrentCalls(bulkConcurrency + DockerCommands::kCallHeadroom);
+        BulkExecutor::SetMaxConcurrency(bulkConcurrency);
+    }
+    layerAnalyzer = new LayerAnalyzer(DockerCommands::GetImageLayers, bulkConcurrency);
+    if (const char* env = getenv("DOCKER_MANAGER_VOLUME_ROOT")) {
+        if (*env) volumeScanner->SetRoot(env);
+    }
+
+    archive = new MetricsArchive(MetricsArchive::DefaultDirectory());
+    std::string archiveError;
+    if (archive->Open(&archiveError)) {
+        StatsCollector::Instance().SetArchive(archive);
+    } else {
+        fprintf(stderr, "docker_manager: metrics archive disabled: %s\n", archiveError.c_str());
+        delete archive;
+        archive = nullptr;
+    }
+
+    jobs = new JobQueue(*workers, [this](const JobStatus& status) {
+        wxThreadEvent* event = new wxThreadEvent(wxEVT_THREAD, ID_JOB_UPDATED);
+        event->SetPayload(new JobStatus(status));
+        wxQueueEvent(this, event);
+    });
 
     wxPanel* mainPanel = new wxPanel(this);
     wxBoxSizer* mainSizer = new wxBoxSizer(wxVERTICAL);
 
+    infoBar = new wxInfoBar(mainPanel);
+    mainSizer->Add(infoBar, 0, wxEXPAND);
+
     CreateSystemInfoPanel(mainPanel, mainSizer);
 
     notebook = new wxNotebook(mainPanel, wxID_ANY);
     CreateRunningPanel();
     CreateCleanupPanel();
+    CreateJobsPanel();
 
     notebook->AddPage(runningPanel, wxT("All containers"), true);
     notebook->AddPage(cleanupPanel, wxT("Images & Volumes"));
+    notebook->AddPage(jobsPanel, wxT("Jobs"));
 
     mainSizer->Add(notebook, 1, wxEXPAND | wxALL, 5);
 
@@ -81,28 +392,28 @@ DockerManagerFrame::DockerManagerFrame(const wxString& title)
     mainPanel->SetSizer(mainSizer);
 
     refreshTimer = new wxTimer(this, ID_TIMER);
-    refreshTimer->Start(3000);
+    for (const auto& policy : kRefreshPolicies) {
+        scheduler.SetIntervals(policy.resource, policy.baseMs, policy.maxMs);
+    }
+    lastSystemInfo.cpu_usage = -1.0;
+    lastSystemInfo.mem_bytes = -1;
+    lastSystemInfo.container_count = -1;
 
     Centre();
 
-    if (!DockerCommands::IsDockerAvailable()) {
-        std::string errDetails = DockerCommands::GetDockerError();
-        wxString msg =
-            wxT("Docker is not accessible. The container list will be empty.\n\n")
-            wxT("Common causes:\n")
-            wxT("  - Docker daemon is not running.\n")
-            wxT("    Fix: sudo systemctl start docker\n\n")
-            wxT("  - Current user is not in the 'docker' group.\n")
-            wxT("    Fix: sudo usermod -aG docker $USER\n")
-            wxT("    Then log out and log back in.\n\n")
-            wxT("  - Docker is not installed.");
-        if (!errDetails.empty()) {
-            msg += wxT("\n\nDetails:\n") + wxString::FromUTF8(errDetails.c_str());
-        }
-        wxMessageBox(msg, wxT("Docker Unavailable"), wxOK | wxICON_WARNING, this);
-    }
+    // Nothing below talks to the daemon: the window shows the last session
+    // straight away and the daemon is probed on a worker.
+    LoadLastSession();
+    mainPanel->Bind(wxEVT_PAINT, &DockerManagerFrame::OnFirstPaint, this);
+
+    stateTracker = new DockerStateTracker([this](const ResourceSnapshot& snapshot) {
+        wxThreadEvent* event = new wxThreadEvent(wxEVT_THREAD, ID_STATE_CHANGED);
+        event->SetPayload(new ResourceSnapshot(snapshot));
+        wxQueueEvent(this, event);
+    });
 
-    RefreshAllAsync();
+    UpdateVisibility();
+    ProbeDaemonAsync();
 }
 
 DockerManagerFrame::~DockerManagerFrame() {
@@ -110,6 +421,12 @@ DockerManagerFrame::~DockerManagerFrame() {
         refreshTimer->Stop();
         delete refreshTimer;
     }
+    delete workers;
+    delete jobs;
+    delete stateTracker;
+    delete archive;
+    delete layerAnalyzer;
+    delete volumeScanner;
 }
 
 
@@ -120,6 +437,7 @@ void DockerManagerFrame::CreateSystemInfoPanel(wxPanel* parent, wxSizer* sizer)
     cpuLabel = new wxStaticText(parent, wxID_ANY, wxT("CPU: 0%"));
     memLabel = new wxStaticText(parent, wxID_ANY, wxT("Memory: 0"));
     containersLabel = new wxStaticText(parent, wxID_ANY, wxT("Containers: 0"));
+    daemonLabel = new wxStaticText(parent, wxID_ANY, wxEmptyString);
 
     wxFont boldFont = cpuLabel->GetFont();
     boldFont.SetWeight(wxFONTWEIGHT_BOLD);
@@ -130,6 +448,7 @@ void DockerManagerFrame::CreateSystemInfoPanel(wxPanel* parent, wxSizer* sizer)
     infoBox->Add(cpuLabel, 1, wxALL | wxALIGN_CENTER_VERTICAL, 5);
     infoBox->Add(memLabel, 1, wxALL | wxALIGN_CENTER_VERTICAL, 5);
     infoBox->Add(containersLabel, 1, wxALL | wxALIGN_CENTER_VERTICAL, 5);
+    infoBox->Add(daemonLabel, 1, wxALL | wxALIGN_CENTER_VERTICAL, 5);
 
     sizer->Add(infoBox, 0, wxEXPAND | wxALL, 5);
 }
@@ -138,16 +457,20 @@ void DockerManagerFrame::CreateRunningPanel() {
     runningPanel = new wxPanel(notebook);
     wxBoxSizer* sizer = new wxBoxSizer(wxVERTICAL);
 
-    runningList = new wxListCtrl(runningPanel, ID_RUNNING_LIST,
-                                  wxDefaultPosition, wxDefaultSize,
-                                  wxLC_REPORT | wxLC_SINGLE_SEL);
-    runningList->AppendColumn(wxT("ID"),     wxLIST_FORMAT_LEFT, 100);
-    runningList->AppendColumn(wxT("Name"),   wxLIST_FORMAT_LEFT, 200);
-    runningList->AppendColumn(wxT("State"),  wxLIST_FORMAT_LEFT, 80);
-    runningList->AppendColumn(wxT("Status"), wxLIST_FORMAT_LEFT, 220);
-    runningList->AppendColumn(wxT("Image"),  wxLIST_FORMAT_LEFT, 300);
+    containerFilter = new wxSearchCtrl(runningPanel, ID_CONTAINER_FILTER);
+    containerFilter->SetDescriptiveText(wxT("Filter containers"));
+    sizer->Add(containerFilter, 0, wxEXPAND | wxLEFT | wxRIGHT | wxTOP, 5);
 
-    sizer->Add(runningList, 1, wxEXPAND | wxALL, 5);
+    runningList = new ContainerListCtrl(runningPanel, ID_RUNNING_LIST);
+
+    // Inspect output for the selected container, fetched when selected.
+    detailsText = new wxTextCtrl(runningPanel, wxID_ANY, wxEmptyString, wxDefaultPosition,
+                                 wxSize(300, -1),
+                                 wxTE_MULTILINE | wxTE_READONLY | wxTE_DONTWRAP);
+    wxBoxSizer* listSizer = new wxBoxSizer(wxHORIZONTAL);
+    listSizer->Add(runningList, 1, wxEXPAND | wxRIGHT, 5);
+    listSizer->Add(detailsText, 0, wxEXPAND);
+    sizer->Add(listSizer, 1, wxEXPAND | wxALL, 5);
 
     wxBoxSizer* buttonSizer = new wxBoxSizer(wxHORIZONTAL);
 
@@ -160,6 +483,14 @@ void DockerManagerFrame::CreateRunningPanel() {
     removeContainerButton->Enable(false);
     buttonSizer->Add(removeContainerButton, 0, wxALL, 5);
 
+    historyButton = new wxButton(runningPanel, ID_SHOW_HISTORY, wxT("History..."));
+    historyButton->Enable(false);
+    buttonSizer->Add(historyButton, 0, wxALL, 5);
+
+    logsButton = new wxButton(runningPanel, ID_SHOW_LOGS, wxT("Logs..."));
+    logsButton->Enable(false);
+    buttonSizer->Add(logsButton, 0, wxALL, 5);
+
     stopAllButton = new wxButton(runningPanel, ID_STOP_ALL, wxT("Stop ALL running"));
     stopAllButton->SetBackgroundColour(wxColour(255, 165, 0));
     buttonSizer->Add(stopAllButton, 0, wxALL, 5);
@@ -174,16 +505,17 @@ void DockerManagerFrame::CreateCleanupPanel() {
 
     wxStaticBoxSizer* imagesBox = new wxStaticBoxSizer(wxVERTICAL, cleanupPanel,
                                                         wxT("All images"));
-    imagesList = new wxListCtrl(cleanupPanel, ID_IMAGES_LIST,
-                                 wxDefaultPosition, wxDefaultSize,
-                                 wxLC_REPORT | wxLC_SINGLE_SEL);
-    imagesList->AppendColumn(wxT("ID"),         wxLIST_FORMAT_LEFT, 120);
-    imagesList->AppendColumn(wxT("Repository"), wxLIST_FORMAT_LEFT, 280);
-    imagesList->AppendColumn(wxT("Tag"),        wxLIST_FORMAT_LEFT, 120);
-    imagesList->AppendColumn(wxT("Size"),       wxLIST_FORMAT_LEFT, 100);
+    imageFilter = new wxSearchCtrl(cleanupPanel, ID_IMAGE_FILTER);
+    imageFilter->SetDescriptiveText(wxT("Filter images"));
+    imagesBox->Add(imageFilter, 0, wxEXPAND | wxLEFT | wxRIGHT | wxTOP, 5);
+
+    imagesList = new ImageListCtrl(cleanupPanel, ID_IMAGES_LIST);
 
     imagesBox->Add(imagesList, 1, wxEXPAND | wxALL, 5);
 
+    imageUsageLabel = new wxStaticText(cleanupPanel, wxID_ANY, wxEmptyString);
+    imagesBox->Add(imageUsageLabel, 0, wxEXPAND | wxLEFT | wxRIGHT, 5);
+
     removeImageButton = new wxButton(cleanupPanel, ID_REMOVE_IMAGE,
                                       wxT("Remove image"));
     removeImageButton->Enable(false);
@@ -192,11 +524,11 @@ void DockerManagerFrame::CreateCleanupPanel() {
 
     wxStaticBoxSizer* volumesBox = new wxStaticBoxSizer(wxVERTICAL, cleanupPanel,
                                                          wxT("All volumes"));
-    volumesList = new wxListCtrl(cleanupPanel, ID_VOLUMES_LIST,
-                                  wxDefaultPosition, wxSize(-1, 110),
-                                  wxLC_REPORT | wxLC_SINGLE_SEL);
-    volumesList->AppendColumn(wxT("Name"),   wxLIST_FORMAT_LEFT, 450);
-    volumesList->AppendColumn(wxT("Driver"), wxLIST_FORMAT_LEFT, 150);
+    volumeFilter = new wxSearchCtrl(cleanupPanel, ID_VOLUME_FILTER);
+    volumeFilter->SetDescriptiveText(wxT("Filter volumes"));
+    volumesBox->Add(volumeFilter, 0, wxEXPAND | wxLEFT | wxRIGHT | wxTOP, 5);
+
+    volumesList = new VolumeListCtrl(cleanupPanel, ID_VOLUMES_LIST, wxSize(-1, 110));
 
     volumesBox->Add(volumesList, 0, wxEXPAND | wxALL, 5);
 
@@ -207,7 +539,7 @@ void DockerManagerFrame::CreateCleanupPanel() {
     mainSizer->Add(volumesBox, 0, wxEXPAND | wxALL, 5);
 
     pruneAllButton = new wxButton(cleanupPanel, ID_PRUNE_ALL,
-                                   wxT("PRUNE ALL (Docker Prune)"));
+                                   wxT("Prune unused..."));
     pruneAllButton->SetBackgroundColour(*wxRED);
     pruneAllButton->SetForegroundColour(*wxWHITE);
     mainSizer->Add(pruneAllButton, 0, wxALIGN_CENTER | wxALL, 5);
@@ -215,132 +547,405 @@ void DockerManagerFrame::CreateCleanupPanel() {
     cleanupPanel->SetSizer(mainSizer);
 }
 
-void DockerManagerFrame::RefreshAllAsync() {
-    if (isUpdating) {
+void DockerManagerFrame::CreateJobsPanel() {
+    jobsPanel = new wxPanel(notebook);
+    wxBoxSizer* sizer = new wxBoxSizer(wxVERTICAL);
+
+    jobsList = new JobListCtrl(jobsPanel, ID_JOBS_LIST);
+    sizer->Add(jobsList, 1, wxEXPAND | wxALL, 5);
+
+    wxBoxSizer* buttonSizer = new wxBoxSizer(wxHORIZONTAL);
+
+    cancelJobButton = new wxButton(jobsPanel, ID_CANCEL_JOB, wxT("Cancel job"));
+    cancelJobButton->Enable(false);
+    buttonSizer->Add(cancelJobButton, 0, wxALL, 5);
+
+    clearJobsButton = new wxButton(jobsPanel, ID_CLEAR_JOBS, wxT("Clear finished"));
+    buttonSizer->Add(clearJobsButton, 0, wxALL, 5);
+
+    sizer->Add(buttonSizer, 0, wxALIGN_CENTER | wxALL, 5);
+    jobsPanel->SetSizer(sizer);
+}
+
+void DockerManagerFrame::RefreshAsync(unsigned resources) {
+    if (resources == 0) return;
+
+    auto pending = std::make_shared<PendingUpdate>();
+    pending->handler = this;
+    pending->data = new UpdateData();
+    pending->data->fetched = resources;
+    pending->remaining = __builtin_popcount(resources);
+
+    UpdateData* data = pending->data;
+    if (resources & Bit(RefreshScheduler::Stats)) {
+        workers->Submit([pending, data] {
+            data->systemInfo = DockerCommands::GetSystemInfo();
+            pending->Done();
+        }, WorkerPool::Background);
+    }
+    if (resources & Bit(RefreshScheduler::Containers)) {
+        workers->Submit([pending, data] {
+            // A failed fetch leaves a null table; the list keeps what it shows.
+            std::vector<ContainerInfo> containers;
+            data->resources.containers = DockerCommands::GetAllContainers(containers)
+                ? ContainerTable::Build(containers) : nullptr;
+            pending->Done();
+        }, WorkerPool::Background);
+    }
+    if (resources & Bit(RefreshScheduler::Images)) {
+        workers->Submit([pending, data] {
+            std::vector<ImageInfo> images;
+            data->resources.images = DockerCommands::GetAllImages(images)
+                ? ImageTable::Build(images) : nullptr;
+            pending->Done();
+        }, WorkerPool::Background);
+    }
+    if (resources & Bit(RefreshScheduler::Volumes)) {
+        workers->Submit([pending, data] {
+            std::vector<VolumeInfo> volumes;
+            data->resources.volumes = DockerCommands::GetAllVolumes(volumes)
+                ? VolumeTable::Build(volumes) : nullptr;
+            pending->Done();
+        }, WorkerPool::Background);
+    }
+}
+
+void DockerManagerFrame::RunScheduler() {
+    if (!daemonReady) {
+        ProbeDaemonAsync();
         return;
     }
 
-    isUpdating = true;
-    UpdateThread* updateThread = new UpdateThread(this);
+    // With a live event stream the lists are kept current by the state
+    // tracker and only the stats are fetched. When the stream drops, the
+    // lists are unpaused and polled straight away.
+    bool live = stateTracker && stateTracker->IsLive();
+    scheduler.SetPaused(RefreshScheduler::Containers, live);
+    scheduler.SetPaused(RefreshScheduler::Images, live);
+    scheduler.SetPaused(RefreshScheduler::Volumes, live);
+
+    // Requests already queued for the daemon mean it is not keeping up;
+    // background fetches would only make user actions wait longer.
+    DaemonCallStats calls = DockerCommands::GetCallStats();
+    UpdateDaemonLoad(calls);
+    if (calls.waiting > 0) {
+        refreshTimer->Start(kBusyRetryMs, wxTIMER_ONE_SHOT);
+        return;
+    }
+
+    unsigned due = scheduler.TakeDue();
+    if (due & Bit(RefreshScheduler::VolumeSizes)) ScanVolumesAsync();
+    RefreshAsync(due & ~Bit(RefreshScheduler::VolumeSizes));
+    ScheduleNextRefresh();
+}
+
+void DockerManagerFrame::RefreshSoon() {
+    scheduler.Boost();
+    RunScheduler();
+}
 
-    if (updateThread->Create() != wxTHREAD_NO_ERROR) {
-        delete updateThread;
-        isUpdating = false;
+void DockerManagerFrame::ScheduleNextRefresh() {
+    // Nothing due (minimized, or every fetch in flight): stay asleep until
+    // a completion or a window event reschedules.
+    int ms = scheduler.MillisUntilNext();
+    if (ms < 0) {
+        refreshTimer->Stop();
+        return;
+    }
+    refreshTimer->Start(std::max(ms, kMinTimerMs), wxTIMER_ONE_SHOT);
+}
+
+void DockerManagerFrame::UpdateVisibility() {
+    wxWindow* page = notebook->GetCurrentPage();
+    scheduler.SetVisible(RefreshScheduler::Containers, page == runningPanel);
+    scheduler.SetVisible(RefreshScheduler::Images, page == cleanupPanel);
+    scheduler.SetVisible(RefreshScheduler::Volumes, page == cleanupPanel);
+    scheduler.SetVisible(RefreshScheduler::VolumeSizes, page == cleanupPanel);
+}
+
+void DockerManagerFrame::ProbeDaemonAsync() {
+    if (probing) return;
+    probing = true;
+    workers->Submit([this] {
+        DaemonProbe* probe = new DaemonProbe();
+        probe->available = DockerCommands::IsDockerAvailable();
+        if (!probe->available) probe->error = DockerCommands::GetDockerError();
+
+        wxThreadEvent* event = new wxThreadEvent(wxEVT_THREAD, ID_DAEMON_PROBED);
+        event->SetPayload(probe);
+        wxQueueEvent(this, event);
+    }, WorkerPool::Interactive);
+}
+
+void DockerManagerFrame::OnDaemonProbed(wxThreadEvent& event) {
+    DaemonProbe* probe = event.GetPayload<DaemonProbe*>();
+    probing = false;
+    if (!probe) return;
+
+    if (probe->available) {
+        if (probeFailed) infoBar->RemoveButton(ID_RETRY_PROBE);
+        probeFailed = false;
+        // A stale session keeps its banner until fresh lists replace it.
+        if (!stale) infoBar->Dismiss();
+        if (!daemonReady) {
+            daemonReady = true;
+            stateTracker->Start();
+            // The saved session's images are listed but not analyzed yet.
+            AnalyzeLayersAsync();
+        }
+        RunScheduler();
+        delete probe;
         return;
     }
 
-    if (updateThread->Run() != wxTHREAD_NO_ERROR) {
-        isUpdating = false;
+    wxString msg = wxT("Docker is not accessible");
+    if (!probe->error.empty()) {
+        std::string detail = probe->error.substr(0, probe->error.find('\n'));
+        msg += wxT(": ") + wxString::FromUTF8(detail.c_str());
     }
+    msg += wxT("\nStart the daemon (sudo systemctl start docker) or add your user to the ")
+           wxT("'docker' group (sudo usermod -aG docker $USER, then log in again).");
+    if (stale) msg += wxT("\n") + SavedSessionText(staleSavedAt);
+    if (!probeFailed) infoBar->AddButton(ID_RETRY_PROBE, wxT("Retry"));
+    probeFailed = true;
+    infoBar->ShowMessage(msg, wxICON_WARNING);
+
+    refreshTimer->Start(kProbeRetryMs, wxTIMER_ONE_SHOT);
+    delete probe;
 }
 
-void DockerManagerFrame::OnUpdateComplete(wxThreadEvent& event) {
-    UpdateData* data = event.GetPayload<UpdateData*>();
+void DockerManagerFrame::OnRetryProbe(wxCommandEvent& event) {
+    infoBar->ShowMessage(wxT("Connecting to Docker..."), wxICON_INFORMATION);
+    ProbeDaemonAsync();
+}
 
-    if (data) {
-        PopulateAllContainers(data->allContainers);
-        PopulateAllImages(data->allImages);
-        PopulateAllVolumes(data->allVolumes);
-        UpdateSystemInfoUI(data->systemInfo);
+void DockerManagerFrame::LoadLastSession() {
+    SessionSnapshot snapshot;
+    if (!SessionStore::Load(SessionStore::DefaultPath(), snapshot)) {
+        infoBar->ShowMessage(wxT("Connecting to Docker..."), wxICON_INFORMATION);
+        return;
+    }
 
-        delete data;
+    PopulateAllContainers(snapshot.resources.containers);
+    PopulateAllImages(snapshot.resources.images);
+    PopulateAllVolumes(snapshot.resources.volumes);
+    UpdateSystemInfoUI(snapshot.system);
+    staleSavedAt = snapshot.savedAt;
+    SetStale(true);
+    infoBar->ShowMessage(SavedSessionText(staleSavedAt) + wxT(" Connecting to Docker..."),
+                         wxICON_INFORMATION);
+}
+
+void DockerManagerFrame::SaveSession() {
+    // Never replace a session with the stale copy of itself.
+    if (stale) return;
+
+    SessionSnapshot snapshot;
+    snapshot.savedAt = static_cast<int64_t>(time(nullptr));
+    snapshot.resources = shown;
+    snapshot.system = lastSystemInfo;
+    std::string error;
+    if (!SessionStore::Save(SessionStore::DefaultPath(), snapshot, &error)) {
+        fprintf(stderr, "docker_manager: could not save session: %s\n", error.c_str());
     }
+}
 
-    isUpdating = false;
+void DockerManagerFrame::SetStale(bool value) {
+    stale = value;
+    wxColour colour = wxSystemSettings::GetColour(value ? wxSYS_COLOUR_GRAYTEXT
+                                                        : wxSYS_COLOUR_LISTBOXTEXT);
+    wxListCtrl* lists[] = {runningList, imagesList, volumesList};
+    for (wxListCtrl* list : lists) {
+        list->SetTextColour(colour);
+        list->Refresh();
+    }
 }
 
-void DockerManagerFrame::PopulateAllContainers(
-    const std::vector<ContainerInfo>& containers) {
-    runningList->DeleteAllItems();
+void DockerManagerFrame::MarkFresh() {
+    if (!stale) return;
+    SetStale(false);
+    if (!probeFailed) infoBar->Dismiss();
+}
 
-    int row = 0;
-    for (const auto& c : containers) {
-        long index = runningList->InsertItem(row, wxString::FromUTF8(c.id.c_str()));
-        runningList->SetItem(index, 1, wxString::FromUTF8(c.name.c_str()));
-        runningList->SetItem(index, 2, wxString::FromUTF8(c.state.c_str()));
-        runningList->SetItem(index, 3, wxString::FromUTF8(c.status.c_str()));
-        runningList->SetItem(index, 4, wxString::FromUTF8(c.image.c_str()));
+void DockerManagerFrame::OnFirstPaint(wxPaintEvent& event) {
+    event.Skip();
+    wxWindow* window = static_cast<wxWindow*>(event.GetEventObject());
+    window->Unbind(wxEVT_PAINT, &DockerManagerFrame::OnFirstPaint, this);
 
-        if (c.state == "running") {
-            runningList->SetItemBackgroundColour(index, wxColour(200, 255, 200));  // green
-        } else if (c.state == "paused") {
-            runningList->SetItemBackgroundColour(index, wxColour(255, 255, 180));  // yellow
-        } else {
-            runningList->SetItemBackgroundColour(index, wxColour(255, 210, 210));  // red
+    if (getenv("DOCKER_MANAGER_TRACE_STARTUP")) {
+        double ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - kProcessStart).count();
+        fprintf(stderr, "docker_manager: first paint %.1f ms after start\n", ms);
+    }
+}
+
+void DockerManagerFrame::OnJobUpdated(wxThreadEvent& event) {
+    JobStatus* status = event.GetPayload<JobStatus*>();
+    if (!status) return;
+
+    PopulateJobs();
+
+    if (status->IsFinished() && status->state != JobStatus::Cancelled) {
+        RefreshSoon();
+    }
+    if (status->state == JobStatus::Failed) {
+        wxString msg = wxString::FromUTF8(status->title.c_str()) + wxT(" failed");
+        if (!status->message.empty()) {
+            msg += wxT(":\n") + wxString::FromUTF8(status->message.c_str());
         }
+        wxMessageBox(msg, wxT("Error"), wxOK | wxICON_ERROR);
+    }
+    delete status;
+}
+
+void DockerManagerFrame::PopulateJobs() {
+    std::vector<JobRow> rows;
+    for (const auto& status : jobs->GetJobs()) rows.push_back(JobRow::FromStatus(status));
+    jobsList->SetRows(rows);
+    UpdateJobButtons();
+}
 
-        row++;
+void DockerManagerFrame::UpdateJobButtons() {
+    bool cancellable = false;
+    for (const JobRow* row : jobsList->GetSelectedRows()) {
+        cancellable = cancellable || row->state == "queued" || row->state == "running";
     }
+    cancelJobButton->Enable(cancellable);
+}
 
-    stopButton->Enable(false);
-    removeContainerButton->Enable(false);
+void DockerManagerFrame::OnCancelJob(wxCommandEvent& event) {
+    std::vector<uint64_t> ids;
+    for (const JobRow* row : jobsList->GetSelectedRows()) ids.push_back(row->id);
+    for (uint64_t id : ids) jobs->Cancel(id);
+}
+
+void DockerManagerFrame::OnClearJobs(wxCommandEvent& event) {
+    jobs->ClearFinished();
+    PopulateJobs();
 }
 
-void DockerManagerFrame::PopulateAllImages(
-    const std::vector<ImageInfo>& images) {
-    imagesList->DeleteAllItems();
+void DockerManagerFrame::OnJobItemSelected(wxListEvent& event) {
+    UpdateJobButtons();
+}
 
-    int row = 0;
-    for (const auto& image : images) {
-        long index = imagesList->InsertItem(row,
-                                             wxString::FromUTF8(image.id.c_str()));
-        imagesList->SetItem(index, 1, wxString::FromUTF8(image.repository.c_str()));
-        imagesList->SetItem(index, 2, wxString::FromUTF8(image.tag.c_str()));
-        imagesList->SetItem(index, 3, wxString::FromUTF8(image.size.c_str()));
-        row++;
+void DockerManagerFrame::OnUpdateComplete(wxThreadEvent& event) {
+    UpdateData* data = event.GetPayload<UpdateData*>();
+
+    if (data) {
+        // Identical results stretch that resource's interval, and so do
+        // failed fetches, which leave the lists as they are.
+        const ResourceSnapshot& fetched = data->resources;
+        if (data->fetched & Bit(RefreshScheduler::Containers)) {
+            if (fetched.containers) MarkFresh();
+            scheduler.Completed(RefreshScheduler::Containers,
+                                fetched.containers && PopulateAllContainers(fetched.containers));
+        }
+        if (data->fetched & Bit(RefreshScheduler::Images)) {
+            scheduler.Completed(RefreshScheduler::Images,
+                                fetched.images && PopulateAllImages(fetched.images));
+        }
+        if (data->fetched & Bit(RefreshScheduler::Volumes)) {
+            scheduler.Completed(RefreshScheduler::Volumes,
+                                fetched.volumes && PopulateAllVolumes(fetched.volumes));
+        }
+        if (data->fetched & Bit(RefreshScheduler::Stats)) {
+            scheduler.Completed(RefreshScheduler::Stats, UpdateSystemInfoUI(data->systemInfo));
+            runningList->RefreshHistory();
+        }
+
+        delete data;
     }
 
-    removeImageButton->Enable(false);
+    ScheduleNextRefresh();
 }
 
-void DockerManagerFrame::PopulateAllVolumes(
-    const std::vector<VolumeInfo>& volumes) {
-    volumesList->DeleteAllItems();
+void DockerManagerFrame::OnStateChanged(wxThreadEvent& event) {
+    ResourceSnapshot* snapshot = event.GetPayload<ResourceSnapshot*>();
+    if (!snapshot) return;
 
-    int row = 0;
-    for (const auto& volume : volumes) {
-        long index = volumesList->InsertItem(row,
-                                              wxString::FromUTF8(volume.name.c_str()));
-        volumesList->SetItem(index, 1, wxString::FromUTF8(volume.driver.c_str()));
-        row++;
-    }
+    MarkFresh();
+    PopulateAllContainers(snapshot->containers);
+    PopulateAllImages(snapshot->images);
+    PopulateAllVolumes(snapshot->volumes);
+    delete snapshot;
+}
 
-    removeVolumeButton->Enable(false);
+bool DockerManagerFrame::PopulateAllContainers(const ContainerTable::Ptr& containers) {
+    shown.containers = containers;
+    bool changed = runningList->SetRows(ContainerTable::RowsOf(containers));
+    if (containers) inspectCache.Retain(*containers);
+    UpdateContainerButtons();
+    ShowContainerDetails();
+    return changed;
 }
 
-void DockerManagerFrame::UpdateSystemInfoUI(const SystemInfo& info) {
+bool DockerManagerFrame::PopulateAllImages(const ImageTable::Ptr& images) {
+    shown.images = images;
+    bool changed = imagesList->SetRows(ImageTable::RowsOf(images));
+    UpdateImageButtons();
+    if (changed) AnalyzeLayersAsync();
+    return changed;
+}
+
+bool DockerManagerFrame::PopulateAllVolumes(const VolumeTable::Ptr& volumes) {
+    shown.volumes = volumes;
+    bool changed = volumesList->SetRows(VolumeTable::RowsOf(volumes));
+    removeVolumeButton->Enable(volumesList->GetSelectedRow() != nullptr);
+    if (changed) ScanVolumesAsync();
+    return changed;
+}
+
+bool DockerManagerFrame::UpdateSystemInfoUI(const SystemInfo& info) {
+    if (info.cpu_usage == lastSystemInfo.cpu_usage &&
+        info.mem_bytes == lastSystemInfo.mem_bytes &&
+        info.container_count == lastSystemInfo.container_count) {
+        return false;
+    }
+    lastSystemInfo = info;
+
     cpuLabel->SetLabel(wxString::Format(wxT("CPU: %.1f%%"), info.cpu_usage));
     memLabel->SetLabel(wxString::Format(wxT("Memory: %s"),
-                       wxString::FromUTF8(info.mem_usage.c_str())));
+                       wxString::FromUTF8(FormatBinaryBytes(static_cast<double>(info.mem_bytes)).c_str())));
     containersLabel->SetLabel(wxString::Format(wxT("Containers: %d"),
                               info.container_count));
+    return true;
+}
+
+void DockerManagerFrame::UpdateDaemonLoad(const DaemonCallStats& calls) {
+    wxString text;
+    if (calls.waiting > 0) {
+        text = wxString::Format(wxT("Daemon busy: %d queued"), static_cast<int>(calls.waiting));
+    }
+    if (daemonLabel->GetLabel() != text) daemonLabel->SetLabel(text);
 }
 
 void DockerManagerFrame::OnStop(wxCommandEvent& event) {
-    long selected = runningList->GetNextItem(-1, wxLIST_NEXT_ALL,
-                                              wxLIST_STATE_SELECTED);
-    if (selected == -1) return;
+    std::vector<std::string> ids;
+    std::vector<std::string> names;
+    for (const ContainerRow* c : runningList->GetSelectedRows()) {
+        if (!IsActive(*c)) continue;
+        ids.push_back(c->id.str());
+        names.push_back(c->name.str());
+    }
+    if (ids.empty()) return;
 
-    wxString id = runningList->GetItemText(selected, 0);
-    wxString name = runningList->GetItemText(selected, 1);
+    wxString question = ids.size() == 1
+        ? wxString::Format(wxT("Stop container '%s' (%s)?"),
+                           wxString::FromUTF8(names[0].c_str()), wxString::FromUTF8(ids[0].c_str()))
+        : wxString::Format(wxT("Stop %d selected containers?"), static_cast<int>(ids.size()));
 
     int response = wxMessageBox(
-        wxString::Format(wxT("Stop container '%s' (%s)?"), name, id),
+        question,
         wxT("Confirmation"),
         wxYES_NO | wxICON_QUESTION,
         this
     );
 
     if (response == wxYES) {
-        bool success = DockerCommands::StopContainer(std::string(id.mb_str()));
-        RefreshAllAsync();
-        if (success) {
-            wxMessageBox(wxT("Container stopped"), wxT("Success"),
-                         wxOK | wxICON_INFORMATION);
-        } else {
-            wxMessageBox(wxT("Failed to stop container"), wxT("Error"),
-                         wxOK | wxICON_ERROR);
-        }
+        jobs->Submit(JobTitle("Stop", "container", names),
+                     BulkJob(ids, [](const std::string& id, std::string* error) {
+                         return DockerCommands::StopContainer(id, error);
+                     }, bulkConcurrency));
     }
 }
 
@@ -354,159 +959,458 @@ void DockerManagerFrame::OnStopAll(wxCommandEvent& event) {
     );
 
     if (response == wxYES) {
-        bool success = DockerCommands::StopAllContainers();
-        RefreshAllAsync();
-        if (success) {
-            wxMessageBox(wxT("All containers stopped"), wxT("Success"),
-                         wxOK | wxICON_INFORMATION);
-        } else {
-            wxMessageBox(wxT("Failed to stop containers (none running or error occurred)"),
-                         wxT("Error"), wxOK | wxICON_ERROR);
-        }
+        size_t concurrency = bulkConcurrency;
+        jobs->Submit("Stop all running containers", [concurrency](JobContext& context) {
+            std::vector<BulkItemResult> results;
+            if (DockerCommands::StopAllContainers(ReportTo(context), &results, concurrency)) {
+                return true;
+            }
+            std::string summary = BulkExecutor::Summarize(results);
+            context.SetMessage(summary.empty() ? "No running containers" : summary);
+            return false;
+        });
     }
 }
 
 void DockerManagerFrame::OnRemoveContainer(wxCommandEvent& event) {
-    long selected = runningList->GetNextItem(-1, wxLIST_NEXT_ALL,
-                                              wxLIST_STATE_SELECTED);
-    if (selected == -1) return;
+    std::vector<std::string> ids;
+    std::vector<std::string> names;
+    for (const ContainerRow* c : runningList->GetSelectedRows()) {
+        if (IsActive(*c)) continue;
+        ids.push_back(c->id.str());
+        names.push_back(c->name.str());
+    }
+    if (ids.empty()) return;
 
-    wxString id   = runningList->GetItemText(selected, 0);
-    wxString name = runningList->GetItemText(selected, 1);
+    wxString question = ids.size() == 1
+        ? wxString::Format(wxT("Remove container '%s' (%s)?"),
+                           wxString::FromUTF8(names[0].c_str()), wxString::FromUTF8(ids[0].c_str()))
+        : wxString::Format(wxT("Remove %d selected containers?"), static_cast<int>(ids.size()));
 
     int response = wxMessageBox(
-        wxString::Format(wxT("Remove container '%s' (%s)?"), name, id),
+        question,
         wxT("Confirmation"),
         wxYES_NO | wxICON_WARNING,
         this
     );
 
     if (response == wxYES) {
-        bool success = DockerCommands::RemoveContainer(std::string(id.mb_str()));
-        RefreshAllAsync();
-        if (success) {
-            wxMessageBox(wxT("Container removed"), wxT("Success"),
-                         wxOK | wxICON_INFORMATION);
-        } else {
-            wxMessageBox(wxT("Failed to remove container"), wxT("Error"),
-                         wxOK | wxICON_ERROR);
-        }
+        jobs->Submit(JobTitle("Remove", "container", names),
+                     BulkJob(ids, [](const std::string& id, std::string* error) {
+                         return DockerCommands::RemoveContainer(id, error);
+                     }, bulkConcurrency));
+    }
+}
+
+void DockerManagerFrame::OnShowHistory(wxCommandEvent& event) {
+    const ContainerRow* container = runningList->GetSelectedRow();
+    if (!container || !archive) return;
+
+    // Rollups keep even the 7-day range to a few segment files, so the
+    // queries run inline.
+    const auto started = std::chrono::steady_clock::now();
+    const time_t now = time(nullptr);
+    std::string text;
+    for (const auto& range : kHistoryRanges) {
+        ArchiveQueryResult result;
+        archive->Query(container->id.str(), now - range.seconds, now, result);
+        text += std::string(range.label) + " (" + std::to_string(result.points.size()) +
+                " points, " + result.tier + "):\n" + MetricsArchive::Describe(result, 40) + "\n";
+    }
+    const double elapsedMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - started).count();
+
+    wxString msg = wxString::FromUTF8(text.c_str()) +
+                   wxString::Format(wxT("Queried in %.1f ms from %s"), elapsedMs,
+                                    wxString::FromUTF8(archive->GetDirectory().c_str()));
+    wxMessageBox(msg, wxString::FromUTF8(("History of " + container->name.str()).c_str()),
+                 wxOK | wxICON_INFORMATION, this);
+}
+
+void DockerManagerFrame::OnShowLogs(wxCommandEvent& event) {
+    const ContainerRow* container = runningList->GetSelectedRow();
+    if (!container) return;
+    // One window per request; each follows its own stream until closed.
+    LogViewer* viewer = new LogViewer(this, container->id.str(), container->name.str());
+    viewer->Show();
+}
+
+std::vector<std::string> DockerManagerFrame::SelectedImageIds() const {
+    // An image with several tags is selected once per tag row.
+    std::vector<std::string> ids;
+    std::unordered_set<std::string> seen;
+    for (const ImageRow* image : imagesList->GetSelectedRows()) {
+        if (seen.insert(image->id.str()).second) ids.push_back(image->id.str());
+    }
+    return ids;
+}
+
+void DockerManagerFrame::AnalyzeLayersAsync() {
+    if (!daemonReady) return;
+    if (analyzingLayers) {
+        layersDirty = true;
+        return;
+    }
+    analyzingLayers = true;
+    layersDirty = false;
+
+    std::vector<std::string> ids;
+    ids.reserve(shown.images->size());
+    for (const ImageRow& image : *shown.images) ids.push_back(image.id.str());
+    LayerAnalyzer* analyzer = layerAnalyzer;
+    workers->Submit([this, analyzer, ids] {
+        LayerReport* report = new LayerReport();
+        report->changed = analyzer->Update(ids);
+        if (report->changed) report->usage = analyzer->GetAllUsage();
+        report->diskBytes = analyzer->TotalBytes();
+
+        wxThreadEvent* event = new wxThreadEvent(wxEVT_THREAD, ID_LAYERS_ANALYZED);
+        event->SetPayload(report);
+        wxQueueEvent(this, event);
+    }, WorkerPool::Background);
+}
+
+void DockerManagerFrame::OnLayersAnalyzed(wxThreadEvent& event) {
+    LayerReport* report = event.GetPayload<LayerReport*>();
+    analyzingLayers = false;
+    if (!report) return;
+
+    if (report->changed) {
+        layerDiskBytes = report->diskBytes;
+        layerListedBytes = 0;
+        for (const auto& image : report->usage) layerListedBytes += image.second.total;
+        imagesList->SetUsage(std::move(report->usage));
+        UpdateImageButtons();
     }
+    delete report;
+    if (layersDirty) AnalyzeLayersAsync();
+}
+
+void DockerManagerFrame::ScanVolumesAsync() {
+    if (!daemonReady) return;
+    if (scanningVolumes) {
+        volumesDirty = true;
+        return;
+    }
+    scanningVolumes = true;
+    volumesDirty = false;
+
+    // Only the local driver keeps its data under the volume root.
+    std::vector<std::string> names;
+    for (const VolumeRow& volume : *shown.volumes) {
+        if (volume.driver == "local") names.push_back(volume.name.str());
+    }
+    VolumeScanner* scanner = volumeScanner;
+    workers->Submit([this, scanner, names] {
+        VolumeScan* scan = new VolumeScan();
+        // Like the cgroup files, the volume root only describes a local daemon.
+        scan->available = DockerApiClient::Instance().IsEnabled() && scanner->IsAvailable();
+        if (scan->available) scan->sizes = scanner->Scan(names);
+
+        wxThreadEvent* event = new wxThreadEvent(wxEVT_THREAD, ID_VOLUMES_SCANNED);
+        event->SetPayload(scan);
+        wxQueueEvent(this, event);
+    }, WorkerPool::Background);
+}
+
+void DockerManagerFrame::OnVolumesScanned(wxThreadEvent& event) {
+    VolumeScan* scan = event.GetPayload<VolumeScan*>();
+    scanningVolumes = false;
+    if (!scan) return;
+
+    if (scan->available) {
+        scheduler.Completed(RefreshScheduler::VolumeSizes,
+                            volumesList->SetSizes(std::move(scan->sizes)));
+    } else {
+        // Usually not running as root; the size column stays blank.
+        scheduler.Completed(RefreshScheduler::VolumeSizes, false);
+        scheduler.SetPaused(RefreshScheduler::VolumeSizes, true);
+        volumesDirty = false;
+    }
+    delete scan;
+    if (volumesDirty) ScanVolumesAsync();
+    ScheduleNextRefresh();
 }
 
 void DockerManagerFrame::OnRemoveImage(wxCommandEvent& event) {
-    long selected = imagesList->GetNextItem(-1, wxLIST_NEXT_ALL,
-                                             wxLIST_STATE_SELECTED);
-    if (selected == -1) return;
+    std::vector<std::string> ids = SelectedImageIds();
+    if (ids.empty()) return;
 
-    wxString id = imagesList->GetItemText(selected, 0);
+    wxString question = ids.size() == 1
+        ? wxString::Format(wxT("Remove image %s?"), wxString::FromUTF8(ids[0].c_str()))
+        : wxString::Format(wxT("Remove %d selected images?"), static_cast<int>(ids.size()));
 
     int response = wxMessageBox(
-        wxString::Format(wxT("Remove image %s?"), id),
+        question,
         wxT("Confirmation"),
         wxYES_NO | wxICON_WARNING,
         this
     );
 
     if (response == wxYES) {
-        bool success = DockerCommands::RemoveImage(std::string(id.mb_str()));
-        RefreshAllAsync();
-        if (success) {
-            wxMessageBox(wxT("Image removed"), wxT("Success"),
-                         wxOK | wxICON_INFORMATION);
-        } else {
-            wxMessageBox(wxT("Failed to remove image"), wxT("Error"),
-                         wxOK | wxICON_ERROR);
-        }
+        jobs->Submit(JobTitle("Remove", "image", ids),
+                     BulkJob(ids, [](const std::string& id, std::string* error) {
+                         return DockerCommands::RemoveImage(id, error);
+                     }, bulkConcurrency));
     }
 }
 
 void DockerManagerFrame::OnRemoveVolume(wxCommandEvent& event) {
-    long selected = volumesList->GetNextItem(-1, wxLIST_NEXT_ALL,
-                                              wxLIST_STATE_SELECTED);
-    if (selected == -1) return;
+    std::vector<std::string> names;
+    for (const VolumeRow* volume : volumesList->GetSelectedRows()) {
+        names.push_back(volume->name.str());
+    }
+    if (names.empty()) return;
 
-    wxString name = volumesList->GetItemText(selected, 0);
+    wxString question = names.size() == 1
+        ? wxString::Format(wxT("Remove volume %s?"), wxString::FromUTF8(names[0].c_str()))
+        : wxString::Format(wxT("Remove %d selected volumes?"), static_cast<int>(names.size()));
 
     int response = wxMessageBox(
-        wxString::Format(wxT("Remove volume %s?"), name),
+        question,
         wxT("Confirmation"),
         wxYES_NO | wxICON_WARNING,
         this
     );
 
     if (response == wxYES) {
-        bool success = DockerCommands::RemoveVolume(std::string(name.mb_str()));
-        RefreshAllAsync();
-        if (success) {
-            wxMessageBox(wxT("Volume removed"), wxT("Success"),
-                         wxOK | wxICON_INFORMATION);
-        } else {
-            wxMessageBox(wxT("Failed to remove volume"), wxT("Error"),
-                         wxOK | wxICON_ERROR);
-        }
+        jobs->Submit(JobTitle("Remove", "volume", names),
+                     BulkJob(names, [](const std::string& name, std::string* error) {
+                         return DockerCommands::RemoveVolume(name, error);
+                     }, bulkConcurrency));
     }
 }
 
 void DockerManagerFrame::OnPruneAll(wxCommandEvent& event) {
-    int response = wxMessageBox(
-        wxT("WARNING! This will remove:\n"
-            "- All stopped containers\n"
-            "- All unused images\n"
-            "- All unused volumes\n"
-            "- All build cache\n\n"
-            "Continue?"),
-        wxT("Confirmation"),
-        wxYES_NO | wxICON_WARNING,
-        this
-    );
+    // The preview needs every object and its links at one moment, which
+    // is a single /system/df request; the dialog opens when it is back.
+    pruneAllButton->Enable(false);
+    workers->Submit([this] {
+        DiskUsageRead* read = new DiskUsageRead();
+        read->ok = DockerCommands::GetDiskUsage(read->usage);
+
+        wxThreadEvent* event = new wxThreadEvent(wxEVT_THREAD, ID_DISK_USAGE_READ);
+        event->SetPayload(read);
+        wxQueueEvent(this, event);
+    }, WorkerPool::Interactive);
+}
 
-    if (response == wxYES) {
-        bool success = DockerCommands::PruneAll();
-        RefreshAllAsync();
-        if (success) {
-            wxMessageBox(wxT("Pruning completed!"), wxT("Success"),
-                         wxOK | wxICON_INFORMATION);
-        } else {
-            wxMessageBox(wxT("Pruning failed or nothing to prune"), wxT("Error"),
-                         wxOK | wxICON_ERROR);
-        }
+void DockerManagerFrame::OnDiskUsageRead(wxThreadEvent& event) {
+    DiskUsageRead* read = event.GetPayload<DiskUsageRead*>();
+    pruneAllButton->Enable(true);
+    if (!read) return;
+    if (!read->ok) {
+        wxMessageBox(wxT("Could not read Docker's disk usage."), wxT("Error"),
+                     wxOK | wxICON_ERROR, this);
+        delete read;
+        return;
     }
+
+    DependencyGraph graph(read->usage);
+    delete read;
+
+    // Exact when the layer analysis covers every image to remove.
+    LayerAnalyzer* analyzer = layerAnalyzer;
+    PruneDialog dialog(this, graph, [analyzer](const std::vector<std::string>& ids, int64_t& bytes) {
+        size_t unknown = 0;
+        bytes = analyzer->GetSelectionUsage(ids, &unknown).reclaimable;
+        return unknown == 0;
+    });
+    if (dialog.ShowModal() != wxID_OK) return;
+
+    const PrunePlan& plan = dialog.GetPlan();
+    const size_t count = plan.Removed(PruneKind::Container).size() +
+                         plan.Removed(PruneKind::Image).size() +
+                         plan.Removed(PruneKind::Volume).size();
+    jobs->Submit("Prune " + std::to_string(count) + " unused objects",
+                 PruneJob(plan, dialog.PruneNetworksAndBuildCache(), bulkConcurrency));
 }
 
 void DockerManagerFrame::OnRefresh(wxCommandEvent& event) {
-    RefreshAllAsync();
+    if (stateTracker) stateTracker->RequestResync();
+    RefreshSoon();
 }
 
 void DockerManagerFrame::OnTimer(wxTimerEvent& event) {
-    RefreshAllAsync();
+    RunScheduler();
+}
+
+void DockerManagerFrame::OnIconize(wxIconizeEvent& event) {
+    scheduler.SetIconized(event.IsIconized());
+    if (event.IsIconized()) {
+        refreshTimer->Stop();
+    } else {
+        RefreshSoon();
+    }
+    event.Skip();
+}
+
+void DockerManagerFrame::OnPageChanged(wxBookCtrlEvent& event) {
+    // AddPage() can report the first selection before the timer exists.
+    if (refreshTimer) {
+        UpdateVisibility();
+        RunScheduler();
+    }
+    event.Skip();
 }
 
 void DockerManagerFrame::OnClose(wxCloseEvent& event) {
     if (refreshTimer) {
         refreshTimer->Stop();
     }
+    if (stateTracker) {
+        stateTracker->Stop();
+    }
+    // Bulk stops and prunes end after their current item instead of keeping
+    // the window up until every object is done.
+    if (jobs) {
+        for (const JobStatus& job : jobs->GetJobs()) {
+            if (!job.IsFinished()) jobs->Cancel(job.id);
+        }
+    }
+    // Waits for in-flight commands; queued refreshes are dropped.
+    workers->Shutdown();
+    StatsCollector::Instance().Stop();
+    StatsCollector::Instance().SetArchive(nullptr);
+    if (archive) archive->Close();
+    SaveSession();
     Destroy();
 }
 
 void DockerManagerFrame::OnRunningItemSelected(wxListEvent& event) {
-    long selected = runningList->GetNextItem(-1, wxLIST_NEXT_ALL,
-                                              wxLIST_STATE_SELECTED);
-    if (selected == -1) return;
+    UpdateContainerButtons();
+    inspectFailedId.clear();
+    ShowContainerDetails();
+}
+
+void DockerManagerFrame::ShowContainerDetails() {
+    const ContainerRow* container =
+        runningList->GetSelectedItemCount() == 1 ? runningList->GetSelectedRow() : nullptr;
+    std::string text;
+    if (!container) {
+        text = "Select a container to see its ports, mounts, environment and limits.";
+    } else {
+        const std::string id = container->id.str();
+        InspectCache::DetailsPtr details = inspectCache.Get(id, container->state);
+        if (details) {
+            text = DescribeContainer(*details);
+        } else if (id == inspectFailedId) {
+            text = "Could not inspect " + container->name + ".";
+        } else {
+            text = "Loading details of " + container->name + "...";
+            InspectContainerAsync(id, container->state);
+        }
+    }
+    // Setting the same text again would scroll it back to the top.
+    wxString value = wxString::FromUTF8(text.c_str());
+    if (detailsText->GetValue() != value) detailsText->ChangeValue(value);
+}
+
+void DockerManagerFrame::InspectContainerAsync(const std::string& id, ContainerState state) {
+    // One at a time; when it finishes the selection is looked at again.
+    if (!daemonReady || inspecting) return;
+    inspecting = true;
+
+    workers->Submit([this, id, state] {
+        ContainerInspection* inspection = new ContainerInspection();
+        inspection->id = id;
+        inspection->state = state;
+        inspection->ok = DockerCommands::InspectContainer(id, inspection->details);
+
+        wxThreadEvent* event = new wxThreadEvent(wxEVT_THREAD, ID_CONTAINER_INSPECTED);
+        event->SetPayload(inspection);
+        wxQueueEvent(this, event);
+    }, WorkerPool::Interactive);
+}
+
+void DockerManagerFrame::OnContainerInspected(wxThreadEvent& event) {
+    ContainerInspection* inspection = event.GetPayload<ContainerInspection*>();
+    inspecting = false;
+    if (!inspection) return;
+
+    if (inspection->ok) {
+        // A state change while the request ran has already passed Retain();
+        // the details would describe the old state, so leave them out.
+        bool current = false;
+        for (const ContainerRow& row : *shown.containers) {
+            if (row.id == inspection->id) {
+                current = row.state == inspection->state;
+                break;
+            }
+        }
+        if (current) {
+            inspectCache.Put(inspection->id, inspection->state,
+                             std::make_shared<const ContainerDetails>(
+                                 std::move(inspection->details)));
+        }
+    } else {
+        inspectFailedId = inspection->id;
+    }
+    delete inspection;
+    ShowContainerDetails();
+}
 
-    wxString state = runningList->GetItemText(selected, 2);
-    bool isRunning = (state == wxT("running") || state == wxT("paused"));
+void DockerManagerFrame::UpdateContainerButtons() {
+    bool anyActive = false;
+    bool anyStopped = false;
+    for (const ContainerRow* c : runningList->GetSelectedRows()) {
+        if (IsActive(*c)) {
+            anyActive = true;
+        } else {
+            anyStopped = true;
+        }
+    }
 
-    stopButton->Enable(isRunning);
-    removeContainerButton->Enable(!isRunning);
+    stopButton->Enable(anyActive);
+    removeContainerButton->Enable(anyStopped);
+    historyButton->Enable(archive && runningList->GetSelectedItemCount() == 1);
+    logsButton->Enable(runningList->GetSelectedItemCount() == 1);
+}
+
+void DockerManagerFrame::UpdateImageButtons() {
+    std::vector<std::string> ids = SelectedImageIds();
+    removeImageButton->Enable(!ids.empty());
+
+    if (layerListedBytes == 0) {
+        imageUsageLabel->SetLabel(wxEmptyString);
+        return;
+    }
+    wxString text = wxString::Format(wxT("Layers use %s on disk; the image sizes add up to %s."),
+                                     DecimalBytes(layerDiskBytes), DecimalBytes(layerListedBytes));
+    if (!ids.empty()) {
+        LayerUsage selection = layerAnalyzer->GetSelectionUsage(ids);
+        text += wxString::Format(wxT(" Removing the selection frees %s; %s is shared ")
+                                 wxT("with other images."),
+                                 DecimalBytes(selection.reclaimable),
+                                 DecimalBytes(selection.shared));
+    }
+    imageUsageLabel->SetLabel(text);
 }
 
 void DockerManagerFrame::OnImageItemSelected(wxListEvent& event) {
-    removeImageButton->Enable(true);
+    UpdateImageButtons();
 }
 
 void DockerManagerFrame::OnVolumeItemSelected(wxListEvent& event) {
-    removeVolumeButton->Enable(true);
+    removeVolumeButton->Enable(volumesList->GetSelectedItemCount() > 0);
+}
+
+void DockerManagerFrame::OnFilterText(wxCommandEvent& event) {
+    std::string text(event.GetString().utf8_str());
+    switch (event.GetId()) {
+        case ID_CONTAINER_FILTER:
+            runningList->SetFilter(text);
+            UpdateContainerButtons();
+            break;
+        case ID_IMAGE_FILTER:
+            imagesList->SetFilter(text);
+            UpdateImageButtons();
+            break;
+        case ID_VOLUME_FILTER:
+            volumesList->SetFilter(text);
+            removeVolumeButton->Enable(volumesList->GetSelectedItemCount() > 0);
+            break;
+    }
 }
 
 wxIMPLEMENT_APP(DockerManagerApp);
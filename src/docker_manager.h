@@ -1,11 +1,23 @@
 #pragma once
 
 #include <wx/wx.h>
+#include <wx/infobar.h>
 #include <wx/notebook.h>
+#include <wx/srchctrl.h>
 #include <wx/listctrl.h>
 #include <wx/timer.h>
 #include <wx/thread.h>
 #include "docker_commands.h"
+#include "docker_state.h"
+#include "inspect_cache.h"
+#include "resource_lists.h"
+#include "job_queue.h"
+#include "layer_analyzer.h"
+#include "metrics_archive.h"
+#include "refresh_scheduler.h"
+#include "session_snapshot.h"
+#include "volume_scanner.h"
+#include "worker_pool.h"
 
 class DockerManagerFrame : public wxFrame {
 public:
@@ -13,53 +25,126 @@ public:
     ~DockerManagerFrame();
     
     void OnUpdateComplete(wxThreadEvent& event);
+    void OnStateChanged(wxThreadEvent& event);
+    void OnJobUpdated(wxThreadEvent& event);
+    void OnDaemonProbed(wxThreadEvent& event);
+    void OnLayersAnalyzed(wxThreadEvent& event);
+    void OnDiskUsageRead(wxThreadEvent& event);
+    void OnVolumesScanned(wxThreadEvent& event);
+    void OnContainerInspected(wxThreadEvent& event);
     
 private:
+    wxInfoBar* infoBar;
     wxNotebook* notebook;
     wxPanel* runningPanel;
     wxPanel* cleanupPanel;
+    wxPanel* jobsPanel;
     
-    wxListCtrl* runningList;   
-    wxListCtrl* imagesList;
-    wxListCtrl* volumesList;
+    ContainerListCtrl* runningList;
+    ImageListCtrl* imagesList;
+    VolumeListCtrl* volumesList;
+    JobListCtrl* jobsList;
+    wxSearchCtrl* containerFilter;
+    wxSearchCtrl* imageFilter;
+    wxSearchCtrl* volumeFilter;
     
     wxStaticText* cpuLabel;
     wxStaticText* memLabel;
     wxStaticText* containersLabel;
+    wxStaticText* daemonLabel;
+    wxStaticText* imageUsageLabel;
+    wxTextCtrl* detailsText;
     
     wxButton* stopButton;
     wxButton* stopAllButton;
     wxButton* removeContainerButton;
+    wxButton* historyButton;
+    wxButton* logsButton;
     wxButton* removeImageButton;
     wxButton* removeVolumeButton;
     wxButton* pruneAllButton;
     wxButton* refreshButton;
+    wxButton* cancelJobButton;
+    wxButton* clearJobsButton;
     
     wxTimer* refreshTimer;
-    bool isUpdating;
+    RefreshScheduler scheduler;
+    SystemInfo lastSystemInfo;
+    ResourceSnapshot shown;  // tables behind the three lists
+    DockerStateTracker* stateTracker;
+    WorkerPool* workers;
+    JobQueue* jobs;
+    MetricsArchive* archive;
+    LayerAnalyzer* layerAnalyzer;
+    VolumeScanner* volumeScanner;
+    size_t bulkConcurrency;
+    bool daemonReady;     // a probe succeeded; fetching has started
+    bool probing;
+    bool probeFailed;     // the banner carries a Retry button
+    bool stale;           // lists show the saved session, not the daemon
+    int64_t staleSavedAt;
+    bool analyzingLayers;
+    bool layersDirty;     // the images changed during the analysis
+    int64_t layerDiskBytes;    // distinct layers of the analyzed images
+    int64_t layerListedBytes;  // the same images' sizes added up
+    bool scanningVolumes;
+    bool volumesDirty;    // the volumes changed during the scan
+    InspectCache inspectCache;
+    bool inspecting;
+    std::string inspectFailedId;  // not retried until selected again
     
     void CreateSystemInfoPanel(wxPanel* parent, wxSizer* sizer);
     void CreateRunningPanel();
     void CreateCleanupPanel();
+    void CreateJobsPanel();
     
-    void PopulateAllContainers(const std::vector<ContainerInfo>& containers);
-    void PopulateAllImages(const std::vector<ImageInfo>& images);
-    void PopulateAllVolumes(const std::vector<VolumeInfo>& volumes);
-    void UpdateSystemInfoUI(const SystemInfo& info);
-    void RefreshAllAsync();
+    bool PopulateAllContainers(const ContainerTable::Ptr& containers);
+    bool PopulateAllImages(const ImageTable::Ptr& images);
+    bool PopulateAllVolumes(const VolumeTable::Ptr& volumes);
+    bool UpdateSystemInfoUI(const SystemInfo& info);
+    void UpdateDaemonLoad(const DaemonCallStats& calls);
+    void UpdateContainerButtons();
+    void UpdateImageButtons();
+    std::vector<std::string> SelectedImageIds() const;
+    void AnalyzeLayersAsync();
+    void ScanVolumesAsync();
+    void ShowContainerDetails();
+    void InspectContainerAsync(const std::string& id, ContainerState state);
+    void PopulateJobs();
+    void UpdateJobButtons();
+    void RefreshAsync(unsigned resources);
+    void RunScheduler();
+    void RefreshSoon();
+    void ScheduleNextRefresh();
+    void UpdateVisibility();
+    void ProbeDaemonAsync();
+    void LoadLastSession();
+    void SaveSession();
+    void SetStale(bool value);
+    void MarkFresh();
     
     void OnStop(wxCommandEvent& event);
     void OnStopAll(wxCommandEvent& event);
     void OnRemoveContainer(wxCommandEvent& event);
+    void OnShowHistory(wxCommandEvent& event);
+    void OnShowLogs(wxCommandEvent& event);
     void OnRemoveImage(wxCommandEvent& event);
     void OnRemoveVolume(wxCommandEvent& event);
     void OnPruneAll(wxCommandEvent& event);
     void OnRefresh(wxCommandEvent& event);
+    void OnCancelJob(wxCommandEvent& event);
+    void OnClearJobs(wxCommandEvent& event);
     void OnTimer(wxTimerEvent& event);
     void OnClose(wxCloseEvent& event);
+    void OnIconize(wxIconizeEvent& event);
+    void OnPageChanged(wxBookCtrlEvent& event);
+    void OnRetryProbe(wxCommandEvent& event);
+    void OnFilterText(wxCommandEvent& event);
+    void OnFirstPaint(wxPaintEvent& event);
     void OnRunningItemSelected(wxListEvent& event);
     void OnImageItemSelected(wxListEvent& event);
     void OnVolumeItemSelected(wxListEvent& event);
+    void OnJobItemSelected(wxListEvent& event);
     
     wxDECLARE_EVENT_TABLE();
 };
@@ -77,7 +162,23 @@ enum {
     ID_STOPPED_LIST,
     ID_IMAGES_LIST,
     ID_VOLUMES_LIST,
-    ID_UPDATE_COMPLETE
+    ID_UPDATE_COMPLETE,
+    ID_STATE_CHANGED,
+    ID_JOBS_LIST,
+    ID_CANCEL_JOB,
+    ID_CLEAR_JOBS,
+    ID_JOB_UPDATED,
+    ID_SHOW_HISTORY,
+    ID_SHOW_LOGS,
+    ID_DAEMON_PROBED,
+    ID_RETRY_PROBE,
+    ID_CONTAINER_FILTER,
+    ID_IMAGE_FILTER,
+    ID_VOLUME_FILTER,
+    ID_LAYERS_ANALYZED,
+    ID_DISK_USAGE_READ,
+    ID_VOLUMES_SCANNED,
+    ID_CONTAINER_INSPECTED
 };
 
 class DockerManagerApp : public wxApp {
@@ -0,0 +1,263 @@
+#include "docker_state.h"
+#include <algorithm>
+
+namespace {
+
+std::string ShortId(const std::string& id) {
+    std::string s = id;
+    if (s.compare(0, 7, "sha256:") == 0) s.erase(0, 7);
+    if (s.size() > 12) s.resize(12);
+    return s;
+}
+
+bool IsContainerNoise(const std::string& action) {
+    static const char* ignored[] = {
+        "exec_create", "exec_start", "exec_die", "exec_detach", "attach", "detach",
+        "resize", "top", "archive-path", "extract-to-dir", "copy", "export", "commit",
+        "update", nullptr
+    };
+    for (int i = 0; ignored[i]; ++i) {
+        if (action == ignored[i]) return true;
+    }
+    return false;
+}
+
+// Removes every row of `imageId` and puts `with` where the first of them was.
+void ReplaceImage(std::vector<ImageRow>& rows, const std::string& imageId,
+                  const std::vector<ImageInfo>& with) {
+    auto pos = std::find_if(rows.begin(), rows.end(),
+                            [&imageId](const ImageRow& i) { return i.id == imageId; });
+    size_t at = pos == rows.end() ? 0 : static_cast<size_t>(pos - rows.begin());
+    rows.erase(std::remove_if(rows.begin(), rows.end(),
+                              [&imageId](const ImageRow& i) { return i.id == imageId; }),
+               rows.end());
+    std::vector<ImageRow> added;
+    for (const auto& info : with) added.push_back(ImageRow::From(info));
+    rows.insert(rows.begin() + std::min(at, rows.size()), added.begin(), added.end());
+}
+
+}  // namespace
+
+DockerStateTracker::DockerStateTracker(ChangeCallback onChange)
+    : onChange(onChange),
+      watcher([this](const DockerEvent& e) { OnEvent(e); },
+              [this](bool connected) { OnStatus(connected); }),
+      synced(false),
+      resyncRequested(false),
+      lastEventNano(0) {}
+
+DockerStateTracker::~DockerStateTracker() {
+    Stop();
+}
+
+void DockerStateTracker::Start() {
+    watcher.Start();
+}
+
+void DockerStateTracker::Stop() {
+    watcher.Stop();
+    synced = false;
+}
+
+bool DockerStateTracker::IsLive() const {
+    return watcher.IsConnected() && synced;
+}
+
+void DockerStateTracker::RequestResync() {
+    resyncRequested = true;
+}
+
+ResourceSnapshot DockerStateTracker::GetSnapshot() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return model;
+}
+
+void DockerStateTracker::OnStatus(bool connected) {
+    if (!connected) {
+        synced = false;
+        return;
+    }
+    // Events may have been missed while disconnected; start from a full listing.
+    if (!synced || resyncRequested) Resync();
+}
+
+void DockerStateTracker::OnEvent(const DockerEvent& event) {
+    // The daemon reports events in order; going back in time means its clock
+    // moved or events were replayed, so the patches cannot be trusted.
+    if (event.timeNano != 0) {
+        if (event.timeNano < lastEventNano) RequestResync();
+        lastEventNano = event.timeNano;
+    }
+    if (!synced || resyncRequested) {
+        Resync();
+        return;
+    }
+
+    bool changed = false;
+    if (event.type == "container") {
+        changed = PatchContainer(event);
+    } else if (event.type == "image") {
+        changed = PatchImage(event);
+    } else if (event.type == "volume") {
+        changed = PatchVolume(event);
+    }
+
+    if (resyncRequested) {
+        Resync();
+    } else if (changed) {
+        Publish();
+    }
+}
+
+void DockerStateTracker::Resync() {
+    resyncRequested = false;
+
+    ResourceSnapshot fresh;
+    std::vector<ContainerInfo> containers;
+    std::vector<ImageInfo> images;
+    std::vector<VolumeInfo> volumes;
+    // Half a listing is worse than a stale one: keep the old model and try
+    // again on the next event or heartbeat.
+    if (!DockerCommands::GetAllContainers(containers) || !DockerCommands::GetAllImages(images) ||
+        !DockerCommands::GetAllVolumes(volumes)) {
+        synced = false;
+        return;
+    }
+    fresh.containers = ContainerTable::Build(containers);
+    fresh.images = ImageTable::Build(images);
+    fresh.volumes = VolumeTable::Build(volumes);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        model = fresh;
+    }
+    synced = true;
+    Publish();
+}
+
+void DockerStateTracker::Publish() {
+    if (!onChange) return;
+    onChange(GetSnapshot());
+}
+
+bool DockerStateTracker::PatchFailed() {
+    // The object's fate is unknown, so the model no longer matches the
+    // daemon; polling takes over until a full listing succeeds.
+    synced = false;
+    RequestResync();
+    return false;
+}
+
+bool DockerStateTracker::PatchContainer(const DockerEvent& event) {
+    if (IsContainerNoise(event.action)) return false;
+
+    const std::string id = ShortId(event.id);
+    ContainerInfo info;
+    bool exists = false;
+    if (event.action != "destroy") {
+        DockerCommands::Lookup found = DockerCommands::GetContainer(id, info);
+        if (found == DockerCommands::Lookup::Failed) return PatchFailed();
+        exists = found == DockerCommands::Lookup::Found;
+    }
+
+    // Patches run on the watcher thread only, so the table cannot change
+    // between reading it here and replacing it below. Readers keep whatever
+    // table they already hold.
+    ContainerTable::Ptr current = GetSnapshot().containers;
+    auto it = std::find_if(current->begin(), current->end(),
+                           [&id](const ContainerRow& c) { return c.id == id; });
+    if (!exists && it == current->end()) return false;
+
+    ContainerTable::Builder next(current->size() + 1);
+    // `docker ps` lists newest first.
+    if (exists && it == current->end()) next.Add(ContainerRow::From(info));
+    for (const auto& row : *current) {
+        if (row.id != id) {
+            next.Add(row);
+        } else if (exists) {
+            next.Add(ContainerRow::From(info));
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    model.containers = next.Finish();
+    return true;
+}
+
+bool DockerStateTracker::PatchImage(const DockerEvent& event) {
+    if (event.action == "push" || event.action == "save") return false;
+
+    std::vector<ImageInfo> fresh;
+    if (event.action != "delete" &&
+        DockerCommands::GetImage(event.id, fresh) == DockerCommands::Lookup::Failed) {
+        return PatchFailed();
+    }
+
+    std::string id = fresh.empty() ? ShortId(event.id) : fresh.front().id;
+
+    // A tag that moved to this image has left its previous owner, which the
+    // daemon does not report separately; refetch those images too.
+    ImageTable::Ptr current = GetSnapshot().images;
+    std::vector<std::string> displaced;
+    for (const auto& row : fresh) {
+        if (row.tag == "<none>") continue;
+        for (const auto& old : *current) {
+            if (old.id != id && old.repository == row.repository && old.tag == row.tag &&
+                std::find(displaced.begin(), displaced.end(), old.id) == displaced.end()) {
+                displaced.push_back(old.id.str());
+            }
+        }
+    }
+    std::vector<std::vector<ImageInfo>> displacedRows;
+    for (const auto& other : displaced) {
+        displacedRows.emplace_back();
+        if (DockerCommands::GetImage(other, displacedRows.back()) ==
+            DockerCommands::Lookup::Failed) {
+            return PatchFailed();
+        }
+    }
+
+    std::vector<ImageRow> rows(current->begin(), current->end());
+    ReplaceImage(rows, id, fresh);
+    for (size_t i = 0; i < displaced.size(); ++i) {
+        ReplaceImage(rows, displaced[i], displacedRows[i]);
+    }
+
+    ImageTable::Builder next(rows.size());
+    for (const auto& row : rows) next.Add(row);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    model.images = next.Finish();
+    return true;
+}
+
+bool DockerStateTracker::PatchVolume(const DockerEvent& event) {
+    if (event.action != "create" && event.action != "destroy") return false;
+
+    VolumeInfo info;
+    bool exists = false;
+    if (event.action == "create") {
+        DockerCommands::Lookup found = DockerCommands::GetVolume(event.id, info);
+        if (found == DockerCommands::Lookup::Failed) return PatchFailed();
+        exists = found == DockerCommands::Lookup::Found;
+    }
+
+    VolumeTable::Ptr current = GetSnapshot().volumes;
+    auto it = std::find_if(current->begin(), current->end(),
+                           [&event](const VolumeRow& v) { return v.name == event.id; });
+    if (!exists && it == current->end()) return false;
+
+    VolumeTable::Builder next(current->size() + 1);
+    for (const auto& row : *current) {
+        if (row.name != event.id) {
+            next.Add(row);
+        } else if (exists) {
+            next.Add(VolumeRow::From(info));
+        }
+    }
+    if (exists && it == current->end()) next.Add(VolumeRow::From(info));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    model.volumes = next.Finish();
+    return true;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "docker_commands.h"
+#include "docker_events.h"
+#include "resource_snapshot.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// In-memory copy of the daemon's containers, images and volumes, kept current
+// by the event stream. Each event only refetches the object it names; the
+// full lists are re-read when the stream (re)connects or a patch fails.
+class DockerStateTracker {
+public:
+    // Runs on the watcher thread after every change to the model.
+    typedef std::function<void(const ResourceSnapshot&)> ChangeCallback;
+
+    explicit DockerStateTracker(ChangeCallback onChange);
+    ~DockerStateTracker();
+
+    void Start();
+    void Stop();
+
+    // True while the event stream is connected and the model is in sync;
+    // polling the lists is unnecessary then.
+    bool IsLive() const;
+    void RequestResync();
+    // Cheap: the tables are shared, not copied.
+    ResourceSnapshot GetSnapshot() const;
+
+private:
+    ChangeCallback onChange;
+    EventWatcher watcher;
+    mutable std::mutex mutex;
+    ResourceSnapshot model;
+    std::atomic<bool> synced;
+    std::atomic<bool> resyncRequested;
+    int64_t lastEventNano;  // watcher thread only
+
+    void OnEvent(const DockerEvent& event);
+    void OnStatus(bool connected);
+    void Resync();
+    void Publish();
+
+    bool PatchContainer(const DockerEvent& event);
+    bool PatchImage(const DockerEvent& event);
+    bool PatchVolume(const DockerEvent& event);
+    // Marks the model unsynced after a lookup that neither found the object
+    // nor confirmed it is gone. Returns false.
+    bool PatchFailed();
+};
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <string>
+
+// Helpers shared by the files the manager writes itself: the session
+// snapshot and the metrics archive.
+
+// Creates `path` and any missing parents, like `mkdir -p`.
+bool MakeDirectories(const std::string& path);
+
+// Writes all of `data`, retrying short writes and EINTR. False with errno
+// set otherwise.
+bool WriteAll(int fd, const std::string& data);
+
+// Appends `value` in host byte order, as both file formats store numbers.
+template <typename T>
+void Put(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
@@ -0,0 +1,218 @@
+#include "gorilla_codec.h"
+#include <cstring>
+
+namespace {
+
+// Delta-of-delta ranges: a prefix of ones ended by a zero selects the width.
+struct TimeBucket {
+    int prefixBits;
+    uint64_t prefix;
+    int valueBits;
+    int64_t low;
+    int64_t high;
+};
+
+const TimeBucket kTimeBuckets[] = {
+    {2, 0x2, 7, -63, 64},
+    {3, 0x6, 9, -255, 256},
+    {4, 0xE, 12, -2047, 2048},
+};
+
+uint64_t ToBits(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double FromBits(uint64_t bits) {
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+int LeadingZeros(uint64_t x) {
+    return x == 0 ? 64 : __builtin_clzll(x);
+}
+
+int TrailingZeros(uint64_t x) {
+    return x == 0 ? 64 : __builtin_ctzll(x);
+}
+
+}  // namespace
+
+ChunkEncoder::ChunkEncoder(int columns)
+    : bitsFree(0), columns(columns > 0 ? columns : 1), count(0),
+      previousTime(0), previousDelta(0) {}
+
+void ChunkEncoder::WriteBits(uint64_t value, int bits) {
+    while (bits > 0) {
+        if (bitsFree == 0) {
+            bytes.push_back(0);
+            bitsFree = 8;
+        }
+        int take = bits < bitsFree ? bits : bitsFree;
+        uint64_t chunk = (value >> (bits - take)) & ((1ULL << take) - 1);
+        bytes.back() |= static_cast<uint8_t>(chunk << (bitsFree - take));
+        bitsFree -= take;
+        bits -= take;
+    }
+}
+
+void ChunkEncoder::WriteTime(int64_t time) {
+    if (count == 0) {
+        WriteBits(static_cast<uint64_t>(time), 64);
+        previousTime = time;
+        return;
+    }
+
+    const int64_t delta = time - previousTime;
+    const int64_t dod = delta - previousDelta;
+    previousTime = time;
+    previousDelta = delta;
+
+    if (dod == 0) {
+        WriteBits(0, 1);
+        return;
+    }
+    for (const auto& bucket : kTimeBuckets) {
+        if (dod >= bucket.low && dod <= bucket.high) {
+            WriteBits(bucket.prefix, bucket.prefixBits);
+            WriteBits(static_cast<uint64_t>(dod - bucket.low), bucket.valueBits);
+            return;
+        }
+    }
+    WriteBits(0xF, 4);
+    WriteBits(static_cast<uint64_t>(dod), 64);
+}
+
+void ChunkEncoder::WriteValue(Column& column, double value) {
+    const uint64_t bits = ToBits(value);
+    if (count == 0) {
+        WriteBits(bits, 64);
+        column.previous = bits;
+        return;
+    }
+
+    const uint64_t x = bits ^ column.previous;
+    column.previous = bits;
+    if (x == 0) {
+        WriteBits(0, 1);
+        return;
+    }
+    WriteBits(1, 1);
+
+    int leading = LeadingZeros(x);
+    const int trailing = TrailingZeros(x);
+    if (leading > 31) leading = 31;  // five bits
+
+    // Reuse the previous window when the meaningful bits still fit inside it.
+    if (column.leading >= 0 && leading >= column.leading && trailing >= column.trailing) {
+        WriteBits(0, 1);
+        WriteBits(x >> column.trailing, 64 - column.leading - column.trailing);
+        return;
+    }
+
+    const int meaningful = 64 - leading - trailing;
+    WriteBits(1, 1);
+    WriteBits(static_cast<uint64_t>(leading), 5);
+    WriteBits(static_cast<uint64_t>(meaningful & 63), 6);  // 64 wraps to 0
+    WriteBits(x >> trailing, meaningful);
+    column.leading = leading;
+    column.trailing = trailing;
+}
+
+void ChunkEncoder::Append(int64_t time, const double* values) {
+    WriteTime(time);
+    for (size_t i = 0; i < columns.size(); ++i) WriteValue(columns[i], values[i]);
+    ++count;
+}
+
+ChunkDecoder::ChunkDecoder(const uint8_t* data, size_t size, int columns, size_t count)
+    : data(data), sizeBits(size * 8), position(0), columns(columns > 0 ? columns : 1),
+      remaining(count), index(0), previousTime(0), previousDelta(0) {}
+
+bool ChunkDecoder::ReadBits(int bits, uint64_t& value) {
+    if (position + static_cast<size_t>(bits) > sizeBits) return false;
+    value = 0;
+    while (bits > 0) {
+        const int offset = static_cast<int>(position & 7);
+        const int available = 8 - offset;
+        const int take = bits < available ? bits : available;
+        const uint64_t byte = data[position >> 3];
+        value = (value << take) | ((byte >> (available - take)) & ((1ULL << take) - 1));
+        position += static_cast<size_t>(take);
+        bits -= take;
+    }
+    return true;
+}
+
+bool ChunkDecoder::ReadTime(int64_t& time) {
+    uint64_t bits;
+    if (index == 0) {
+        if (!ReadBits(64, bits)) return false;
+        time = previousTime = static_cast<int64_t>(bits);
+        return true;
+    }
+
+    int64_t dod = 0;
+    if (!ReadBits(1, bits)) return false;
+    if (bits != 0) {
+        bool matched = false;
+        for (const auto& bucket : kTimeBuckets) {
+            if (!ReadBits(1, bits)) return false;
+            if (bits == 0) {
+                if (!ReadBits(bucket.valueBits, bits)) return false;
+                dod = static_cast<int64_t>(bits) + bucket.low;
+                matched = true;
+                break;
+            }
+        }
+        if (!matched) {
+            if (!ReadBits(64, bits)) return false;
+            dod = static_cast<int64_t>(bits);
+        }
+    }
+
+    previousDelta += dod;
+    previousTime += previousDelta;
+    time = previousTime;
+    return true;
+}
+
+bool ChunkDecoder::ReadValue(Column& column, double& value) {
+    uint64_t bits;
+    if (index == 0) {
+        if (!ReadBits(64, bits)) return false;
+        column.previous = bits;
+        value = FromBits(bits);
+        return true;
+    }
+
+    if (!ReadBits(1, bits)) return false;
+    if (bits != 0) {
+        if (!ReadBits(1, bits)) return false;
+        if (bits != 0) {
+            uint64_t leading, meaningful;
+            if (!ReadBits(5, leading) || !ReadBits(6, meaningful)) return false;
+            if (meaningful == 0) meaningful = 64;
+            if (leading + meaningful > 64) return false;
+            column.leading = static_cast<int>(leading);
+            column.trailing = static_cast<int>(64 - leading - meaningful);
+        }
+        const int width = 64 - column.leading - column.trailing;
+        if (!ReadBits(width, bits)) return false;
+        column.previous ^= bits << column.trailing;
+    }
+    value = FromBits(column.previous);
+    return true;
+}
+
+bool ChunkDecoder::Next(int64_t& time, double* values) {
+    if (index >= remaining) return false;
+    if (!ReadTime(time)) return false;
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (!ReadValue(columns[i], values[i])) return false;
+    }
+    ++index;
+    return true;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Compression for a chunk of samples that share one clock, after Facebook's
+// Gorilla (Pelkonen et al., VLDB 2015): timestamps are stored as the
+// difference between consecutive deltas, values as the XOR with the previous
+// value of the same column. Regular samples of slowly changing metrics cost
+// one or two bits per field.
+class ChunkEncoder {
+public:
+    explicit ChunkEncoder(int columns);
+
+    // `values` holds one double per column. Timestamps must increase.
+    void Append(int64_t time, const double* values);
+
+    size_t Count() const { return count; }
+    const std::vector<uint8_t>& Bytes() const { return bytes; }
+
+private:
+    struct Column {
+        uint64_t previous = 0;
+        int leading = -1;  // -1 until the first XOR window is written
+        int trailing = 0;
+    };
+
+    void WriteBits(uint64_t value, int bits);
+    void WriteTime(int64_t time);
+    void WriteValue(Column& column, double value);
+
+    std::vector<uint8_t> bytes;
+    int bitsFree;
+    std::vector<Column> columns;
+    size_t count;
+    int64_t previousTime;
+    int64_t previousDelta;
+};
+
+class ChunkDecoder {
+public:
+    ChunkDecoder(const uint8_t* data, size_t size, int columns, size_t count);
+
+    // False once `count` samples were read or the data ran out.
+    bool Next(int64_t& time, double* values);
+
+private:
+    struct Column {
+        uint64_t previous = 0;
+        int leading = 0;
+        int trailing = 0;
+    };
+
+    bool ReadBits(int bits, uint64_t& value);
+    bool ReadTime(int64_t& time);
+    bool ReadValue(Column& column, double& value);
+
+    const uint8_t* data;
+    size_t sizeBits;
+    size_t position;
+    std::vector<Column> columns;
+    size_t remaining;
+    size_t index;
+    int64_t previousTime;
+    int64_t previousDelta;
+};
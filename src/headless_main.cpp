@@ -0,0 +1,201 @@
+#include "docker_commands.h"
+#include "metrics_archive.h"
+#include "metrics_exporter.h"
+#include "stats_collector.h"
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <pthread.h>
+#include <string>
+
+namespace {
+
+const char kDefaultListen[] = "127.0.0.1:9417";
+
+void PrintUsage(const char* argv0) {
+    fprintf(stderr,
+            "Usage: %s [--listen HOST:PORT] [--interval SECONDS] [--once]\n"
+            "          [--archive DIR | --no-archive] [--max-calls N]\n"
+            "       %s --query CONTAINER [--since DURATION] [--archive DIR]\n"
+            "\n"
+            "Serves Docker container, image and volume metrics in the Prometheus\n"
+            "text format on http://HOST:PORT/metrics (default %s), and records\n"
+            "container CPU and memory in the metrics archive.\n"
+            "\n"
+            "  --listen HOST:PORT   IPv4 address and port to bind\n"
+            "  --interval SECONDS   how often the cached lists are refreshed (default 5)\n"
+            "  --once               print the metrics once to stdout and exit\n"
+            "  --archive DIR        archive directory (default %s)\n"
+            "  --no-archive         do not record history\n"
+            "  --max-calls N        concurrent requests to the Docker daemon (default %zu)\n"
+            "  --query CONTAINER    print the archived CPU and memory of a container,\n"
+            "                       by name or ID, as tab-separated rows\n"
+            "  --since DURATION     how far back --query reaches: 90m, 24h, 7d (default 24h)\n",
+            argv0, argv0, kDefaultListen, MetricsArchive::DefaultDirectory().c_str(),
+            DockerCommands::GetCallStats().limit);
+}
+
+bool SplitHostPort(const std::string& value, std::string& host, int& port) {
+    size_t colon = value.rfind(':');
+    if (colon == std::string::npos) return false;
+    host = colon == 0 ? "0.0.0.0" : value.substr(0, colon);
+    port = std::atoi(value.c_str() + colon + 1);
+    return port > 0 && port < 65536;
+}
+
+// "90m", "24h", "7d" or plain seconds.
+bool ParseDuration(const std::string& value, time_t& seconds) {
+    char* end = nullptr;
+    long long n = std::strtoll(value.c_str(), &end, 10);
+    if (end == value.c_str() || n <= 0) return false;
+    switch (*end) {
+        case '\0': case 's': seconds = n; break;
+        case 'm': seconds = n * 60; break;
+        case 'h': seconds = n * 3600; break;
+        case 'd': seconds = n * 86400; break;
+        default: return false;
+    }
+    return true;
+}
+
+int RunQuery(const std::string& directory, const std::string& container, time_t since) {
+    MetricsArchive archive(directory);
+    const time_t now = std::time(nullptr);
+    const auto started = std::chrono::steady_clock::now();
+
+    ArchiveQueryResult result;
+    std::string label = container;
+    if (!archive.Query(container, now - since, now, result)) {
+        // cgroup samples carry no names; resolve the name through docker.
+        std::vector<ContainerInfo> containers;
+        DockerCommands::GetAllContainers(containers);
+        for (const auto& c : containers) {
+            if (c.name == container && archive.Query(c.id, now - since, now, result)) {
+                label = c.name + " (" + c.id + ")";
+                break;
+            }
+        }
+    }
+    const double elapsedMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - started).count();
+
+    if (result.points.empty()) {
+        fprintf(stderr, "No archived samples for %s in %s\n", container.c_str(), directory.c_str());
+        return 1;
+    }
+
+    printf("# %s: %zu points at %s resolution, queried in %.1f ms\n", label.c_str(),
+           result.points.size(), result.tier.c_str(), elapsedMs);
+    std::string summary = MetricsArchive::Describe(result, 60);
+    for (size_t start = 0; start < summary.size();) {
+        size_t end = summary.find('\n', start);
+        if (end == std::string::npos) end = summary.size();
+        printf("# %s\n", summary.substr(start, end - start).c_str());
+        start = end + 1;
+    }
+    printf("time\tcpu_avg\tcpu_max\tmemory_avg_bytes\tmemory_max_bytes\n");
+    for (const auto& p : result.points) {
+        char when[32];
+        time_t t = static_cast<time_t>(p.time);
+        struct tm tm;
+        gmtime_r(&t, &tm);
+        strftime(when, sizeof(when), "%Y-%m-%dT%H:%M:%SZ", &tm);
+        printf("%s\t%.2f\t%.2f\t%.0f\t%.0f\n", when, p.cpu, p.cpuMax, p.memory, p.memoryMax);
+    }
+    return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string listen = kDefaultListen;
+    int intervalSeconds = 5;
+    bool once = false;
+    std::string archiveDir = MetricsArchive::DefaultDirectory();
+    bool useArchive = true;
+    std::string query;
+    time_t since = 24 * 3600;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--listen" && i + 1 < argc) {
+            listen = argv[++i];
+        } else if (arg == "--interval" && i + 1 < argc) {
+            intervalSeconds = std::atoi(argv[++i]);
+        } else if (arg == "--once") {
+            once = true;
+        } else if (arg == "--archive" && i + 1 < argc) {
+            archiveDir = argv[++i];
+        } else if (arg == "--no-archive") {
+            useArchive = false;
+        } else if (arg == "--max-calls" && i + 1 < argc && std::atoi(argv[i + 1]) > 0) {
+            DockerCommands::SetMaxConcurrentCalls(std::atoi(argv[++i]));
+        } else if (arg == "--query" && i + 1 < argc) {
+            query = argv[++i];
+        } else if (arg == "--since" && i + 1 < argc && ParseDuration(argv[i + 1], since)) {
+            ++i;
+        } else {
+            PrintUsage(argv[0]);
+            return arg == "--help" || arg == "-h" ? 0 : 2;
+        }
+    }
+
+    if (!query.empty()) return RunQuery(archiveDir, query, since);
+
+    std::string host;
+    int port = 0;
+    if (!once && !SplitHostPort(listen, host, port)) {
+        fprintf(stderr, "Invalid --listen value: %s\n", listen.c_str());
+        return 2;
+    }
+    if (intervalSeconds <= 0) intervalSeconds = 5;
+
+    // Block the shutdown signals before any thread starts so that only
+    // sigwait() below sees them.
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    // Declared first so it outlives the collector that appends to it.
+    MetricsArchive archive(archiveDir);
+    std::string error;
+    if (!once && useArchive) {
+        if (archive.Open(&error)) {
+            StatsCollector::Instance().SetArchive(&archive);
+        } else {
+            fprintf(stderr, "Metrics archive disabled: %s\n", error.c_str());
+        }
+    }
+
+    MetricsExporter exporter(intervalSeconds * 1000);
+    exporter.Start();
+
+    if (once) {
+        if (!exporter.WaitForData(10000)) {
+            fprintf(stderr, "Timed out waiting for Docker data; output may be incomplete\n");
+        }
+        fputs(exporter.Render().c_str(), stdout);
+        exporter.Stop();
+        return 0;
+    }
+
+    if (!exporter.Listen(host, port, &error)) {
+        fprintf(stderr, "Cannot listen on %s: %s\n", listen.c_str(), error.c_str());
+        exporter.Stop();
+        StatsCollector::Instance().SetArchive(nullptr);
+        return 1;
+    }
+    fprintf(stderr, "Serving metrics on http://%s/metrics\n", listen.c_str());
+
+    int sig = 0;
+    sigwait(&signals, &sig);
+    exporter.Stop();
+    StatsCollector::Instance().SetArchive(nullptr);
+    archive.Close();
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include "inspect_cache.h"
+#include <iterator>
+
+const size_t InspectCache::kDefaultMaxEntries;
+const size_t InspectCache::kDefaultMaxBytes;
+
+InspectCache::InspectCache(size_t maxEntries, size_t maxBytes)
+    : maxEntries(maxEntries), maxBytes(maxBytes), bytes(0) {}
+
+size_t InspectCache::SizeOf(const ContainerDetails& details) {
+    // Heap blocks are counted by capacity; short strings cost nothing extra.
+    auto text = [](const std::string& s) { return s.capacity() + 1; };
+    size_t size = sizeof(details) + text(details.id) + text(details.name) +
+                  text(details.image) + text(details.startedAt) +
+                  text(details.restartPolicy) + text(details.health);
+    size += details.ports.capacity() * sizeof(std::string);
+    for (const auto& port : details.ports) size += text(port);
+    size += details.mounts.capacity() * sizeof(ContainerDetails::Mount);
+    for (const auto& mount : details.mounts) {
+        size += text(mount.type) + text(mount.source) + text(mount.destination);
+    }
+    size += details.env.capacity() * sizeof(std::string);
+    for (const auto& variable : details.env) size += text(variable);
+    return size;
+}
+
+InspectCache::DetailsPtr InspectCache::Get(const std::string& id, ContainerState state) {
+    auto found = byId.find(id);
+    if (found == byId.end()) return DetailsPtr();
+    EntryIt it = found->second;
+    if (it->state != state) {
+        Erase(it);
+        return DetailsPtr();
+    }
+    entries.splice(entries.begin(), entries, it);
+    return it->details;
+}
+
+void InspectCache::Put(const std::string& id, ContainerState state, DetailsPtr details) {
+    auto found = byId.find(id);
+    if (found != byId.end()) Erase(found->second);
+    if (!details) return;
+    const size_t size = SizeOf(*details) + sizeof(Entry) + 2 * id.size();
+    if (size > maxBytes || maxEntries == 0) return;
+
+    entries.push_front(Entry{id, state, std::move(details), size, false});
+    byId[id] = entries.begin();
+    bytes += size;
+    while (entries.size() > maxEntries || bytes > maxBytes) Erase(std::prev(entries.end()));
+}
+
+void InspectCache::Retain(const ContainerTable& containers) {
+    if (entries.empty()) return;
+    for (Entry& entry : entries) entry.seen = false;
+    for (const ContainerRow& row : containers) {
+        // Short IDs fit std::string's inline buffer; no allocation here.
+        auto found = byId.find(row.id.str());
+        if (found != byId.end() && found->second->state == row.state) found->second->seen = true;
+    }
+    for (EntryIt it = entries.begin(); it != entries.end();) {
+        EntryIt next = std::next(it);
+        if (!it->seen) Erase(it);
+        it = next;
+    }
+}
+
+void InspectCache::Clear() {
+    entries.clear();
+    byId.clear();
+    bytes = 0;
+}
+
+void InspectCache::Erase(EntryIt it) {
+    bytes -= it->bytes;
+    byId.erase(it->id);
+    entries.erase(it);
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "docker_commands.h"
+#include "resource_snapshot.h"
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+// Recently inspected containers, bounded by entry count and by an estimate
+// of the bytes they hold; the least recently used go first. An entry stays
+// valid for as long as its container keeps the ID and state it was
+// inspected in, and Retain() drops it as soon as a snapshot says otherwise.
+// Used from one thread.
+class InspectCache {
+public:
+    static const size_t kDefaultMaxEntries = 256;
+    static const size_t kDefaultMaxBytes = 4 << 20;
+
+    typedef std::shared_ptr<const ContainerDetails> DetailsPtr;
+
+    explicit InspectCache(size_t maxEntries = kDefaultMaxEntries,
+                          size_t maxBytes = kDefaultMaxBytes);
+
+    // Null unless held for this container in this state. A hit becomes the
+    // most recently used entry.
+    DetailsPtr Get(const std::string& id, ContainerState state);
+    // Details larger than the whole budget are not kept.
+    void Put(const std::string& id, ContainerState state, DetailsPtr details);
+    // Drops the entries of containers that are gone or changed state.
+    void Retain(const ContainerTable& containers);
+    void Clear();
+
+    size_t Size() const { return entries.size(); }
+    size_t Bytes() const { return bytes; }
+
+private:
+    struct Entry {
+        std::string id;
+        ContainerState state;
+        DetailsPtr details;
+        size_t bytes;
+        bool seen;  // scratch for Retain()
+    };
+    typedef std::list<Entry>::iterator EntryIt;
+
+    size_t maxEntries;
+    size_t maxBytes;
+    size_t bytes;
+    std::list<Entry> entries;  // most recently used first
+    std::unordered_map<std::string, EntryIt> byId;
+
+    void Erase(EntryIt it);
+    static size_t SizeOf(const ContainerDetails& details);
+};
@@ -0,0 +1,148 @@
+#include "job_queue.h"
+
+namespace {
+
+// Finished jobs kept around for the jobs panel.
+const size_t kMaxFinishedJobs = 100;
+
+}  // namespace
+
+bool JobContext::IsCancelled() const {
+    return queue->IsCancelled(id);
+}
+
+void JobContext::SetProgress(int done, int total) {
+    queue->Update(id, [done, total](JobStatus& s) {
+        s.done = done;
+        s.total = total;
+    });
+}
+
+void JobContext::SetMessage(const std::string& message) {
+    queue->Update(id, [&message](JobStatus& s) { s.message = message; });
+}
+
+JobQueue::JobQueue(WorkerPool& pool, UpdateCallback onUpdate)
+    : pool(pool), onUpdate(onUpdate), nextId(1) {}
+
+uint64_t JobQueue::Submit(const std::string& title, JobFunction function) {
+    auto job = std::make_shared<Job>();
+    job->status.title = title;
+    job->function = std::move(function);
+
+    JobStatus snapshot;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job->status.id = nextId++;
+        jobs[job->status.id] = job;
+        TrimFinished();
+        snapshot = job->status;
+    }
+    if (onUpdate) onUpdate(snapshot);
+
+    if (!pool.Submit([this, job] { Execute(job); }, WorkerPool::Interactive)) {
+        Update(snapshot.id, [](JobStatus& s) {
+            s.state = JobStatus::Cancelled;
+            s.message = "Shutting down";
+        });
+    }
+    return snapshot.id;
+}
+
+bool JobQueue::Cancel(uint64_t id) {
+    JobStatus snapshot;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = jobs.find(id);
+        if (it == jobs.end() || it->second->status.IsFinished()) return false;
+
+        Job& job = *it->second;
+        job.cancelRequested = true;
+        if (job.status.state == JobStatus::Queued) {
+            job.status.state = JobStatus::Cancelled;
+        } else {
+            job.status.message = "Cancelling...";
+        }
+        snapshot = job.status;
+    }
+    if (onUpdate) onUpdate(snapshot);
+    return true;
+}
+
+std::vector<JobStatus> JobQueue::GetJobs() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<JobStatus> out;
+    out.reserve(jobs.size());
+    for (const auto& kv : jobs) out.push_back(kv.second->status);
+    return out;
+}
+
+void JobQueue::ClearFinished() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = jobs.begin(); it != jobs.end();) {
+        if (it->second->status.IsFinished()) {
+            it = jobs.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void JobQueue::Execute(const std::shared_ptr<Job>& job) {
+    const uint64_t id = job->status.id;
+    JobStatus snapshot;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        // Cancelled while it was waiting in the pool.
+        if (job->status.state != JobStatus::Queued) return;
+        job->status.state = JobStatus::Running;
+        snapshot = job->status;
+    }
+    if (onUpdate) onUpdate(snapshot);
+
+    JobContext context(this, id);
+    bool ok = job->function(context);
+
+    const bool cancelled = job->cancelRequested;
+    Update(id, [ok, cancelled](JobStatus& s) {
+        if (cancelled) {
+            s.state = JobStatus::Cancelled;
+            s.message = "Cancelled";
+        } else {
+            s.state = ok ? JobStatus::Succeeded : JobStatus::Failed;
+        }
+    });
+}
+
+void JobQueue::Update(uint64_t id, const std::function<void(JobStatus&)>& change) {
+    JobStatus snapshot;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = jobs.find(id);
+        if (it == jobs.end()) return;
+        change(it->second->status);
+        snapshot = it->second->status;
+    }
+    if (onUpdate) onUpdate(snapshot);
+}
+
+bool JobQueue::IsCancelled(uint64_t id) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = jobs.find(id);
+    return it == jobs.end() || it->second->cancelRequested;
+}
+
+void JobQueue::TrimFinished() {
+    size_t finished = 0;
+    for (const auto& kv : jobs) {
+        if (kv.second->status.IsFinished()) ++finished;
+    }
+    for (auto it = jobs.begin(); it != jobs.end() && finished > kMaxFinishedJobs;) {
+        if (it->second->status.IsFinished()) {
+            it = jobs.erase(it);
+            --finished;
+        } else {
+            ++it;
+        }
+    }
+}
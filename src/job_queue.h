@@ -0,0 +1,83 @@
+#pragma once
+
+#include "worker_pool.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct JobStatus {
+    enum State { Queued, Running, Succeeded, Failed, Cancelled };
+
+    uint64_t id = 0;
+    std::string title;
+    State state = Queued;
+    int done = 0;
+    int total = 0;        // 0 while the amount of work is unknown
+    std::string message;
+
+    bool IsFinished() const { return state >= Succeeded; }
+};
+
+class JobQueue;
+
+// Handed to a running job so it can report progress and notice Cancel().
+class JobContext {
+public:
+    bool IsCancelled() const;
+    void SetProgress(int done, int total);
+    void SetMessage(const std::string& message);
+
+private:
+    friend class JobQueue;
+    JobContext(JobQueue* queue, uint64_t id) : queue(queue), id(id) {}
+
+    JobQueue* queue;
+    uint64_t id;
+};
+
+// Long-running docker operations (stop, remove, prune) run here instead of
+// on the GUI thread. Every state or progress change is reported through the
+// update callback, which is invoked on whichever thread made the change.
+class JobQueue {
+public:
+    // Returns false when the job failed; SetMessage() explains why.
+    typedef std::function<bool(JobContext&)> JobFunction;
+    typedef std::function<void(const JobStatus&)> UpdateCallback;
+
+    JobQueue(WorkerPool& pool, UpdateCallback onUpdate);
+
+    uint64_t Submit(const std::string& title, JobFunction function);
+
+    // A queued job is dropped at once; a running one is asked to stop and
+    // ends as Cancelled when it next checks IsCancelled().
+    bool Cancel(uint64_t id);
+
+    // Oldest first.
+    std::vector<JobStatus> GetJobs() const;
+    void ClearFinished();
+
+private:
+    friend class JobContext;
+
+    struct Job {
+        JobStatus status;
+        JobFunction function;
+        std::atomic<bool> cancelRequested{false};
+    };
+
+    void Execute(const std::shared_ptr<Job>& job);
+    void Update(uint64_t id, const std::function<void(JobStatus&)>& change);
+    bool IsCancelled(uint64_t id) const;
+    void TrimFinished();
+
+    WorkerPool& pool;
+    UpdateCallback onUpdate;
+    mutable std::mutex mutex;
+    std::map<uint64_t, std::shared_ptr<Job>> jobs;
+    uint64_t nextId;
+};
@@ -0,0 +1,295 @@
+#include "json_reader.h"
+#include <cstdlib>
+#include <cstring>
+
+JsonReader::JsonReader(const char* data, size_t size)
+    : cur(data), end(data + size), failed(false) {}
+
+JsonReader::JsonReader(const std::string& text)
+    : JsonReader(text.data(), text.size()) {}
+
+void JsonReader::SkipWhitespace() {
+    while (cur < end && (*cur == ' ' || *cur == '\n' || *cur == '\r' || *cur == '\t')) {
+        ++cur;
+    }
+}
+
+bool JsonReader::Fail() {
+    failed = true;
+    cur = end;
+    return false;
+}
+
+bool JsonReader::Expect(char c) {
+    SkipWhitespace();
+    if (cur >= end || *cur != c) return Fail();
+    ++cur;
+    return true;
+}
+
+JsonReader::Type JsonReader::Peek() {
+    SkipWhitespace();
+    if (failed) return Type::Invalid;
+    if (cur >= end) return Type::End;
+    switch (*cur) {
+        case '{': return Type::Object;
+        case '[': return Type::Array;
+        case '"': return Type::String;
+        case 't':
+        case 'f': return Type::Bool;
+        case 'n': return Type::Null;
+        default:
+            if (*cur == '-' || (*cur >= '0' && *cur <= '9')) return Type::Number;
+            return Type::Invalid;
+    }
+}
+
+bool JsonReader::BeginObject() {
+    return Expect('{');
+}
+
+bool JsonReader::NextKey(std::string& key) {
+    SkipWhitespace();
+    if (cur >= end) return Fail();
+    if (*cur == '}') {
+        ++cur;
+        return false;
+    }
+    if (*cur == ',') {
+        ++cur;
+        SkipWhitespace();
+    }
+    if (!ReadString(key)) return false;
+    return Expect(':');
+}
+
+bool JsonReader::BeginArray() {
+    return Expect('[');
+}
+
+bool JsonReader::NextElement() {
+    SkipWhitespace();
+    if (cur >= end) return Fail();
+    if (*cur == ']') {
+        ++cur;
+        return false;
+    }
+    if (*cur == ',') ++cur;
+    return true;
+}
+
+static void AppendUtf8(std::string& out, unsigned long cp) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+static bool ParseHex4(const char* p, unsigned long& out) {
+    out = 0;
+    for (int i = 0; i < 4; ++i) {
+        char c = p[i];
+        out <<= 4;
+        if (c >= '0' && c <= '9') out |= c - '0';
+        else if (c >= 'a' && c <= 'f') out |= c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') out |= c - 'A' + 10;
+        else return false;
+    }
+    return true;
+}
+
+bool JsonReader::ReadString(std::string& out) {
+    SkipWhitespace();
+    if (cur >= end || *cur != '"') return Fail();
+    ++cur;
+    out.clear();
+
+    while (cur < end) {
+        // Copy the unescaped run in one go.
+        const char* run = cur;
+        while (cur < end && *cur != '"' && *cur != '\\') ++cur;
+        out.append(run, cur - run);
+        if (cur >= end) break;
+        if (*cur == '"') {
+            ++cur;
+            return true;
+        }
+
+        ++cur;  // backslash
+        if (cur >= end) break;
+        char esc = *cur++;
+        switch (esc) {
+            case '"':  out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/':  out += '/'; break;
+            case 'b':  out += '\b'; break;
+            case 'f':  out += '\f'; break;
+            case 'n':  out += '\n'; break;
+            case 'r':  out += '\r'; break;
+            case 't':  out += '\t'; break;
+            case 'u': {
+                unsigned long cp;
+                if (end - cur < 4 || !ParseHex4(cur, cp)) return Fail();
+                cur += 4;
+                if (cp >= 0xD800 && cp <= 0xDBFF && end - cur >= 6 &&
+                    cur[0] == '\\' && cur[1] == 'u') {
+                    unsigned long low;
+                    if (ParseHex4(cur + 2, low) && low >= 0xDC00 && low <= 0xDFFF) {
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                        cur += 6;
+                    }
+                }
+                AppendUtf8(out, cp);
+                break;
+            }
+            default:
+                return Fail();
+        }
+    }
+    return Fail();
+}
+
+bool JsonReader::ReadNumber(double& out) {
+    SkipWhitespace();
+    const char* start = cur;
+    while (cur < end && ((*cur >= '0' && *cur <= '9') || *cur == '-' || *cur == '+' ||
+                         *cur == '.' || *cur == 'e' || *cur == 'E')) {
+        ++cur;
+    }
+    if (cur == start) return Fail();
+    std::string text(start, cur - start);
+    char* stop = nullptr;
+    out = std::strtod(text.c_str(), &stop);
+    if (!stop || *stop != '\0') return Fail();
+    return true;
+}
+
+bool JsonReader::ReadInt64(int64_t& out) {
+    SkipWhitespace();
+    const char* start = cur;
+    bool negative = false;
+    if (cur < end && *cur == '-') {
+        negative = true;
+        ++cur;
+    }
+    const char* digits = cur;
+    uint64_t value = 0;
+    while (cur < end && *cur >= '0' && *cur <= '9') {
+        value = value * 10 + static_cast<uint64_t>(*cur - '0');
+        ++cur;
+    }
+    if (cur == digits) return Fail();
+    if (cur < end && (*cur == '.' || *cur == 'e' || *cur == 'E')) {
+        // Not an integer literal; fall back to the floating point path.
+        cur = start;
+        double d;
+        if (!ReadNumber(d)) return false;
+        out = static_cast<int64_t>(d);
+        return true;
+    }
+    out = negative ? -static_cast<int64_t>(value) : static_cast<int64_t>(value);
+    return true;
+}
+
+bool JsonReader::ReadBool(bool& out) {
+    SkipWhitespace();
+    if (end - cur >= 4 && std::memcmp(cur, "true", 4) == 0) {
+        cur += 4;
+        out = true;
+        return true;
+    }
+    if (end - cur >= 5 && std::memcmp(cur, "false", 5) == 0) {
+        cur += 5;
+        out = false;
+        return true;
+    }
+    return Fail();
+}
+
+bool JsonReader::ReadScalarAsString(std::string& out) {
+    Type type = Peek();
+    if (type == Type::String) return ReadString(out);
+    if (type == Type::Object || type == Type::Array || type == Type::End ||
+        type == Type::Invalid) {
+        return Fail();
+    }
+    const char* start = cur;
+    if (type == Type::Number) {
+        double ignored;
+        if (!ReadNumber(ignored)) return false;
+    } else if (!SkipLiteral()) {
+        return false;
+    }
+    out.assign(start, cur - start);
+    return true;
+}
+
+bool JsonReader::SkipString() {
+    ++cur;  // opening quote
+    while (cur < end) {
+        const void* hit = std::memchr(cur, '"', end - cur);
+        if (!hit) break;
+        const char* quote = static_cast<const char*>(hit);
+        // Count preceding backslashes to tell an escaped quote from a real one.
+        const char* back = quote;
+        while (back > cur && back[-1] == '\\') --back;
+        cur = quote + 1;
+        if (((quote - back) & 1) == 0) return true;
+    }
+    return Fail();
+}
+
+bool JsonReader::SkipLiteral() {
+    static const char* literals[] = {"true", "false", "null"};
+    for (const char* lit : literals) {
+        size_t len = std::strlen(lit);
+        if (static_cast<size_t>(end - cur) >= len && std::memcmp(cur, lit, len) == 0) {
+            cur += len;
+            return true;
+        }
+    }
+    return Fail();
+}
+
+bool JsonReader::Skip() {
+    switch (Peek()) {
+        case Type::String:
+            return SkipString();
+        case Type::Number: {
+            double ignored;
+            return ReadNumber(ignored);
+        }
+        case Type::Bool:
+        case Type::Null:
+            return SkipLiteral();
+        case Type::Object:
+        case Type::Array: {
+            // Scan brackets directly instead of recursing through NextKey.
+            int depth = 0;
+            while (cur < end) {
+                char c = *cur;
+                if (c == '"') {
+                    if (!SkipString()) return false;
+                    continue;
+                }
+                ++cur;
+                if (c == '{' || c == '[') ++depth;
+                else if ((c == '}' || c == ']') && --depth == 0) return true;
+            }
+            return Fail();
+        }
+        default:
+            return Fail();
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Pull-style JSON reader. Walks the buffer in place and lets the caller pick
+// out the fields it cares about without building a document tree; anything
+// not asked for is skipped.
+class JsonReader {
+public:
+    enum class Type { Null, Bool, Number, String, Array, Object, End, Invalid };
+
+    JsonReader(const char* data, size_t size);
+    explicit JsonReader(const std::string& text);
+
+    Type Peek();
+
+    bool BeginObject();
+    // Reads the next member name of the current object. Returns false (and
+    // consumes the closing brace) when the object is exhausted.
+    bool NextKey(std::string& key);
+
+    bool BeginArray();
+    // Returns false (and consumes the closing bracket) when the array is
+    // exhausted; otherwise the next value is ready to be read.
+    bool NextElement();
+
+    bool ReadString(std::string& out);
+    bool ReadNumber(double& out);
+    bool ReadInt64(int64_t& out);
+    bool ReadBool(bool& out);
+    // Strings come back as-is, numbers/bools/null as their literal text.
+    bool ReadScalarAsString(std::string& out);
+    bool Skip();
+
+    bool Failed() const { return failed; }
+
+private:
+    const char* cur;
+    const char* end;
+    bool failed;
+
+    void SkipWhitespace();
+    bool Fail();
+    bool Expect(char c);
+    bool SkipString();
+    bool SkipLiteral();
+};
@@ -0,0 +1,148 @@
+#include "layer_analyzer.h"
+#include "string_arena.h"
+#include <algorithm>
+
+LayerAnalyzer::LayerAnalyzer(Loader loader, size_t concurrency)
+    : loader(std::move(loader)), concurrency(concurrency), totalBytes(0) {}
+
+bool LayerAnalyzer::Update(const std::vector<std::string>& ids) {
+    std::unordered_set<std::string> wanted(ids.begin(), ids.end());
+    std::vector<std::string> missing;
+    bool changed = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = images.begin(); it != images.end();) {
+            if (wanted.count(it->first)) {
+                ++it;
+                continue;
+            }
+            Remove(it->second);
+            it = images.erase(it);
+            changed = true;
+        }
+        for (const auto& id : wanted) {
+            if (!images.count(id)) missing.push_back(id);
+        }
+        listed = wanted;
+    }
+    if (missing.empty()) return changed;
+
+    // Each load writes only its own slot, so the loads need no lock.
+    std::unordered_map<std::string, size_t> slots;
+    for (size_t i = 0; i < missing.size(); ++i) slots[missing[i]] = i;
+    std::vector<std::vector<ImageLayer>> loaded(missing.size());
+    BulkExecutor executor(concurrency);
+    std::vector<BulkItemResult> results = executor.Run(
+        missing, [this, &slots, &loaded](const std::string& id, std::string* error) {
+            if (loader(id, loaded[slots.at(id)])) return true;
+            if (error) *error = "cannot read layers";
+            return false;
+        });
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t i = 0; i < results.size(); ++i) {
+        // A newer Update() may have dropped the image or loaded it already.
+        const std::string& id = missing[i];
+        if (!results[i].success || !listed.count(id) || images.count(id)) continue;
+        Add(id, loaded[i]);
+        changed = true;
+    }
+    return changed;
+}
+
+void LayerAnalyzer::Add(const std::string& id, const std::vector<ImageLayer>& loaded) {
+    std::vector<uint64_t>& keys = images[id];
+    keys.reserve(loaded.size());
+    uint64_t chain = 0;
+    for (const auto& layer : loaded) {
+        chain = HashString(chain, layer.diffId);
+        keys.push_back(chain);
+        auto inserted = layers.insert({chain, Layer{layer.size, 0}});
+        if (inserted.second) totalBytes += layer.size;
+        ++inserted.first->second.refs;
+    }
+}
+
+void LayerAnalyzer::Remove(const std::vector<uint64_t>& keys) {
+    for (uint64_t key : keys) {
+        auto it = layers.find(key);
+        if (it == layers.end() || --it->second.refs > 0) continue;
+        totalBytes -= it->second.size;
+        layers.erase(it);
+    }
+}
+
+LayerUsage LayerAnalyzer::UsageOf(const std::vector<uint64_t>& keys) const {
+    LayerUsage usage;
+    for (uint64_t key : keys) {
+        const Layer& layer = layers.at(key);
+        usage.total += layer.size;
+        if (layer.refs == 1) {
+            usage.unique += layer.size;
+        } else {
+            usage.shared += layer.size;
+        }
+    }
+    usage.reclaimable = usage.unique;
+    return usage;
+}
+
+bool LayerAnalyzer::GetUsage(const std::string& id, LayerUsage& usage) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = images.find(id);
+    if (it == images.end()) return false;
+    usage = UsageOf(it->second);
+    return true;
+}
+
+std::unordered_map<std::string, LayerUsage> LayerAnalyzer::GetAllUsage() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unordered_map<std::string, LayerUsage> all;
+    all.reserve(images.size());
+    for (const auto& image : images) all[image.first] = UsageOf(image.second);
+    return all;
+}
+
+LayerUsage LayerAnalyzer::GetSelectionUsage(const std::vector<std::string>& ids,
+                                             size_t* unknown) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    // Layers of the selection, with how many selected images use each; a
+    // layer is freed when that is all of its users.
+    std::unordered_map<uint64_t, uint32_t> selected;
+    std::unordered_set<std::string> seen;
+    if (unknown) *unknown = 0;
+    for (const auto& id : ids) {
+        if (!seen.insert(id).second) continue;
+        auto it = images.find(id);
+        if (it == images.end()) {
+            if (unknown) ++*unknown;
+            continue;
+        }
+        for (uint64_t key : it->second) ++selected[key];
+    }
+
+    LayerUsage usage;
+    for (const auto& entry : selected) {
+        const Layer& layer = layers.at(entry.first);
+        usage.total += layer.size;
+        if (layer.refs == 1) usage.unique += layer.size;
+        if (entry.second < layer.refs) usage.shared += layer.size;
+    }
+    usage.reclaimable = usage.total - usage.shared;
+    return usage;
+}
+
+int64_t LayerAnalyzer::TotalBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return totalBytes;
+}
+
+size_t LayerAnalyzer::ImageCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return images.size();
+}
+
+size_t LayerAnalyzer::LayerCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return layers.size();
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "bulk_executor.h"
+#include "docker_commands.h"
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Disk use of an image, or of several taken together. Each layer counts
+// once, however many of the images contain it.
+struct LayerUsage {
+    int64_t total = 0;        // all layers of the image(s)
+    int64_t unique = 0;       // layers no other image has
+    int64_t shared = 0;       // layers also used by images outside the set
+    int64_t reclaimable = 0;  // freed by removing the image(s): total - shared
+};
+
+// Which images share which layers, from each image's RootFS. The size
+// `docker images` reports counts a shared base layer once per image that
+// uses it; this index counts it once, so it can say what removing an image
+// (or a selection) would actually free.
+//
+// Layers are identified the way the daemon stores them: by the whole chain
+// of diff IDs up to and including the layer, since the same diff on top of
+// different parents is stored twice. Layers of an image are loaded once
+// and kept by image ID, so Update() only loads images it has not seen.
+//
+// Thread-safe; Update() does its loading without holding the lock.
+class LayerAnalyzer {
+public:
+    typedef std::function<bool(const std::string& id, std::vector<ImageLayer>& layers)> Loader;
+
+    explicit LayerAnalyzer(Loader loader = DockerCommands::GetImageLayers,
+                           size_t concurrency = BulkExecutor::kDefaultConcurrency);
+
+    // Makes the index hold exactly `ids` (duplicates allowed): forgets
+    // images no longer listed and loads new ones, `concurrency` at a time.
+    // Images that fail to load are left out and retried next time. Returns
+    // whether the index changed.
+    bool Update(const std::vector<std::string>& ids);
+
+    // False if the image is not in the index.
+    bool GetUsage(const std::string& id, LayerUsage& usage) const;
+    std::unordered_map<std::string, LayerUsage> GetAllUsage() const;
+    // Images not in the index are ignored; `unknown` receives how many.
+    LayerUsage GetSelectionUsage(const std::vector<std::string>& ids,
+                                 size_t* unknown = nullptr) const;
+
+    // Bytes of every distinct layer: what the images really take on disk.
+    int64_t TotalBytes() const;
+    size_t ImageCount() const;
+    size_t LayerCount() const;
+
+private:
+    struct Layer {
+        int64_t size;
+        uint32_t refs;  // images containing it
+    };
+
+    Loader loader;
+    size_t concurrency;
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, std::vector<uint64_t>> images;  // chain keys, base first
+    std::unordered_map<uint64_t, Layer> layers;
+    std::unordered_set<std::string> listed;  // ids of the latest Update()
+    int64_t totalBytes;
+
+    void Add(const std::string& id, const std::vector<ImageLayer>& loaded);
+    void Remove(const std::vector<uint64_t>& keys);
+    LayerUsage UsageOf(const std::vector<uint64_t>& keys) const;
+};
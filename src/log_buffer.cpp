@@ -0,0 +1,279 @@
+#include "log_buffer.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <regex>
+#include <sys/mman.h>
+#include <unistd.h>
+
+const size_t LogBuffer::kDefaultCapacity;
+const size_t LogBuffer::kMaxLineBytes;
+const size_t LogBuffer::kMaxMatches;
+
+namespace {
+
+// Lines scanned per turn of the lock during a search.
+const uint64_t kSearchBatchLines = 16384;
+
+// Maps `size` bytes twice in a row, both views of the same pages.
+char* MapMirrored(size_t size) {
+    int fd = memfd_create("docker-manager-log", MFD_CLOEXEC);
+    if (fd < 0) return nullptr;
+    char* base = nullptr;
+    if (ftruncate(fd, static_cast<off_t>(size)) == 0) {
+        void* reserved = mmap(nullptr, 2 * size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (reserved != MAP_FAILED) {
+            base = static_cast<char*>(reserved);
+            if (mmap(base, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) ==
+                    MAP_FAILED ||
+                mmap(base + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) ==
+                    MAP_FAILED) {
+                munmap(base, 2 * size);
+                base = nullptr;
+            }
+        }
+    }
+    close(fd);
+    return base;
+}
+
+// First occurrence of `lower` (already lower case) in [p, end), ignoring
+// ASCII case. memchr finds the candidates for either case of its first byte.
+const char* FindCaseless(const char* p, const char* end, const std::string& lower) {
+    const size_t n = lower.size();
+    const char lo = lower[0];
+    const char up = static_cast<char>(std::toupper(static_cast<unsigned char>(lo)));
+    while (static_cast<size_t>(end - p) >= n) {
+        const char* limit = end - n + 1;
+        const char* a = static_cast<const char*>(std::memchr(p, lo, limit - p));
+        const char* b = up == lo ? nullptr
+            : static_cast<const char*>(std::memchr(p, up, (a ? a : limit) - p));
+        const char* c = b ? b : a;
+        if (!c) return nullptr;
+        size_t i = 1;
+        while (i < n && std::tolower(static_cast<unsigned char>(c[i])) == lower[i]) ++i;
+        if (i == n) return c;
+        p = c + 1;
+    }
+    return nullptr;
+}
+
+// Longest run of plain characters every match of `pattern` contains, or
+// "" if there is none to rely on. Only looks outside groups and classes,
+// and gives up on alternation.
+std::string RequiredLiteral(const std::string& pattern) {
+    if (pattern.find('|') != std::string::npos) return std::string();
+    std::string best;
+    std::string run;
+    auto endRun = [&best, &run]() {
+        if (run.size() > best.size()) best = run;
+        run.clear();
+    };
+    int depth = 0;
+    for (size_t i = 0; i < pattern.size(); ++i) {
+        const char c = pattern[i];
+        if (c == '\\') {
+            endRun();
+            ++i;
+        } else if (c == '[') {
+            endRun();
+            // "[]" and "[^]" hold a literal ']' as their first member.
+            size_t close = i + 1;
+            if (close < pattern.size() && pattern[close] == '^') ++close;
+            if (close < pattern.size() && pattern[close] == ']') ++close;
+            close = pattern.find(']', close);
+            if (close == std::string::npos) return std::string();
+            i = close;
+        } else if (c == '(' || c == ')') {
+            endRun();
+            depth += c == '(' ? 1 : -1;
+        } else if (c == '?' || c == '*' || c == '+' || c == '{') {
+            // The quantified character may be absent or repeated.
+            if (!run.empty()) run.pop_back();
+            endRun();
+            if (c == '{') i = std::min(pattern.find('}', i), pattern.size());
+        } else if (std::strchr(".^$", c)) {
+            endRun();
+        } else if (depth == 0) {
+            run += c;
+        }
+    }
+    endRun();
+    return best;
+}
+
+}  // namespace
+
+LogBuffer::LogBuffer(size_t requested)
+    : data(nullptr), capacity(0), written(0), lineStart(0), firstLine(0) {
+    // Room for a few of the longest lines; under 2 GiB so that 32-bit
+    // offsets stay unambiguous.
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t size = std::min<size_t>(std::max(requested, 4 * kMaxLineBytes), size_t(1) << 30);
+    size = (size + page - 1) / page * page;
+    data = MapMirrored(size);
+    if (data) capacity = size;
+}
+
+LogBuffer::~LogBuffer() {
+    if (data) munmap(data, 2 * capacity);
+}
+
+uint64_t LogBuffer::StartOf(size_t index) const {
+    return written - static_cast<uint32_t>(static_cast<uint32_t>(written) - starts[index]);
+}
+
+uint64_t LogBuffer::EndOf(size_t index) const {
+    return index + 1 < starts.size() ? StartOf(index + 1) : lineStart;
+}
+
+void LogBuffer::Append(const char* bytes, size_t size) {
+    if (!data) return;
+    std::lock_guard<std::mutex> lock(mutex);
+    // Half the ring at a time, so the partial line is never overwritten
+    // before it is indexed.
+    while (size > 0) {
+        const size_t n = std::min(size, capacity / 2);
+        // The second mapping takes whatever runs past the end.
+        std::memcpy(data + written % capacity, bytes, n);
+        const uint64_t from = written;
+        written += n;
+        Index(from);
+        Trim();
+        bytes += n;
+        size -= n;
+    }
+}
+
+void LogBuffer::Index(uint64_t pos) {
+    while (pos < written) {
+        const uint64_t limit = std::min<uint64_t>(written, lineStart + kMaxLineBytes);
+        if (pos >= limit) {
+            starts.push_back(static_cast<uint32_t>(lineStart));
+            lineStart = pos;
+            continue;
+        }
+        const char* p = At(pos);
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', limit - pos));
+        if (!nl) {
+            pos = limit;
+            continue;
+        }
+        pos += nl - p + 1;
+        starts.push_back(static_cast<uint32_t>(lineStart));
+        lineStart = pos;
+    }
+}
+
+void LogBuffer::Trim() {
+    if (written <= capacity) return;
+    const uint64_t head = written - capacity;
+    while (!starts.empty() && StartOf(0) < head) {
+        starts.pop_front();
+        ++firstLine;
+    }
+}
+
+uint64_t LogBuffer::FirstLine() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return firstLine;
+}
+
+uint64_t LogBuffer::EndLine() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return firstLine + starts.size();
+}
+
+bool LogBuffer::GetLine(uint64_t line, std::string& text) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (line < firstLine || line - firstLine >= starts.size()) return false;
+    const size_t index = static_cast<size_t>(line - firstLine);
+    const uint64_t start = StartOf(index);
+    uint64_t end = EndOf(index);
+    if (end > start && *At(end - 1) == '\n') --end;
+    if (end > start && *At(end - 1) == '\r') --end;
+    text.assign(At(start), static_cast<size_t>(end - start));
+    return true;
+}
+
+size_t LogBuffer::BytesHeld() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return static_cast<size_t>(std::min<uint64_t>(written, capacity));
+}
+
+size_t LogBuffer::IndexBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return starts.size() * sizeof(uint32_t);
+}
+
+bool LogBuffer::Search(const Query& query, std::vector<uint64_t>& matches,
+                       const std::atomic<bool>* cancel) const {
+    matches.clear();
+    if (query.pattern.empty()) return false;
+
+    // Lines are found by their literal text with memmem (or memchr when
+    // ignoring case); a regex only runs on lines holding the text it needs.
+    std::regex regex;
+    std::string literal = query.pattern;
+    if (query.regex) {
+        auto flags = std::regex::ECMAScript | std::regex::optimize;
+        if (query.ignoreCase) flags |= std::regex::icase;
+        try {
+            regex.assign(query.pattern, flags);
+        } catch (const std::regex_error&) {
+            return false;
+        }
+        literal = RequiredLiteral(query.pattern);
+    }
+    if (query.ignoreCase) {
+        for (char& c : literal) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+
+    // Lines appended after the search starts are left for the next one.
+    const uint64_t last = EndLine();
+    uint64_t next = 0;
+    while (next < last && matches.size() < kMaxMatches && !(cancel && *cancel)) {
+        std::lock_guard<std::mutex> lock(mutex);
+        next = std::max(next, firstLine);
+        const uint64_t batchEnd = std::min(last, next + kSearchBatchLines);
+        if (next >= batchEnd) break;
+        size_t index = static_cast<size_t>(next - firstLine);
+        const size_t endIndex = static_cast<size_t>(batchEnd - firstLine);
+        next = batchEnd;
+
+        auto matchesRegex = [this, &regex](size_t line) {
+            const char* begin = At(StartOf(line));
+            const char* end = begin + (EndOf(line) - StartOf(line));
+            // Without the line break, so that `$` matches the end of the line.
+            if (end > begin && end[-1] == '\n') --end;
+            if (end > begin && end[-1] == '\r') --end;
+            return std::regex_search(begin, end, regex);
+        };
+
+        if (literal.empty()) {
+            for (; index < endIndex && matches.size() < kMaxMatches; ++index) {
+                if (matchesRegex(index)) matches.push_back(firstLine + index);
+            }
+            continue;
+        }
+
+        // The batch is one contiguous block; each hit maps to its line and
+        // the scan resumes after that line.
+        const uint64_t base = StartOf(index);
+        const char* block = At(base);
+        const char* blockEnd = block + (EndOf(endIndex - 1) - base);
+        const char* p = block;
+        while (p < blockEnd && matches.size() < kMaxMatches) {
+            const char* hit = query.ignoreCase
+                ? FindCaseless(p, blockEnd, literal)
+                : static_cast<const char*>(memmem(p, blockEnd - p, literal.data(),
+                                                  literal.size()));
+            if (!hit) break;
+            const uint64_t offset = base + (hit - block);
+            while (EndOf(index) <= offset) ++index;
+            if (!query.regex || matchesRegex(index)) matches.push_back(firstLine + index);
+            p = block + (EndOf(index) - base);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// The last `capacity` bytes of a log, in a ring of memory mapped twice back
+// to back, so that any stretch of it, however it wraps, reads as one
+// contiguous block. Pages are only backed once written; memory never grows
+// past the capacity plus the line index.
+//
+// Lines are numbered from the first one ever appended. The index keeps the
+// low 32 bits of each line's offset in the stream, four bytes a line, so
+// finding line N is a lookup however many lines there are. The oldest
+// lines drop off as the ring wraps. Lines longer than kMaxLineBytes are
+// split.
+//
+// Thread-safe: one thread appends while others read and search.
+class LogBuffer {
+public:
+    static const size_t kDefaultCapacity = 64 << 20;
+    static const size_t kMaxLineBytes = 64 << 10;
+    static const size_t kMaxMatches = 100000;
+
+    explicit LogBuffer(size_t capacity = kDefaultCapacity);
+    ~LogBuffer();
+
+    // False if the ring could not be mapped; nothing is kept then.
+    bool IsValid() const { return data != nullptr; }
+    size_t Capacity() const { return capacity; }
+
+    // A trailing partial line is kept and indexed once its '\n' arrives.
+    void Append(const char* bytes, size_t size);
+
+    // Complete lines held are [FirstLine(), EndLine()).
+    uint64_t FirstLine() const;
+    uint64_t EndLine() const;
+    // Without the line break; false once the line has dropped off.
+    bool GetLine(uint64_t line, std::string& text) const;
+
+    // Bytes held, and the index's share of memory.
+    size_t BytesHeld() const;
+    size_t IndexBytes() const;
+
+    struct Query {
+        std::string pattern;
+        bool regex = false;       // ECMAScript syntax
+        bool ignoreCase = false;
+    };
+
+    // Numbers of the lines matching, oldest first, at most kMaxMatches.
+    // Lines are scanned a batch at a time with the lock held, so appends
+    // carry on meanwhile; stops early once `cancel` is set. False if the
+    // pattern is empty or not a valid regex.
+    bool Search(const Query& query, std::vector<uint64_t>& matches,
+                const std::atomic<bool>* cancel = nullptr) const;
+
+private:
+    char* data;       // capacity bytes, then the same bytes again
+    size_t capacity;  // a multiple of the page size, below 2 GiB
+
+    mutable std::mutex mutex;
+    uint64_t written;     // bytes ever appended
+    uint64_t lineStart;   // where the partial line at the end begins
+    uint64_t firstLine;   // number of the line at starts.front()
+    std::deque<uint32_t> starts;
+
+    uint64_t StartOf(size_t index) const;
+    uint64_t EndOf(size_t index) const;
+    const char* At(uint64_t offset) const { return data + offset % capacity; }
+    void Index(uint64_t from);
+    void Trim();
+};
@@ -0,0 +1,166 @@
+#include "log_follower.h"
+#include "docker_api.h"
+#include "docker_commands.h"
+#include "process_runner.h"
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <poll.h>
+#include <unistd.h>
+
+LogFollower::LogFollower(const std::string& containerId, LogBuffer& buffer)
+    : containerId(containerId), buffer(buffer), stopping(false), ended(false), cliPid(0) {}
+
+LogFollower::~LogFollower() {
+    Stop();
+}
+
+void LogFollower::Start() {
+    if (thread.joinable()) return;
+    stopping = false;
+    ended = false;
+    thread = std::thread(&LogFollower::Run, this);
+}
+
+void LogFollower::Stop() {
+    stopping = true;
+    int pid = cliPid.load();
+    if (pid > 0) kill(pid, SIGTERM);
+    if (thread.joinable()) thread.join();
+}
+
+std::string LogFollower::GetError() const {
+    std::lock_guard<std::mutex> lock(errorMutex);
+    return error;
+}
+
+void LogFollower::SetError(const std::string& message) {
+    std::lock_guard<std::mutex> lock(errorMutex);
+    error = message;
+}
+
+void LogFollower::Run() {
+    bool followed = DockerApiClient::Instance().IsEnabled() && FollowApi();
+    if (!followed && !stopping) FollowCli();
+    ended = true;
+}
+
+void LogFollower::Consume(Demuxer& demuxer, const char* data, size_t size) {
+    if (demuxer.mode == Demuxer::Unknown && size > 0) {
+        demuxer.mode = static_cast<unsigned char>(data[0]) <= 2 ? Demuxer::Framed : Demuxer::Raw;
+    }
+    if (demuxer.mode == Demuxer::Raw) {
+        buffer.Append(data, size);
+        return;
+    }
+    while (size > 0) {
+        if (demuxer.remaining == 0) {
+            const size_t n = std::min(size, sizeof(demuxer.header) - demuxer.headerFill);
+            std::copy(data, data + n, demuxer.header + demuxer.headerFill);
+            demuxer.headerFill += n;
+            data += n;
+            size -= n;
+            if (demuxer.headerFill < sizeof(demuxer.header)) return;
+            demuxer.headerFill = 0;
+            demuxer.remaining = static_cast<uint32_t>(demuxer.header[4]) << 24 |
+                                static_cast<uint32_t>(demuxer.header[5]) << 16 |
+                                static_cast<uint32_t>(demuxer.header[6]) << 8 |
+                                demuxer.header[7];
+            continue;
+        }
+        const size_t n = std::min<size_t>(size, demuxer.remaining);
+        buffer.Append(data, n);
+        demuxer.remaining -= static_cast<uint32_t>(n);
+        data += n;
+        size -= n;
+    }
+}
+
+bool LogFollower::FollowApi() {
+    Demuxer demuxer;
+    auto onData = [this, &demuxer](const char* data, size_t size) {
+        if (stopping) return false;
+        if (data) Consume(demuxer, data, size);
+        return true;
+    };
+
+    int status = 0;
+    std::string streamError;
+    const std::string path = "/containers/" + DockerApiClient::UrlEncode(containerId) +
+                             "/logs?follow=1&stdout=1&stderr=1&timestamps=1&tail=" +
+                             std::to_string(kTailLines);
+    if (!DockerApiClient::Instance().Stream("GET", path, onData, &status, &streamError)) {
+        return false;
+    }
+    if (status != 200) SetError(streamError);
+    return true;
+}
+
+void LogFollower::AppendLines(std::string& partial, const char* data, size_t size) {
+    const char* end = data + size;
+    const char* last = end;
+    while (last > data && last[-1] != '\n') --last;
+    if (last == data) {
+        partial.append(data, size);
+        return;
+    }
+    if (partial.empty()) {
+        buffer.Append(data, last - data);
+    } else {
+        partial.append(data, last - data);
+        buffer.Append(partial.data(), partial.size());
+        partial.clear();
+    }
+    partial.assign(last, end - last);
+}
+
+void LogFollower::FollowCli() {
+    ChildProcess child;
+    std::string startError;
+    if (!child.Start({DockerCommands::FindDockerBinary(), "logs", "--follow", "--timestamps",
+                      "--tail", std::to_string(kTailLines), containerId},
+                     true, &startError)) {
+        SetError(startError);
+        return;
+    }
+    cliPid = child.Pid();
+
+    // stdout and stderr arrive on separate pipes. Each pipe's lines are
+    // assembled on their own and only whole lines reach the buffer, so the
+    // two streams may interleave in a different order than the container
+    // wrote them, but never inside a line.
+    pollfd fds[2] = {{child.StdoutFd(), POLLIN, 0}, {child.StderrFd(), POLLIN, 0}};
+    std::string partial[2];
+    char chunk[16 * 1024];
+    int openPipes = 2;
+    while (!stopping && openPipes > 0) {
+        int ready = poll(fds, 2, 500);
+        if (ready < 0 && errno == EINTR) continue;
+        if (ready < 0) break;
+        for (int i = 0; i < 2; ++i) {
+            pollfd& pfd = fds[i];
+            if (pfd.fd < 0 || !(pfd.revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            ssize_t n = read(pfd.fd, chunk, sizeof(chunk));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                pfd.fd = -1;  // poll() skips negative descriptors
+                --openPipes;
+                continue;
+            }
+            AppendLines(partial[i], chunk, static_cast<size_t>(n));
+        }
+    }
+    // A last line without its newline still belongs to its own stream.
+    for (std::string& rest : partial) {
+        if (rest.empty()) continue;
+        rest += '\n';
+        buffer.Append(rest.data(), rest.size());
+    }
+
+    cliPid = 0;
+    child.Signal(SIGTERM);
+    int status = child.Wait();
+    if (!stopping && status != 0) {
+        SetError("docker logs exited with status " + std::to_string(status));
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "log_buffer.h"
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Streams one container's log into a LogBuffer on a background thread:
+// the last kTailLines lines, then whatever it writes until the container
+// stops. Uses the Engine API's /logs when the socket is reachable and
+// `docker logs --follow` otherwise; every line carries its timestamp.
+class LogFollower {
+public:
+    static const int kTailLines = 1000000;
+
+    LogFollower(const std::string& containerId, LogBuffer& buffer);
+    ~LogFollower();
+
+    void Start();
+    void Stop();
+
+    // True once the stream ended on its own; GetError() says why if it failed.
+    bool HasEnded() const { return ended; }
+    std::string GetError() const;
+
+private:
+    // The API multiplexes stdout and stderr unless the container has a TTY:
+    // each frame is an 8-byte header (stream, 0, 0, 0, big-endian size)
+    // and its payload. With timestamps on, raw output starts with a digit.
+    struct Demuxer {
+        enum { Unknown, Raw, Framed } mode = Unknown;
+        unsigned char header[8];
+        size_t headerFill = 0;
+        uint32_t remaining = 0;  // payload bytes left in the current frame
+    };
+
+    std::string containerId;
+    LogBuffer& buffer;
+    std::thread thread;
+    std::atomic<bool> stopping;
+    std::atomic<bool> ended;
+    std::atomic<int> cliPid;
+    mutable std::mutex errorMutex;
+    std::string error;
+
+    void Run();
+    bool FollowApi();
+    void FollowCli();
+    void SetError(const std::string& message);
+    void Consume(Demuxer& demuxer, const char* data, size_t size);
+    // Appends the complete lines of `data` to the buffer and keeps the rest
+    // in `partial` until its newline arrives.
+    void AppendLines(std::string& partial, const char* data, size_t size);
+};
@@ -0,0 +1,280 @@
+#include "log_viewer.h"
+#include "byte_size.h"
+#include <algorithm>
+
+namespace {
+
+enum {
+    ID_LOG_LINES = wxID_HIGHEST + 1,
+    ID_LOG_SEARCH,
+    ID_LOG_REGEX,
+    ID_LOG_CASE,
+    ID_LOG_FOLLOW,
+    ID_LOG_PREVIOUS,
+    ID_LOG_NEXT,
+    ID_LOG_TIMER
+};
+
+// How often new lines and finished searches are picked up.
+const int kPollMs = 250;
+
+const size_t kNoMatch = static_cast<size_t>(-1);
+
+wxString Bytes(size_t bytes) {
+    return wxString::FromUTF8(FormatBinaryBytes(static_cast<double>(bytes)).c_str());
+}
+
+}  // namespace
+
+// One column, one row per log line; the text is fetched as rows are painted.
+class LogViewer::LineList : public wxListCtrl {
+public:
+    LineList(wxWindow* parent, const LogBuffer& buffer, const uint64_t& baseLine,
+             const std::vector<uint64_t>& matches)
+        : wxListCtrl(parent, ID_LOG_LINES, wxDefaultPosition, wxDefaultSize,
+                     wxLC_REPORT | wxLC_VIRTUAL | wxLC_NO_HEADER | wxLC_SINGLE_SEL),
+          buffer(buffer), baseLine(baseLine), matches(matches) {
+        AppendColumn(wxEmptyString, wxLIST_FORMAT_LEFT, 4000);
+        SetFont(wxFont(9, wxFONTFAMILY_TELETYPE, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL));
+        matchAttr.SetBackgroundColour(wxColour(255, 240, 150));  // yellow
+    }
+
+protected:
+    wxString OnGetItemText(long item, long column) const override {
+        std::string text;
+        if (!buffer.GetLine(baseLine + item, text)) return wxString();
+        wxString line = wxString::FromUTF8(text.data(), text.size());
+        // Not every program writes UTF-8; show the bytes rather than nothing.
+        if (line.empty() && !text.empty()) line = wxString::From8BitData(text.data(), text.size());
+        return line;
+    }
+
+    wxListItemAttr* OnGetItemAttr(long item) const override {
+        const bool match = std::binary_search(matches.begin(), matches.end(), baseLine + item);
+        return match ? &matchAttr : nullptr;
+    }
+
+private:
+    const LogBuffer& buffer;
+    const uint64_t& baseLine;
+    const std::vector<uint64_t>& matches;
+    mutable wxListItemAttr matchAttr;
+};
+
+wxBEGIN_EVENT_TABLE(LogViewer, wxFrame)
+    EVT_TIMER(ID_LOG_TIMER, LogViewer::OnTimer)
+    EVT_TEXT_ENTER(ID_LOG_SEARCH, LogViewer::OnSearch)
+    EVT_SEARCHCTRL_SEARCH_BTN(ID_LOG_SEARCH, LogViewer::OnSearch)
+    EVT_SEARCHCTRL_CANCEL_BTN(ID_LOG_SEARCH, LogViewer::OnSearchCancel)
+    EVT_CHECKBOX(ID_LOG_REGEX, LogViewer::OnSearchOption)
+    EVT_CHECKBOX(ID_LOG_CASE, LogViewer::OnSearchOption)
+    EVT_CHECKBOX(ID_LOG_FOLLOW, LogViewer::OnFollow)
+    EVT_BUTTON(ID_LOG_PREVIOUS, LogViewer::OnPrevious)
+    EVT_BUTTON(ID_LOG_NEXT, LogViewer::OnNext)
+wxEND_EVENT_TABLE()
+
+LogViewer::LogViewer(wxWindow* parent, const std::string& containerId, const std::string& name)
+    : wxFrame(parent, wxID_ANY, wxString::FromUTF8(("Logs of " + name).c_str()),
+              wxDefaultPosition, wxSize(900, 600)),
+      follower(containerId, buffer), baseLine(0), endLine(0), searchCancel(false),
+      searchDone(false), searchValid(true), searching(false), currentMatch(kNoMatch) {
+    wxPanel* panel = new wxPanel(this);
+    wxBoxSizer* sizer = new wxBoxSizer(wxVERTICAL);
+
+    wxBoxSizer* searchSizer = new wxBoxSizer(wxHORIZONTAL);
+    searchBox = new wxSearchCtrl(panel, ID_LOG_SEARCH, wxEmptyString, wxDefaultPosition,
+                                 wxDefaultSize, wxTE_PROCESS_ENTER);
+    searchBox->SetDescriptiveText(wxT("Search, then press Enter"));
+    searchBox->ShowCancelButton(true);
+    searchSizer->Add(searchBox, 1, wxEXPAND | wxALL, 5);
+    regexCheck = new wxCheckBox(panel, ID_LOG_REGEX, wxT("Regex"));
+    searchSizer->Add(regexCheck, 0, wxALIGN_CENTER_VERTICAL | wxALL, 5);
+    caseCheck = new wxCheckBox(panel, ID_LOG_CASE, wxT("Ignore case"));
+    searchSizer->Add(caseCheck, 0, wxALIGN_CENTER_VERTICAL | wxALL, 5);
+    previousButton = new wxButton(panel, ID_LOG_PREVIOUS, wxT("Previous"));
+    searchSizer->Add(previousButton, 0, wxALL, 5);
+    nextButton = new wxButton(panel, ID_LOG_NEXT, wxT("Next"));
+    searchSizer->Add(nextButton, 0, wxALL, 5);
+    sizer->Add(searchSizer, 0, wxEXPAND);
+
+    lines = new LineList(panel, buffer, baseLine, matches);
+    sizer->Add(lines, 1, wxEXPAND | wxLEFT | wxRIGHT, 5);
+
+    wxBoxSizer* statusSizer = new wxBoxSizer(wxHORIZONTAL);
+    followCheck = new wxCheckBox(panel, ID_LOG_FOLLOW, wxT("Follow"));
+    followCheck->SetValue(true);
+    statusSizer->Add(followCheck, 0, wxALIGN_CENTER_VERTICAL | wxALL, 5);
+    statusLabel = new wxStaticText(panel, wxID_ANY, wxEmptyString);
+    statusSizer->Add(statusLabel, 1, wxALIGN_CENTER_VERTICAL | wxALL, 5);
+    sizer->Add(statusSizer, 0, wxEXPAND);
+
+    panel->SetSizer(sizer);
+
+    if (buffer.IsValid()) follower.Start();
+    timer = new wxTimer(this, ID_LOG_TIMER);
+    timer->Start(kPollMs);
+    UpdateStatus();
+}
+
+LogViewer::~LogViewer() {
+    timer->Stop();
+    delete timer;
+    StopSearch();
+    follower.Stop();
+}
+
+void LogViewer::SyncLines(bool force) {
+    // Following, row 0 is the oldest line held; otherwise the rows stay
+    // put and only grow at the end.
+    const bool follow = followCheck->GetValue();
+    const uint64_t first = buffer.FirstLine();
+    const uint64_t end = buffer.EndLine();
+    const bool rebase = follow && first != baseLine;
+    if (!force && !rebase && end == endLine) return;
+
+    if (follow) baseLine = first;
+    endLine = std::max(end, baseLine);
+    const long count = static_cast<long>(endLine - baseLine);
+    lines->SetItemCount(count);
+    if (follow && count > 0) {
+        lines->EnsureVisible(count - 1);
+    }
+    // Every row moved, or the oldest ones on screen may have dropped out.
+    lines->Refresh();
+}
+
+void LogViewer::OnTimer(wxTimerEvent& event) {
+    if (searching && searchDone) FinishSearch();
+    SyncLines(false);
+    UpdateStatus();
+}
+
+void LogViewer::StartSearch() {
+    StopSearch();
+    matches.clear();
+    currentMatch = kNoMatch;
+    searchValid = true;
+    lines->Refresh();
+
+    LogBuffer::Query query;
+    query.pattern = std::string(searchBox->GetValue().utf8_str());
+    query.regex = regexCheck->GetValue();
+    query.ignoreCase = caseCheck->GetValue();
+    if (!query.pattern.empty()) {
+        searchCancel = false;
+        searchDone = false;
+        searching = true;
+        searchThread = std::thread([this, query] {
+            searchValid = buffer.Search(query, searchResults, &searchCancel);
+            searchDone = true;
+        });
+    }
+    UpdateStatus();
+}
+
+void LogViewer::StopSearch() {
+    if (!searchThread.joinable()) return;
+    searchCancel = true;
+    searchThread.join();
+    searching = false;
+}
+
+void LogViewer::FinishSearch() {
+    searchThread.join();
+    searching = false;
+    matches.swap(searchResults);
+    searchResults.clear();
+    lines->Refresh();
+    if (matches.empty()) return;
+
+    // The first match from the top of the page down, or else the last one.
+    const uint64_t top = baseLine + static_cast<uint64_t>(std::max(0L, lines->GetTopItem()));
+    auto it = std::lower_bound(matches.begin(), matches.end(), top);
+    ShowMatch(it == matches.end() ? matches.size() - 1 : it - matches.begin());
+}
+
+void LogViewer::ShowMatch(size_t index) {
+    if (index >= matches.size() || matches[index] < baseLine) return;
+    currentMatch = index;
+    // Following would scroll the match away again.
+    if (followCheck->GetValue()) {
+        followCheck->SetValue(false);
+        SyncLines(true);
+    }
+    const long row = static_cast<long>(matches[index] - baseLine);
+    lines->EnsureVisible(row);
+    lines->SetItemState(row, wxLIST_STATE_SELECTED | wxLIST_STATE_FOCUSED,
+                        wxLIST_STATE_SELECTED | wxLIST_STATE_FOCUSED);
+    UpdateStatus();
+}
+
+void LogViewer::UpdateStatus() {
+    wxString text;
+    if (!buffer.IsValid()) {
+        text = wxT("Could not allocate the log buffer");
+    } else {
+        const uint64_t held = buffer.EndLine() - buffer.FirstLine();
+        text = wxString::Format(wxT("%llu lines, %s of %s"), static_cast<unsigned long long>(held),
+                                Bytes(buffer.BytesHeld()), Bytes(buffer.Capacity()));
+        if (follower.HasEnded()) {
+            const std::string error = follower.GetError();
+            text += error.empty() ? wxString(wxT(" - log ended"))
+                                  : wxT(" - ") + wxString::FromUTF8(error.c_str());
+        }
+    }
+
+    if (searching) {
+        text += wxT("; searching...");
+    } else if (!searchValid) {
+        text += wxT("; not a valid regular expression");
+    } else if (!searchBox->GetValue().empty()) {
+        const bool capped = matches.size() >= LogBuffer::kMaxMatches;
+        if (currentMatch != kNoMatch) {
+            text += wxString::Format(wxT("; match %d of %d%s"), static_cast<int>(currentMatch + 1),
+                                     static_cast<int>(matches.size()), capped ? wxT("+") : wxT(""));
+        } else {
+            text += wxString::Format(wxT("; %d%s matches"), static_cast<int>(matches.size()),
+                                     capped ? wxT("+") : wxT(""));
+        }
+    }
+    if (statusLabel->GetLabel() != text) statusLabel->SetLabel(text);
+    previousButton->Enable(!matches.empty());
+    nextButton->Enable(!matches.empty());
+}
+
+void LogViewer::OnSearch(wxCommandEvent& event) {
+    StartSearch();
+}
+
+void LogViewer::OnSearchCancel(wxCommandEvent& event) {
+    searchBox->Clear();
+    StartSearch();
+}
+
+void LogViewer::OnSearchOption(wxCommandEvent& event) {
+    if (!searchBox->GetValue().empty()) StartSearch();
+}
+
+void LogViewer::OnFollow(wxCommandEvent& event) {
+    SyncLines(true);
+}
+
+void LogViewer::OnPrevious(wxCommandEvent& event) {
+    if (matches.empty()) return;
+    if (currentMatch == kNoMatch || currentMatch == 0) {
+        ShowMatch(matches.size() - 1);
+    } else {
+        ShowMatch(currentMatch - 1);
+    }
+}
+
+void LogViewer::OnNext(wxCommandEvent& event) {
+    if (matches.empty()) return;
+    // Matches that dropped out of the buffer are skipped.
+    size_t next = currentMatch == kNoMatch ? 0 : currentMatch + 1;
+    if (next >= matches.size()) next = 0;
+    if (matches[next] < baseLine) {
+        next = std::lower_bound(matches.begin(), matches.end(), baseLine) - matches.begin();
+    }
+    ShowMatch(next);
+}
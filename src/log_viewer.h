@@ -0,0 +1,70 @@
+#pragma once
+
+#include <wx/wx.h>
+#include <wx/listctrl.h>
+#include <wx/srchctrl.h>
+#include <wx/timer.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "log_buffer.h"
+#include "log_follower.h"
+
+// Window following one container's log. The list is virtual and asks the
+// LogBuffer for the lines on screen only, so it scrolls through a million
+// lines as easily as through ten. While "Follow" is off the list keeps its
+// numbering and lines that drop out of the buffer show as blank.
+//
+// Searches run on their own thread and highlight every matching line;
+// Next and Previous step through them.
+class LogViewer : public wxFrame {
+public:
+    LogViewer(wxWindow* parent, const std::string& containerId, const std::string& name);
+    ~LogViewer();
+
+private:
+    class LineList;
+
+    LogBuffer buffer;
+    LogFollower follower;
+
+    LineList* lines;
+    wxSearchCtrl* searchBox;
+    wxCheckBox* regexCheck;
+    wxCheckBox* caseCheck;
+    wxCheckBox* followCheck;
+    wxButton* previousButton;
+    wxButton* nextButton;
+    wxStaticText* statusLabel;
+    wxTimer* timer;
+
+    uint64_t baseLine;  // log line shown as row 0
+    uint64_t endLine;   // one past the last line shown
+
+    std::thread searchThread;
+    std::atomic<bool> searchCancel;
+    std::atomic<bool> searchDone;
+    std::vector<uint64_t> searchResults;  // the search thread's, until joined
+    bool searchValid;                     // likewise
+    bool searching;
+    std::vector<uint64_t> matches;        // line numbers, ascending
+    size_t currentMatch;                  // index into `matches`, npos if none
+
+    void SyncLines(bool force);
+    void StartSearch();
+    void StopSearch();
+    void FinishSearch();
+    void ShowMatch(size_t index);
+    void UpdateStatus();
+
+    void OnTimer(wxTimerEvent& event);
+    void OnSearch(wxCommandEvent& event);
+    void OnSearchCancel(wxCommandEvent& event);
+    void OnSearchOption(wxCommandEvent& event);
+    void OnFollow(wxCommandEvent& event);
+    void OnPrevious(wxCommandEvent& event);
+    void OnNext(wxCommandEvent& event);
+
+    wxDECLARE_EVENT_TABLE();
+};
@@ -0,0 +1,422 @@
+#include "metrics_archive.h"
+#include "byte_size.h"
+#include "file_util.h"
+#include "gorilla_codec.h"
+#include "metrics_history.h"
+#include "stats_collector.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+struct TierConfig {
+    const char* name;
+    int resolution;          // seconds per point
+    int64_t segmentSeconds;  // time span of one file
+    int64_t retentionSeconds;
+    int columns;             // raw: cpu, memory; rollups: avg and max of each
+};
+
+const TierConfig kTiers[] = {
+    {"raw", 1, 3600, 24 * 3600, 2},
+    {"1m", 60, 24 * 3600, 8 * 24 * 3600, 4},
+    {"1h", 3600, 30 * 24 * 3600, 400 * 24 * 3600, 4},
+};
+
+const size_t kChunkPoints = 120;
+// A container that sent no sample for this long has its chunks written out.
+const int64_t kStaleSeconds = 120;
+const int64_t kRetentionCheckSeconds = 600;
+
+const char kFileMagic[4] = {'D', 'M', 'T', 'S'};
+const uint32_t kFileVersion = 1;
+const uint32_t kBlockMagic = 0x31424D44;  // "DMB1"
+const char kSuffix[] = ".dmts";
+
+// File header: magic, version, tier, segment start.
+const size_t kFileHeaderSize = 4 + 4 + 4 + 8;
+// Block header: magic, payload bytes, count, columns, id and name lengths,
+// first and last time; followed by id, name and payload.
+const size_t kBlockHeaderSize = 4 + 4 + 2 + 1 + 1 + 1 + 8 + 8;
+
+template <typename T>
+T Get(const uint8_t* p) {
+    T value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+int64_t SegmentStart(int tier, int64_t time) {
+    const int64_t span = kTiers[tier].segmentSeconds;
+    return time - ((time % span) + span) % span;
+}
+
+int64_t BucketStart(int tier, int64_t time) {
+    const int64_t span = kTiers[tier].resolution;
+    return time - ((time % span) + span) % span;
+}
+
+}  // namespace
+
+MetricsArchive::MetricsArchive(const std::string& directory)
+    : directory(directory), opened(false), lastRetentionCheck(0) {}
+
+MetricsArchive::~MetricsArchive() {
+    Close();
+}
+
+std::string MetricsArchive::DefaultDirectory() {
+    if (const char* dir = std::getenv("DOCKER_MANAGER_DATA_DIR")) {
+        if (*dir) return dir;
+    }
+    if (const char* xdg = std::getenv("XDG_DATA_HOME")) {
+        if (*xdg) return std::string(xdg) + "/docker-manager/metrics";
+    }
+    const char* home = std::getenv("HOME");
+    return std::string(home ? home : ".") + "/.local/share/docker-manager/metrics";
+}
+
+bool MetricsArchive::Open(std::string* error) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!MakeDirectories(directory) || access(directory.c_str(), W_OK) != 0) {
+        if (error) *error = directory + ": " + std::strerror(errno);
+        return false;
+    }
+    EnforceRetention(std::time(nullptr));
+    opened = true;
+    return true;
+}
+
+void MetricsArchive::Close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!opened) return;
+    for (auto& entry : series) {
+        Series& s = entry.second;
+        FlushRollup(s, Minute);
+        FlushRollup(s, Hour);
+        for (int tier = 0; tier < TierCount; ++tier) FlushChunk(s, static_cast<Tier>(tier));
+    }
+    series.clear();
+    opened = false;
+}
+
+void MetricsArchive::Append(const std::vector<ContainerStats>& frame, time_t now) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!opened) return;
+
+    for (const auto& row : frame) {
+        Series& s = series[row.id];
+        s.id = row.id;
+        if (!row.name.empty()) s.name = row.name;
+        s.lastSeen = now;
+
+        // Raw points are kept at one-second resolution.
+        const auto& raw = s.pending[Raw];
+        if (!raw.empty() && raw.back().time >= now) continue;
+
+        const double memory = static_cast<double>(row.mem_bytes);
+        ArchivePoint point = {now, row.cpu_percent, row.cpu_percent, memory, memory};
+        AddPoint(s, Raw, point, 1.0);
+    }
+
+    for (auto it = series.begin(); it != series.end();) {
+        Series& s = it->second;
+        if (now - s.lastSeen < kStaleSeconds) {
+            ++it;
+            continue;
+        }
+        FlushRollup(s, Minute);
+        FlushRollup(s, Hour);
+        for (int tier = 0; tier < TierCount; ++tier) FlushChunk(s, static_cast<Tier>(tier));
+        it = series.erase(it);
+    }
+
+    if (now - lastRetentionCheck >= kRetentionCheckSeconds || now < lastRetentionCheck) {
+        EnforceRetention(now);
+    }
+}
+
+void MetricsArchive::AddPoint(Series& s, Tier tier, const ArchivePoint& point, double weight) {
+    // A chunk never spans two segments, so retention can drop whole files.
+    std::vector<ArchivePoint>& pending = s.pending[tier];
+    if (!pending.empty() &&
+        (pending.size() >= kChunkPoints ||
+         SegmentStart(tier, pending.front().time) != SegmentStart(tier, point.time))) {
+        FlushChunk(s, tier);
+    }
+    pending.push_back(point);
+
+    if (tier + 1 >= TierCount) return;
+    const Tier next = static_cast<Tier>(tier + 1);
+    const int64_t bucket = BucketStart(next, point.time);
+    Rollup& r = s.rollups[next];
+    if (r.bucket != bucket) {
+        FlushRollup(s, next);
+        r.bucket = bucket;
+    }
+    r.cpuSum += point.cpu * weight;
+    r.cpuMax = std::max(r.cpuMax, point.cpuMax);
+    r.memorySum += point.memory * weight;
+    r.memoryMax = std::max(r.memoryMax, point.memoryMax);
+    r.weight += weight;
+}
+
+void MetricsArchive::FlushRollup(Series& s, Tier tier) {
+    Rollup r = s.rollups[tier];
+    s.rollups[tier] = Rollup();
+    if (r.weight <= 0.0) return;
+
+    ArchivePoint point = {r.bucket, r.cpuSum / r.weight, r.cpuMax,
+                          r.memorySum / r.weight, r.memoryMax};
+    AddPoint(s, tier, point, r.weight);
+}
+
+void MetricsArchive::FlushChunk(Series& s, Tier tier) {
+    std::vector<ArchivePoint>& pending = s.pending[tier];
+    if (pending.empty()) return;
+    WriteChunk(tier, s, pending);
+    pending.clear();
+}
+
+bool MetricsArchive::WriteChunk(Tier tier, const Series& s,
+                                const std::vector<ArchivePoint>& points) {
+    const TierConfig& config = kTiers[tier];
+    ChunkEncoder encoder(config.columns);
+    for (const auto& p : points) {
+        if (config.columns == 2) {
+            const double values[] = {p.cpu, p.memory};
+            encoder.Append(p.time, values);
+        } else {
+            const double values[] = {p.cpu, p.cpuMax, p.memory, p.memoryMax};
+            encoder.Append(p.time, values);
+        }
+    }
+
+    const int64_t start = SegmentStart(tier, points.front().time);
+    const std::string path = SegmentPath(tier, start);
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "docker_manager: cannot write %s: %s\n", path.c_str(), std::strerror(errno));
+        return false;
+    }
+
+    const std::string name = s.name.substr(0, 255);
+    const std::string id = s.id.substr(0, 255);
+    const std::vector<uint8_t>& payload = encoder.Bytes();
+
+    std::string block;
+    block.reserve(kFileHeaderSize + kBlockHeaderSize + id.size() + name.size() + payload.size());
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size == 0) {
+        block.append(kFileMagic, sizeof(kFileMagic));
+        Put<uint32_t>(block, kFileVersion);
+        Put<uint32_t>(block, static_cast<uint32_t>(tier));
+        Put<int64_t>(block, start);
+    }
+    Put<uint32_t>(block, kBlockMagic);
+    Put<uint32_t>(block, static_cast<uint32_t>(payload.size()));
+    Put<uint16_t>(block, static_cast<uint16_t>(points.size()));
+    Put<uint8_t>(block, static_cast<uint8_t>(config.columns));
+    Put<uint8_t>(block, static_cast<uint8_t>(id.size()));
+    Put<uint8_t>(block, static_cast<uint8_t>(name.size()));
+    Put<int64_t>(block, points.front().time);
+    Put<int64_t>(block, points.back().time);
+    block += id;
+    block += name;
+    block.append(reinterpret_cast<const char*>(payload.data()), payload.size());
+
+    // One write per block: O_APPEND keeps concurrent writers from interleaving.
+    bool ok = WriteAll(fd, block);
+    close(fd);
+    if (!ok) fprintf(stderr, "docker_manager: short write to %s\n", path.c_str());
+    return ok;
+}
+
+void MetricsArchive::EnforceRetention(int64_t now) {
+    lastRetentionCheck = now;
+    for (int tier = 0; tier < TierCount; ++tier) {
+        const TierConfig& config = kTiers[tier];
+        for (const auto& segment : ListSegments(static_cast<Tier>(tier))) {
+            if (segment.first + config.segmentSeconds <= now - config.retentionSeconds) {
+                unlink(segment.second.c_str());
+            }
+        }
+    }
+}
+
+std::string MetricsArchive::SegmentPath(Tier tier, int64_t start) const {
+    return directory + "/" + kTiers[tier].name + "-" + std::to_string(start) + kSuffix;
+}
+
+std::vector<std::pair<int64_t, std::string>> MetricsArchive::ListSegments(Tier tier) const {
+    std::vector<std::pair<int64_t, std::string>> segments;
+    DIR* dir = opendir(directory.c_str());
+    if (!dir) return segments;
+
+    const std::string prefix = std::string(kTiers[tier].name) + "-";
+    while (dirent* de = readdir(dir)) {
+        const std::string name = de->d_name;
+        if (name.compare(0, prefix.size(), prefix) != 0) continue;
+        const size_t suffixLen = sizeof(kSuffix) - 1;
+        if (name.size() <= prefix.size() + suffixLen ||
+            name.compare(name.size() - suffixLen, suffixLen, kSuffix) != 0) {
+            continue;
+        }
+        char* end = nullptr;
+        long long start = std::strtoll(name.c_str() + prefix.size(), &end, 10);
+        if (end != name.c_str() + name.size() - suffixLen) continue;
+        segments.emplace_back(start, directory + "/" + name);
+    }
+    closedir(dir);
+    std::sort(segments.begin(), segments.end());
+    return segments;
+}
+
+bool MetricsArchive::Matches(const std::string& id, const std::string& name,
+                             const std::string& container) {
+    if (container.empty()) return false;
+    return id.compare(0, container.size(), container) == 0 || name == container;
+}
+
+void MetricsArchive::ReadSegment(const std::string& path, Tier tier, const std::string& container,
+                                 int64_t from, int64_t to, std::vector<ArchivePoint>& out) const {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(kFileHeaderSize)) {
+        close(fd);
+        return;
+    }
+    const size_t size = static_cast<size_t>(st.st_size);
+    void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return;
+
+    const uint8_t* base = static_cast<const uint8_t*>(map);
+    if (std::memcmp(base, kFileMagic, sizeof(kFileMagic)) != 0 ||
+        Get<uint32_t>(base + 4) != kFileVersion || Get<uint32_t>(base + 8) != uint32_t(tier)) {
+        munmap(map, size);
+        return;
+    }
+
+    // Walk the block headers; only chunks of the requested container in the
+    // requested range are decoded. A torn block at the tail ends the walk.
+    size_t offset = kFileHeaderSize;
+    while (offset + kBlockHeaderSize <= size) {
+        const uint8_t* h = base + offset;
+        if (Get<uint32_t>(h) != kBlockMagic) break;
+        const size_t payloadSize = Get<uint32_t>(h + 4);
+        const size_t count = Get<uint16_t>(h + 8);
+        const int columns = h[10];
+        const size_t idLen = h[11];
+        const size_t nameLen = h[12];
+        const int64_t first = Get<int64_t>(h + 13);
+        const int64_t last = Get<int64_t>(h + 21);
+        const size_t blockSize = kBlockHeaderSize + idLen + nameLen + payloadSize;
+        if (offset + blockSize > size) break;
+        offset += blockSize;
+
+        if (last < from || first > to) continue;
+        const char* text = reinterpret_cast<const char*>(h + kBlockHeaderSize);
+        if (!Matches(std::string(text, idLen), std::string(text + idLen, nameLen), container)) {
+            continue;
+        }
+
+        if (columns != 2 && columns != 4) continue;
+        ChunkDecoder decoder(h + kBlockHeaderSize + idLen + nameLen, payloadSize, columns, count);
+        int64_t time;
+        double values[4];
+        while (decoder.Next(time, values)) {
+            if (time < from || time > to) continue;
+            if (columns == 2) {
+                out.push_back({time, values[0], values[0], values[1], values[1]});
+            } else {
+                out.push_back({time, values[0], values[1], values[2], values[3]});
+            }
+        }
+    }
+    munmap(map, size);
+}
+
+bool MetricsArchive::Query(const std::string& container, time_t from, time_t to,
+                           ArchiveQueryResult& result) const {
+    const int64_t now = std::time(nullptr);
+    int tier = 0;
+    while (tier + 1 < TierCount && from < now - kTiers[tier].retentionSeconds) ++tier;
+
+    const TierConfig& config = kTiers[tier];
+    result.tier = config.name;
+    result.resolution = config.resolution;
+    result.points.clear();
+
+    for (const auto& segment : ListSegments(static_cast<Tier>(tier))) {
+        if (segment.first > to || segment.first + config.segmentSeconds <= from) continue;
+        ReadSegment(segment.second, static_cast<Tier>(tier), container, from, to, result.points);
+    }
+
+    // Points still waiting for their chunk to fill, and the rollup in progress.
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& entry : series) {
+            const Series& s = entry.second;
+            if (!Matches(s.id, s.name, container)) continue;
+            for (const auto& p : s.pending[tier]) {
+                if (p.time >= from && p.time <= to) result.points.push_back(p);
+            }
+            const Rollup& r = s.rollups[tier];
+            if (tier != Raw && r.weight > 0.0 && r.bucket >= from && r.bucket <= to) {
+                result.points.push_back({r.bucket, r.cpuSum / r.weight, r.cpuMax,
+                                         r.memorySum / r.weight, r.memoryMax});
+            }
+        }
+    }
+
+    // A restart within one bucket can write it twice; keep the later one.
+    std::stable_sort(result.points.begin(), result.points.end(),
+                     [](const ArchivePoint& a, const ArchivePoint& b) { return a.time < b.time; });
+    std::vector<ArchivePoint> unique;
+    unique.reserve(result.points.size());
+    for (const auto& p : result.points) {
+        if (!unique.empty() && unique.back().time == p.time) {
+            unique.back() = p;
+        } else {
+            unique.push_back(p);
+        }
+    }
+    result.points.swap(unique);
+    return !result.points.empty();
+}
+
+std::string MetricsArchive::Describe(const ArchiveQueryResult& result, size_t sparklineWidth) {
+    if (result.points.empty()) return "no samples\n";
+
+    std::vector<float> cpu, memory;
+    cpu.reserve(result.points.size());
+    memory.reserve(result.points.size());
+    double cpuSum = 0.0, cpuMax = 0.0, memorySum = 0.0, memoryMax = 0.0;
+    for (const auto& p : result.points) {
+        cpu.push_back(static_cast<float>(p.cpu));
+        memory.push_back(static_cast<float>(p.memory));
+        cpuSum += p.cpu;
+        memorySum += p.memory;
+        cpuMax = std::max(cpuMax, p.cpuMax);
+        memoryMax = std::max(memoryMax, p.memoryMax);
+    }
+    const double n = static_cast<double>(result.points.size());
+
+    char buf[128];
+    std::string out = "CPU     " + MetricsHistory::SparklineFromValues(cpu, sparklineWidth, 0.0);
+    snprintf(buf, sizeof(buf), "  avg %.1f%%  max %.1f%%\n", cpuSum / n, cpuMax);
+    out += buf;
+    out += "Memory  " + MetricsHistory::SparklineFromValues(memory, sparklineWidth, 0.0) +
+           "  avg " + FormatBinaryBytes(memorySum / n) + "  max " + FormatBinaryBytes(memoryMax) + "\n";
+    return out;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct ContainerStats;
+
+struct ArchivePoint {
+    int64_t time;       // Unix seconds; start of the bucket for rollups
+    double cpu;         // average percent
+    double cpuMax;
+    double memory;      // average bytes
+    double memoryMax;
+};
+
+struct ArchiveQueryResult {
+    std::string tier;    // "raw", "1m" or "1h"
+    int resolution = 0;  // seconds per point
+    std::vector<ArchivePoint> points;
+};
+
+// Long-term container CPU and memory history on disk.
+//
+// Samples are kept in three tiers: raw (one point per stats frame), 1-minute
+// and 1-hour rollups of average and maximum, each built at ingest time from
+// the tier below. Every tier is a series of append-only segment files
+// ("1m-<start>.dmts"); a segment holds Gorilla-compressed chunks of up to
+// kChunkPoints points for one container, so a query maps the segments in its
+// time range and decodes only the chunks of the container it asks for.
+// Retention is enforced by deleting whole segments.
+class MetricsArchive {
+public:
+    enum Tier { Raw, Minute, Hour, TierCount };
+
+    explicit MetricsArchive(const std::string& directory);
+    ~MetricsArchive();
+
+    // $DOCKER_MANAGER_DATA_DIR, else $XDG_DATA_HOME/docker-manager/metrics,
+    // else ~/.local/share/docker-manager/metrics.
+    static std::string DefaultDirectory();
+
+    // Creates the directory and drops expired segments.
+    bool Open(std::string* error = nullptr);
+    // Writes out every open chunk and partial rollup.
+    void Close();
+
+    void Append(const std::vector<ContainerStats>& frame, time_t now = std::time(nullptr));
+
+    // Points of one container, matched by ID (or ID prefix) or name, in
+    // [from, to]. Uses the finest tier whose retention still covers `from`.
+    bool Query(const std::string& container, time_t from, time_t to,
+               ArchiveQueryResult& result) const;
+
+    const std::string& GetDirectory() const { return directory; }
+
+    // Two lines, CPU and memory, each a sparkline with average and maximum.
+    static std::string Describe(const ArchiveQueryResult& result, size_t sparklineWidth);
+
+private:
+    struct Rollup {
+        int64_t bucket = -1;
+        double cpuSum = 0.0;
+        double cpuMax = 0.0;
+        double memorySum = 0.0;
+        double memoryMax = 0.0;
+        double weight = 0.0;
+    };
+
+    struct Series {
+        std::string id;
+        std::string name;
+        std::vector<ArchivePoint> pending[TierCount];  // not yet on disk
+        Rollup rollups[TierCount];  // [Minute] and [Hour] are used
+        int64_t lastSeen = 0;
+    };
+
+    std::string directory;
+    bool opened;
+
+    mutable std::mutex mutex;
+    std::map<std::string, Series> series;  // by container ID
+    int64_t lastRetentionCheck;
+
+    void AddPoint(Series& s, Tier tier, const ArchivePoint& point, double weight);
+    void FlushRollup(Series& s, Tier tier);
+    void FlushChunk(Series& s, Tier tier);
+    bool WriteChunk(Tier tier, const Series& s, const std::vector<ArchivePoint>& points);
+    void EnforceRetention(int64_t now);
+
+    std::string SegmentPath(Tier tier, int64_t start) const;
+    std::vector<std::pair<int64_t, std::string>> ListSegments(Tier tier) const;
+    void ReadSegment(const std::string& path, Tier tier, const std::string& container,
+                     int64_t from, int64_t to, std::vector<ArchivePoint>& out) const;
+    static bool Matches(const std::string& id, const std::string& name,
+                        const std::string& container);
+};
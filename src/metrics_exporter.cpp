@@ -0,0 +1,369 @@
+#include "metrics_exporter.h"
+#include "stats_collector.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+// /system/df walks every volume on disk; refresh it far less often.
+const int kVolumeSizeIntervalMs = 60000;
+const int kClientTimeoutMs = 2000;
+
+std::string EscapeLabel(const StringRef& value) {
+    std::string out;
+    out.reserve(value.size());
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            out += '\\';
+            out += c;
+        } else if (c == '\n') {
+            out += "\\n";
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+void Header(std::string& out, const char* name, const char* type, const char* help) {
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+}
+
+void Sample(std::string& out, const char* name, const std::string& labels, double value) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.17g", value);
+    out += name;
+    if (!labels.empty()) {
+        out += '{';
+        out += labels;
+        out += '}';
+    }
+    out += ' ';
+    out += buf;
+    out += '\n';
+}
+
+std::string Label(const char* key, const StringRef& value) {
+    return std::string(key) + "=\"" + EscapeLabel(value) + "\"";
+}
+
+bool SendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Changes between frames, so it is never part of the cached body.
+std::string RenderCallStats() {
+    DaemonCallStats calls = DockerCommands::GetCallStats();
+    std::string out;
+    Header(out, "docker_exporter_daemon_calls_in_flight", "gauge",
+           "Requests to the Docker daemon running now.");
+    Sample(out, "docker_exporter_daemon_calls_in_flight", "", static_cast<double>(calls.active));
+    Header(out, "docker_exporter_daemon_calls_queued", "gauge",
+           "Requests to the Docker daemon waiting for a free slot.");
+    Sample(out, "docker_exporter_daemon_calls_queued", "", static_cast<double>(calls.waiting));
+    Header(out, "docker_exporter_daemon_calls_limit", "gauge",
+           "Maximum number of concurrent requests to the Docker daemon.");
+    Sample(out, "docker_exporter_daemon_calls_limit", "", static_cast<double>(calls.limit));
+    Header(out, "docker_exporter_daemon_calls_coalesced_total", "counter",
+           "Requests answered by an identical request already in flight.");
+    Sample(out, "docker_exporter_daemon_calls_coalesced_total", "",
+           static_cast<double>(calls.coalesced));
+    return out;
+}
+
+}  // namespace
+
+MetricsExporter::MetricsExporter(int refreshIntervalMs)
+    : refreshIntervalMs(refreshIntervalMs > 0 ? refreshIntervalMs : 5000),
+      tracker([](const ResourceSnapshot&) {}),
+      stopping(false), listenFd(-1),
+      renderedGeneration(UINT64_MAX), renderedFrame(0) {}
+
+MetricsExporter::~MetricsExporter() {
+    Stop();
+}
+
+void MetricsExporter::Start() {
+    if (refreshThread.joinable()) return;
+    stopping = false;
+    tracker.Start();
+    StatsCollector::Instance().Start();
+    refreshThread = std::thread(&MetricsExporter::RefreshLoop, this);
+}
+
+void MetricsExporter::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(waitMutex);
+        stopping = true;
+    }
+    waitCond.notify_all();
+    if (serveThread.joinable()) serveThread.join();
+    if (refreshThread.joinable()) refreshThread.join();
+    if (listenFd >= 0) {
+        close(listenFd);
+        listenFd = -1;
+    }
+    tracker.Stop();
+    StatsCollector::Instance().Stop();
+}
+
+bool MetricsExporter::Listen(const std::string& host, int port, std::string* error) {
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1) {
+        if (error) *error = "invalid IPv4 address: " + host;
+        return false;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        if (error) *error = std::string("socket: ") + std::strerror(errno);
+        return false;
+    }
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(fd, 16) != 0) {
+        if (error) *error = std::string("bind: ") + std::strerror(errno);
+        close(fd);
+        return false;
+    }
+
+    listenFd = fd;
+    serveThread = std::thread(&MetricsExporter::ServeLoop, this);
+    return true;
+}
+
+bool MetricsExporter::WaitForData(int timeoutMs) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    SystemInfo totals;
+    while (std::chrono::steady_clock::now() < deadline && !stopping) {
+        bool refreshed;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            refreshed = cache.generation > 0;
+        }
+        if (refreshed && StatsCollector::Instance().GetTotals(totals)) return true;
+
+        std::unique_lock<std::mutex> lock(waitMutex);
+        waitCond.wait_for(lock, std::chrono::milliseconds(100), [this] { return stopping.load(); });
+    }
+    return false;
+}
+
+void MetricsExporter::RefreshLoop() {
+    auto lastVolumeSizes = std::chrono::steady_clock::time_point();
+    bool firstPass = true;
+
+    while (!stopping) {
+        // The tracker keeps the lists current from the event stream; poll
+        // only while it is not connected. A list that cannot be fetched
+        // keeps the tracker's last one rather than reading as empty.
+        ResourceSnapshot resources = tracker.GetSnapshot();
+        if (!tracker.IsLive()) {
+            std::vector<ContainerInfo> containers;
+            std::vector<ImageInfo> images;
+            std::vector<VolumeInfo> volumes;
+            if (DockerCommands::GetAllContainers(containers)) {
+                resources.containers = ContainerTable::Build(containers);
+            }
+            if (DockerCommands::GetAllImages(images)) {
+                resources.images = ImageTable::Build(images);
+            }
+            if (DockerCommands::GetAllVolumes(volumes)) {
+                resources.volumes = VolumeTable::Build(volumes);
+            }
+        }
+
+        std::map<std::string, int64_t> sizes;
+        bool haveSizes = false;
+        const auto now = std::chrono::steady_clock::now();
+        if (firstPass || now - lastVolumeSizes >= std::chrono::milliseconds(kVolumeSizeIntervalMs)) {
+            haveSizes = DockerCommands::GetVolumeSizes(sizes);
+            lastVolumeSizes = now;
+        }
+        firstPass = false;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            cache.resources = resources;
+            if (haveSizes) {
+                cache.volumeSizes.swap(sizes);
+                cache.haveVolumeSizes = true;
+            }
+            ++cache.generation;
+        }
+
+        std::unique_lock<std::mutex> lock(waitMutex);
+        waitCond.wait_for(lock, std::chrono::milliseconds(refreshIntervalMs),
+                          [this] { return stopping.load(); });
+    }
+}
+
+std::string MetricsExporter::Render() {
+    StatsCollector& collector = StatsCollector::Instance();
+    const unsigned long frame = collector.GetFrameCount();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (renderedGeneration == cache.generation && renderedFrame == frame) {
+        return rendered + RenderCallStats();
+    }
+
+    const ResourceSnapshot& res = cache.resources;
+    std::map<StringRef, const ContainerRow*> byId;
+    for (const auto& c : *res.containers) byId[c.id] = &c;
+
+    std::string out;
+    out.reserve(rendered.size() + 1024);
+
+    Header(out, "docker_container_cpu_percent", "gauge",
+           "CPU usage of a running container, in percent of one core.");
+    std::vector<ContainerStats> stats = collector.GetContainerStats();
+    for (const auto& s : stats) {
+        auto it = byId.find(s.id.substr(0, 12));
+        std::string name = it != byId.end() ? it->second->name.str() : s.name;
+        Sample(out, "docker_container_cpu_percent",
+               Label("id", s.id) + "," + Label("name", name), s.cpu_percent);
+    }
+    Header(out, "docker_container_memory_bytes", "gauge",
+           "Memory used by a running container, excluding page cache.");
+    for (const auto& s : stats) {
+        auto it = byId.find(s.id.substr(0, 12));
+        std::string name = it != byId.end() ? it->second->name.str() : s.name;
+        Sample(out, "docker_container_memory_bytes",
+               Label("id", s.id) + "," + Label("name", name),
+               static_cast<double>(s.mem_bytes));
+    }
+
+    Header(out, "docker_container_state", "gauge",
+           "Always 1; the container's current state is in the state label.");
+    std::map<std::string, int> perState;
+    for (const auto& c : *res.containers) {
+        const std::string& state = ContainerStateName(c.state);
+        ++perState[state];
+        Sample(out, "docker_container_state",
+               Label("id", c.id) + "," + Label("name", c.name) + "," + Label("image", c.image) +
+               "," + Label("state", state), 1);
+    }
+    Header(out, "docker_containers", "gauge", "Number of containers by state.");
+    for (const auto& kv : perState) {
+        Sample(out, "docker_containers", Label("state", kv.first), kv.second);
+    }
+
+    // One row per tag; count and size each image once.
+    std::map<StringRef, int64_t> imageSizes;
+    for (const auto& image : *res.images) imageSizes[image.id] = image.size;
+    int64_t imageBytes = 0;
+    for (const auto& kv : imageSizes) imageBytes += kv.second;
+
+    Header(out, "docker_images", "gauge", "Number of images.");
+    Sample(out, "docker_images", "", static_cast<double>(imageSizes.size()));
+    Header(out, "docker_images_size_bytes", "gauge",
+           "Sum of image sizes; layers shared between images are counted for each.");
+    Sample(out, "docker_images_size_bytes", "", static_cast<double>(imageBytes));
+    Header(out, "docker_image_size_bytes", "gauge", "Size of an image as reported by the daemon.");
+    for (const auto& image : *res.images) {
+        Sample(out, "docker_image_size_bytes",
+               Label("id", image.id) + "," + Label("repository", image.repository) + "," +
+               Label("tag", image.tag), static_cast<double>(image.size));
+    }
+
+    Header(out, "docker_volumes", "gauge", "Number of volumes.");
+    Sample(out, "docker_volumes", "", static_cast<double>(res.volumes->size()));
+    if (cache.haveVolumeSizes) {
+        double volumeBytes = 0.0;
+        Header(out, "docker_volume_size_bytes", "gauge", "Disk space used by a volume.");
+        for (const auto& kv : cache.volumeSizes) {
+            if (kv.second < 0) continue;
+            volumeBytes += static_cast<double>(kv.second);
+            Sample(out, "docker_volume_size_bytes", Label("name", kv.first),
+                   static_cast<double>(kv.second));
+        }
+        Header(out, "docker_volumes_size_bytes", "gauge", "Disk space used by all volumes.");
+        Sample(out, "docker_volumes_size_bytes", "", volumeBytes);
+    }
+
+    Header(out, "docker_exporter_stats_frames_total", "counter",
+           "Stats samples taken since the exporter started.");
+    Sample(out, "docker_exporter_stats_frames_total", "", static_cast<double>(frame));
+
+    rendered.swap(out);
+    renderedGeneration = cache.generation;
+    renderedFrame = frame;
+    return rendered + RenderCallStats();
+}
+
+void MetricsExporter::ServeLoop() {
+    while (!stopping) {
+        pollfd pfd = {listenFd, POLLIN, 0};
+        int ready = poll(&pfd, 1, 500);
+        if (ready < 0 && errno == EINTR) continue;
+        if (ready < 0) break;
+        if (ready == 0) continue;
+
+        int client = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client < 0) continue;
+        HandleClient(client);
+        close(client);
+    }
+}
+
+void MetricsExporter::HandleClient(int fd) {
+    // Only the request line matters; read until the end of the headers.
+    std::string request;
+    char buffer[4096];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < 16 * 1024) {
+        pollfd pfd = {fd, POLLIN, 0};
+        if (poll(&pfd, 1, kClientTimeoutMs) <= 0) return;
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return;
+        request.append(buffer, static_cast<size_t>(n));
+    }
+
+    std::string line = request.substr(0, request.find("\r\n"));
+    std::string status = "200 OK";
+    std::string type = "text/plain; version=0.0.4; charset=utf-8";
+    std::string body;
+    if (line.compare(0, 4, "GET ") != 0) {
+        status = "405 Method Not Allowed";
+        type = "text/plain";
+        body = "Only GET is supported\n";
+    } else if (line.compare(4, 9, "/metrics ") == 0 || line.compare(4, 9, "/metrics?") == 0) {
+        body = Render();
+    } else {
+        status = "404 Not Found";
+        type = "text/plain";
+        body = "Metrics are served on /metrics\n";
+    }
+
+    std::string response = "HTTP/1.1 " + status + "\r\n"
+                           "Content-Type: " + type + "\r\n"
+                           "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                           "Connection: close\r\n\r\n";
+    SendAll(fd, response);
+    SendAll(fd, body);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "docker_state.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Collects container, image and volume data in the background and serves
+// it in the Prometheus text format on GET /metrics. Scrapes are answered
+// from the cache; they never run a docker command themselves.
+class MetricsExporter {
+public:
+    explicit MetricsExporter(int refreshIntervalMs = 5000);
+    ~MetricsExporter();
+
+    // Starts the event-driven state tracker, the stats collector and the
+    // refresh thread.
+    void Start();
+    void Stop();
+
+    // Binds host:port and answers scrapes on a background thread.
+    bool Listen(const std::string& host, int port, std::string* error = nullptr);
+
+    // Blocks until the first refresh and stats sample are in, or timeoutMs.
+    bool WaitForData(int timeoutMs);
+
+    std::string Render();
+
+private:
+    struct Cache {
+        ResourceSnapshot resources;
+        std::map<std::string, int64_t> volumeSizes;
+        bool haveVolumeSizes = false;
+        uint64_t generation = 0;
+    };
+
+    void RefreshLoop();
+    void ServeLoop();
+    void HandleClient(int fd);
+
+    const int refreshIntervalMs;
+    DockerStateTracker tracker;
+    std::thread refreshThread;
+    std::thread serveThread;
+    std::atomic<bool> stopping;
+    int listenFd;
+
+    std::mutex waitMutex;
+    std::condition_variable waitCond;
+
+    mutable std::mutex mutex;
+    Cache cache;
+    // Rendered text, reused until the cache or the stats table changes.
+    std::string rendered;
+    uint64_t renderedGeneration;
+    unsigned long renderedFrame;
+};
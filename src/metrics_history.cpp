@@ -0,0 +1,189 @@
+#include "metrics_history.h"
+#include "stats_collector.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+const float kGap = std::numeric_limits<float>::quiet_NaN();
+
+// UTF-8 encodings of U+2581 (lower one eighth block) to U+2588 (full block).
+const char* const kBlocks[] = {"\xE2\x96\x81", "\xE2\x96\x82", "\xE2\x96\x83", "\xE2\x96\x84",
+                               "\xE2\x96\x85", "\xE2\x96\x86", "\xE2\x96\x87", "\xE2\x96\x88"};
+
+// Bytes per second since the previous sample; a gap when the counter is
+// unknown or went backwards (container restarted).
+float Rate(uint64_t current, uint64_t previous, double seconds) {
+    if (seconds <= 0.0 || current < previous) return kGap;
+    return static_cast<float>((current - previous) / seconds);
+}
+
+}  // namespace
+
+MetricsHistory::MetricsHistory(std::chrono::milliseconds resolution, size_t capacity,
+                               size_t maxContainers)
+    : resolution(resolution.count() > 0 ? resolution : std::chrono::milliseconds(1000)),
+      capacity(capacity > 0 ? capacity : 1),
+      maxContainers(maxContainers > 0 ? maxContainers : 1),
+      origin(std::chrono::steady_clock::now()),
+      currentBucket(-1), generation(0) {}
+
+void MetricsHistory::Record(const std::vector<ContainerStats>& frame,
+                            std::chrono::steady_clock::time_point now) {
+    const int64_t bucket = std::max<int64_t>(0, (now - origin) / resolution);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    currentBucket = std::max(currentBucket, bucket);
+
+    for (const auto& row : frame) {
+        Slot& slot = slots[AcquireSlot(row.id)];
+        if (bucket < slot.lastBucket) continue;  // clock skew between frames
+        AdvanceTo(slot, bucket);
+
+        const size_t index = static_cast<size_t>(bucket % static_cast<int64_t>(capacity));
+        Row(slot, Cpu)[index] = static_cast<float>(row.cpu_percent);
+        Row(slot, Memory)[index] = static_cast<float>(row.mem_bytes);
+
+        const uint64_t net = row.net_rx + row.net_tx;
+        const uint64_t block = row.block_read + row.block_write;
+        const bool first = slot.lastSample == std::chrono::steady_clock::time_point();
+        const double seconds =
+            first ? 0.0 : std::chrono::duration<double>(now - slot.lastSample).count();
+        Row(slot, NetIO)[index] = row.has_net_io ? Rate(net, slot.lastNet, seconds) : kGap;
+        Row(slot, BlockIO)[index] = Rate(block, slot.lastBlock, seconds);
+
+        slot.lastNet = net;
+        slot.lastBlock = block;
+        slot.lastSample = now;
+    }
+    ++generation;
+}
+
+size_t MetricsHistory::AcquireSlot(const std::string& id) {
+    auto it = slotById.find(id);
+    if (it != slotById.end()) return it->second;
+
+    size_t index;
+    if (slots.size() < maxContainers) {
+        index = slots.size();
+        slots.emplace_back();
+        slots.back().values.resize(SeriesCount * capacity);
+    } else {
+        // Reuse the slot of the container seen longest ago.
+        index = 0;
+        for (size_t i = 1; i < slots.size(); ++i) {
+            if (slots[i].lastBucket < slots[index].lastBucket) index = i;
+        }
+        slotById.erase(slots[index].id);
+    }
+
+    Slot& slot = slots[index];
+    slot.id = id;
+    std::fill(slot.values.begin(), slot.values.end(), kGap);
+    slot.lastBucket = -1;
+    slot.lastNet = 0;
+    slot.lastBlock = 0;
+    slot.lastSample = std::chrono::steady_clock::time_point();
+    slotById[id] = index;
+    return index;
+}
+
+void MetricsHistory::AdvanceTo(Slot& slot, int64_t bucket) {
+    if (slot.lastBucket >= bucket) return;
+    // Buckets skipped since the last sample become gaps; at most one full lap.
+    int64_t from = std::max(slot.lastBucket + 1, bucket - static_cast<int64_t>(capacity) + 1);
+    for (int64_t b = from; b <= bucket; ++b) {
+        const size_t index = static_cast<size_t>(b % static_cast<int64_t>(capacity));
+        for (int s = 0; s < SeriesCount; ++s) slot.values[s * capacity + index] = kGap;
+    }
+    slot.lastBucket = bucket;
+}
+
+std::vector<float> MetricsHistory::Unroll(const Slot& slot, Series series) const {
+    std::vector<float> out(capacity, kGap);
+    const float* row = &slot.values[series * capacity];
+    const int64_t first = currentBucket - static_cast<int64_t>(capacity) + 1;
+    for (size_t i = 0; i < capacity; ++i) {
+        const int64_t b = first + static_cast<int64_t>(i);
+        if (b < 0 || b > slot.lastBucket || b <= slot.lastBucket - static_cast<int64_t>(capacity)) {
+            continue;
+        }
+        out[i] = row[b % static_cast<int64_t>(capacity)];
+    }
+    return out;
+}
+
+std::vector<float> MetricsHistory::GetSeries(const std::string& id, Series series) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = slotById.find(id);
+    if (it == slotById.end()) return std::vector<float>();
+    return Unroll(slots[it->second], series);
+}
+
+bool MetricsHistory::Summarize(const std::string& id, Series series, Summary& summary) const {
+    return SummarizeValues(GetSeries(id, series), summary);
+}
+
+bool MetricsHistory::SummarizeValues(const std::vector<float>& values, Summary& summary) {
+    summary = Summary();
+    double sum = 0.0;
+    for (float v : values) {
+        if (std::isnan(v)) continue;
+        if (summary.samples == 0 || v < summary.min) summary.min = v;
+        if (summary.samples == 0 || v > summary.max) summary.max = v;
+        summary.last = v;
+        sum += v;
+        ++summary.samples;
+    }
+    if (summary.samples == 0) return false;
+    summary.avg = sum / summary.samples;
+    return true;
+}
+
+std::string MetricsHistory::Sparkline(const std::string& id, Series series, size_t width,
+                                      double ceiling) const {
+    return SparklineFromValues(GetSeries(id, series), width, ceiling);
+}
+
+std::string MetricsHistory::SparklineFromValues(const std::vector<float>& values, size_t width,
+                                                double ceiling) {
+    if (values.empty() || width == 0) return std::string();
+    width = std::min(width, values.size());
+
+    // Each character averages an equal share of the samples.
+    std::vector<float> columns(width, kGap);
+    double top = 0.0;
+    for (size_t c = 0; c < width; ++c) {
+        const size_t begin = c * values.size() / width;
+        const size_t end = (c + 1) * values.size() / width;
+        double sum = 0.0;
+        size_t count = 0;
+        for (size_t i = begin; i < end; ++i) {
+            if (std::isnan(values[i])) continue;
+            sum += values[i];
+            ++count;
+        }
+        if (count == 0) continue;
+        columns[c] = static_cast<float>(sum / count);
+        top = std::max(top, static_cast<double>(columns[c]));
+    }
+    if (ceiling > 0.0) top = ceiling;
+
+    std::string out;
+    out.reserve(width * 3);
+    for (float v : columns) {
+        if (std::isnan(v)) {
+            out += ' ';
+            continue;
+        }
+        int level = top > 0.0 ? static_cast<int>(std::lround(v / top * 7.0)) : 0;
+        out += kBlocks[std::min(7, std::max(0, level))];
+    }
+    return out;
+}
+
+uint64_t MetricsHistory::Generation() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return generation;
+}
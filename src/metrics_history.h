@@ -0,0 +1,88 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct ContainerStats;
+
+// Recent samples of every container, kept in fixed-size ring buffers: one
+// slot per container, each holding a contiguous array per series. Slots are
+// allocated once and reused, so memory is bounded by
+// maxContainers * SeriesCount * capacity floats however long the manager runs.
+//
+// Time is divided into buckets of `resolution`; every stats frame lands in the
+// current bucket and buckets a container missed are recorded as gaps, so all
+// series stay aligned on the same clock.
+class MetricsHistory {
+public:
+    enum Series {
+        Cpu,       // percent of one core
+        Memory,    // bytes
+        NetIO,     // received + sent, bytes per second
+        BlockIO,   // read + written, bytes per second
+        SeriesCount
+    };
+
+    struct Summary {
+        double min = 0.0;
+        double avg = 0.0;
+        double max = 0.0;
+        double last = 0.0;
+        size_t samples = 0;
+    };
+
+    MetricsHistory(std::chrono::milliseconds resolution, size_t capacity, size_t maxContainers);
+
+    void Record(const std::vector<ContainerStats>& frame,
+                std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+
+    // Oldest first; gaps are NaN. Empty when the container has no history.
+    std::vector<float> GetSeries(const std::string& id, Series series) const;
+    bool Summarize(const std::string& id, Series series, Summary& summary) const;
+
+    // `width` block characters (U+2581..U+2588) scaled to the series maximum,
+    // or to `ceiling` when it is positive. Gaps are drawn as spaces.
+    std::string Sparkline(const std::string& id, Series series, size_t width,
+                          double ceiling = 0.0) const;
+
+    // Bumped by every Record(); lets readers skip redrawing unchanged data.
+    uint64_t Generation() const;
+
+    size_t Capacity() const { return capacity; }
+    std::chrono::milliseconds Resolution() const { return resolution; }
+
+    static bool SummarizeValues(const std::vector<float>& values, Summary& summary);
+    static std::string SparklineFromValues(const std::vector<float>& values, size_t width,
+                                           double ceiling);
+
+private:
+    struct Slot {
+        std::string id;
+        std::vector<float> values;   // SeriesCount rows of `capacity` floats
+        int64_t lastBucket = -1;     // bucket of the newest value
+        uint64_t lastNet = 0;
+        uint64_t lastBlock = 0;
+        std::chrono::steady_clock::time_point lastSample;
+    };
+
+    const std::chrono::milliseconds resolution;
+    const size_t capacity;
+    const size_t maxContainers;
+    const std::chrono::steady_clock::time_point origin;
+
+    mutable std::mutex mutex;
+    std::vector<Slot> slots;
+    std::unordered_map<std::string, size_t> slotById;
+    int64_t currentBucket;
+    uint64_t generation;
+
+    size_t AcquireSlot(const std::string& id);
+    void AdvanceTo(Slot& slot, int64_t bucket);
+    float* Row(Slot& slot, Series series) { return &slot.values[series * capacity]; }
+    std::vector<float> Unroll(const Slot& slot, Series series) const;
+};
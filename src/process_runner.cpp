@@ -0,0 +1,160 @@
+#include "process_runner.h"
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+namespace {
+
+void CloseFd(int& fd) {
+    if (fd >= 0) close(fd);
+    fd = -1;
+}
+
+}  // namespace
+
+ChildProcess::~ChildProcess() {
+    if (pid > 0) {
+        kill(pid, SIGKILL);
+        Wait();
+    }
+    CloseFd(outFd);
+    CloseFd(errFd);
+}
+
+bool ChildProcess::Start(const std::vector<std::string>& argv, bool captureStderr,
+                         std::string* error) {
+    if (argv.empty() || pid > 0) return false;
+
+    int outPipe[2] = {-1, -1};
+    int errPipe[2] = {-1, -1};
+    if (pipe2(outPipe, O_CLOEXEC) != 0 || (captureStderr && pipe2(errPipe, O_CLOEXEC) != 0)) {
+        if (error) *error = std::string("pipe: ") + std::strerror(errno);
+        CloseFd(outPipe[0]);
+        CloseFd(outPipe[1]);
+        return false;
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+    posix_spawn_file_actions_adddup2(&actions, outPipe[1], STDOUT_FILENO);
+    if (captureStderr) {
+        posix_spawn_file_actions_adddup2(&actions, errPipe[1], STDERR_FILENO);
+    } else {
+        posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+    }
+
+    // Worker threads may have signals blocked; the child should not inherit that.
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    sigset_t mask;
+    sigemptyset(&mask);
+    posix_spawnattr_setsigmask(&attr, &mask);
+    sigset_t defaults;
+    sigemptyset(&defaults);
+    sigaddset(&defaults, SIGPIPE);
+    posix_spawnattr_setsigdefault(&attr, &defaults);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+
+    std::vector<char*> args;
+    args.reserve(argv.size() + 1);
+    for (const auto& arg : argv) args.push_back(const_cast<char*>(arg.c_str()));
+    args.push_back(nullptr);
+
+    pid_t child = -1;
+    int rc = posix_spawnp(&child, args[0], &actions, &attr, args.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attr);
+
+    CloseFd(outPipe[1]);
+    CloseFd(errPipe[1]);
+    if (rc != 0) {
+        if (error) *error = argv[0] + ": " + std::strerror(rc);
+        CloseFd(outPipe[0]);
+        CloseFd(errPipe[0]);
+        return false;
+    }
+
+    pid = child;
+    outFd = outPipe[0];
+    errFd = errPipe[0];
+    return true;
+}
+
+void ChildProcess::Signal(int sig) {
+    if (pid > 0) kill(pid, sig);
+}
+
+int ChildProcess::Wait() {
+    if (pid <= 0) return -1;
+    int status = 0;
+    pid_t rc;
+    do {
+        rc = waitpid(pid, &status, 0);
+    } while (rc < 0 && errno == EINTR);
+    pid = -1;
+    if (rc < 0) return -1;
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+CommandResult ProcessRunner::Run(const std::vector<std::string>& argv, int timeoutMs) {
+    CommandResult result;
+    ChildProcess child;
+    if (!child.Start(argv, true, &result.error)) return result;
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    int fds[2] = {child.StdoutFd(), child.StderrFd()};
+    std::string* sinks[2] = {&result.output, &result.error};
+    char buffer[64 * 1024];
+
+    while (fds[0] >= 0 || fds[1] >= 0) {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        if (left <= 0) {
+            result.timed_out = true;
+            break;
+        }
+
+        pollfd pfds[2];
+        nfds_t count = 0;
+        int which[2];
+        for (int i = 0; i < 2; ++i) {
+            if (fds[i] < 0) continue;
+            pfds[count] = {fds[i], POLLIN, 0};
+            which[count++] = i;
+        }
+
+        int ready = poll(pfds, count, static_cast<int>(left));
+        if (ready < 0 && errno == EINTR) continue;
+        if (ready < 0) break;
+
+        for (nfds_t i = 0; i < count; ++i) {
+            if (!pfds[i].revents) continue;
+            ssize_t n = read(pfds[i].fd, buffer, sizeof(buffer));
+            if (n < 0 && (errno == EINTR || errno == EAGAIN)) continue;
+            if (n <= 0) {
+                // The descriptor itself is owned and closed by `child`.
+                fds[which[i]] = -1;
+                continue;
+            }
+            sinks[which[i]]->append(buffer, n);
+        }
+    }
+
+    // Never block in Wait() on a child whose output we stopped reading.
+    if (fds[0] >= 0 || fds[1] >= 0) child.Signal(SIGKILL);
+    if (result.timed_out) {
+        result.error += "timed out after " + std::to_string(timeoutMs) + " ms";
+    }
+    int status = child.Wait();
+    result.exit_code = result.timed_out ? -1 : status;
+    return result;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+struct CommandResult {
+    std::string output;
+    std::string error;      // the child's stderr, or why it could not be run
+    int exit_code = -1;
+    bool timed_out = false;
+};
+
+// A child started with posix_spawn from an argv vector; no shell is involved,
+// so arguments are passed through verbatim. stdin is /dev/null.
+class ChildProcess {
+public:
+    ChildProcess() = default;
+    ~ChildProcess();
+
+    // With captureStderr false the child's stderr goes to /dev/null.
+    bool Start(const std::vector<std::string>& argv, bool captureStderr,
+               std::string* error = nullptr);
+
+    pid_t Pid() const { return pid; }
+    int StdoutFd() const { return outFd; }
+    int StderrFd() const { return errFd; }
+
+    void Signal(int sig);
+    // Reaps the child; returns its exit status or -1 if it did not exit normally.
+    int Wait();
+
+private:
+    ChildProcess(const ChildProcess&) = delete;
+    ChildProcess& operator=(const ChildProcess&) = delete;
+
+    pid_t pid = -1;
+    int outFd = -1;
+    int errFd = -1;
+};
+
+class ProcessRunner {
+public:
+    static const int kDefaultTimeoutMs = 30000;
+
+    // Runs argv to completion, collecting stdout and stderr separately. Once
+    // timeoutMs has elapsed the child is killed and timed_out is set.
+    static CommandResult Run(const std::vector<std::string>& argv,
+                             int timeoutMs = kDefaultTimeoutMs);
+};
@@ -0,0 +1,116 @@
+#include "prune_dialog.h"
+#include "byte_size.h"
+
+namespace {
+
+enum {
+    ID_PRUNE_ITEMS = wxID_HIGHEST + 1,
+    ID_PRUNE_EXTRAS
+};
+
+const char* KindName(PruneKind kind) {
+    switch (kind) {
+        case PruneKind::Container: return "Container";
+        case PruneKind::Image: return "Image";
+        default: return "Volume";
+    }
+}
+
+wxString Bytes(int64_t bytes) {
+    if (bytes < 0) return wxT("size unknown");
+    return wxString::FromUTF8(FormatDecimalBytes(static_cast<double>(bytes)).c_str());
+}
+
+wxString ItemText(const PruneItem& item) {
+    wxString text = wxString::Format(wxT("%s  %s  (%s)"), KindName(item.kind),
+                                     wxString::FromUTF8(item.label.c_str()), Bytes(item.bytes));
+    if (!item.neededBy.empty()) {
+        text += wxT("  - kept, needed by ") + wxString::FromUTF8(item.neededBy.c_str());
+    }
+    return text;
+}
+
+}  // namespace
+
+wxBEGIN_EVENT_TABLE(PruneDialog, wxDialog)
+    EVT_CHECKLISTBOX(ID_PRUNE_ITEMS, PruneDialog::OnItemToggled)
+    EVT_CHECKBOX(ID_PRUNE_EXTRAS, PruneDialog::OnExtrasToggled)
+wxEND_EVENT_TABLE()
+
+PruneDialog::PruneDialog(wxWindow* parent, const DependencyGraph& graph,
+                         DependencyGraph::ImageBytes imageBytes)
+    : wxDialog(parent, wxID_ANY, wxT("Prune"), wxDefaultPosition, wxSize(700, 500),
+               wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER),
+      graph(graph), imageBytes(std::move(imageBytes)),
+      keep(graph.Candidates().size(), false) {
+    wxBoxSizer* sizer = new wxBoxSizer(wxVERTICAL);
+
+    summaryLabel = new wxStaticText(this, wxID_ANY, wxEmptyString);
+    sizer->Add(summaryLabel, 0, wxEXPAND | wxALL, 5);
+
+    itemsList = new wxCheckListBox(this, ID_PRUNE_ITEMS);
+    for (const PruneItem& item : graph.Candidates()) itemsList->Append(ItemText(item));
+    sizer->Add(itemsList, 1, wxEXPAND | wxLEFT | wxRIGHT, 5);
+
+    wxString extras = wxT("Also prune unused networks and build cache");
+    if (graph.BuildCacheBytes() > 0) {
+        extras += wxString::Format(wxT(" (%s of cache)"), Bytes(graph.BuildCacheBytes()));
+    }
+    extrasCheck = new wxCheckBox(this, ID_PRUNE_EXTRAS, extras);
+    extrasCheck->SetValue(true);
+    sizer->Add(extrasCheck, 0, wxALL, 5);
+
+    wxBoxSizer* buttonSizer = new wxBoxSizer(wxHORIZONTAL);
+    removeButton = new wxButton(this, wxID_OK, wxT("Remove selected"));
+    buttonSizer->Add(removeButton, 0, wxALL, 5);
+    buttonSizer->Add(new wxButton(this, wxID_CANCEL, wxT("Cancel")), 0, wxALL, 5);
+    sizer->Add(buttonSizer, 0, wxALIGN_RIGHT | wxALL, 5);
+
+    SetSizer(sizer);
+    Replan();
+    Centre();
+}
+
+bool PruneDialog::PruneNetworksAndBuildCache() const {
+    return extrasCheck->GetValue();
+}
+
+void PruneDialog::Replan() {
+    PrunePlan next = graph.Plan(keep, imageBytes);
+    const bool first = plan.items.empty();
+    itemsList->Freeze();
+    for (size_t i = 0; i < next.items.size(); ++i) {
+        const unsigned int index = static_cast<unsigned int>(i);
+        if (first || next.items[i].neededBy != plan.items[i].neededBy) {
+            itemsList->SetString(index, ItemText(next.items[i]));
+        }
+        itemsList->Check(index, next.items[i].remove);
+    }
+    itemsList->Thaw();
+    plan.items.swap(next.items);
+    plan.bytes = next.bytes;
+    plan.bytesExact = next.bytesExact;
+    plan.imageRounds.swap(next.imageRounds);
+
+    const size_t containers = plan.Removed(PruneKind::Container).size();
+    const size_t images = plan.Removed(PruneKind::Image).size();
+    const size_t volumes = plan.Removed(PruneKind::Volume).size();
+    summaryLabel->SetLabel(wxString::Format(
+        wxT("Frees %s%s: %d containers, %d images, %d volumes."),
+        plan.bytesExact ? wxT("") : wxT("at least "), Bytes(plan.bytes),
+        static_cast<int>(containers), static_cast<int>(images), static_cast<int>(volumes)));
+    removeButton->Enable(containers + images + volumes > 0 || extrasCheck->GetValue());
+}
+
+void PruneDialog::OnItemToggled(wxCommandEvent& event) {
+    const int index = event.GetInt();
+    if (index < 0 || static_cast<size_t>(index) >= keep.size()) return;
+    // Ticking an item that something kept needs changes nothing; Replan()
+    // unticks it again and the line says why.
+    keep[index] = !itemsList->IsChecked(static_cast<unsigned int>(index));
+    Replan();
+}
+
+void PruneDialog::OnExtrasToggled(wxCommandEvent& event) {
+    Replan();
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <wx/wx.h>
+#include <wx/checklst.h>
+#include <vector>
+#include "dependency_graph.h"
+
+// Dry run of a prune: every object it would remove, ticked. Unticking one
+// keeps it, and with it whatever it needs (a container's image and
+// volumes, an image's parents); the plan and the bytes it frees are
+// recomputed on each click.
+class PruneDialog : public wxDialog {
+public:
+    PruneDialog(wxWindow* parent, const DependencyGraph& graph,
+                DependencyGraph::ImageBytes imageBytes);
+
+    const PrunePlan& GetPlan() const { return plan; }
+    bool PruneNetworksAndBuildCache() const;
+
+private:
+    const DependencyGraph& graph;
+    DependencyGraph::ImageBytes imageBytes;
+    std::vector<bool> keep;  // per candidate, unticked by the user
+    PrunePlan plan;
+
+    wxStaticText* summaryLabel;
+    wxCheckListBox* itemsList;
+    wxCheckBox* extrasCheck;
+    wxButton* removeButton;
+
+    void Replan();
+    void OnItemToggled(wxCommandEvent& event);
+    void OnExtrasToggled(wxCommandEvent& event);
+
+    wxDECLARE_EVENT_TABLE();
+};
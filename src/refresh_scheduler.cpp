@@ -0,0 +1,92 @@
+#include "refresh_scheduler.h"
+#include <algorithm>
+
+RefreshScheduler::RefreshScheduler() : iconized(false) {
+    const Clock::time_point now = Clock::now();
+    for (auto& state : states) state.due = now;
+}
+
+void RefreshScheduler::SetIntervals(Resource resource, int baseMs, int maxMs) {
+    State& state = states[resource];
+    state.baseMs = std::max(1, baseMs);
+    state.maxMs = std::max(state.baseMs, maxMs);
+    state.intervalMs = state.baseMs;
+}
+
+void RefreshScheduler::SetVisible(Resource resource, bool visible) {
+    State& state = states[resource];
+    if (state.visible == visible) return;
+    state.visible = visible;
+    // Coming into view: fetch now rather than after the slow interval.
+    if (visible) state.due = std::min(state.due, Clock::now());
+}
+
+void RefreshScheduler::SetPaused(Resource resource, bool paused) {
+    State& state = states[resource];
+    if (state.paused == paused) return;
+    state.paused = paused;
+    if (!paused) {
+        state.intervalMs = state.baseMs;
+        state.due = Clock::now();
+    }
+}
+
+void RefreshScheduler::SetIconized(bool value) {
+    iconized = value;
+}
+
+bool RefreshScheduler::IsActive(const State& state) const {
+    return !iconized && !state.paused && !state.inFlight;
+}
+
+int RefreshScheduler::EffectiveIntervalMs(const State& state) const {
+    return state.visible ? state.intervalMs : state.maxMs;
+}
+
+unsigned RefreshScheduler::TakeDue(Clock::time_point now) {
+    unsigned due = 0;
+    for (int r = 0; r < ResourceCount; ++r) {
+        State& state = states[r];
+        if (!IsActive(state) || state.due > now) continue;
+        state.inFlight = true;
+        due |= 1u << r;
+    }
+    return due;
+}
+
+void RefreshScheduler::Completed(Resource resource, bool changed, Clock::time_point now) {
+    State& state = states[resource];
+    state.inFlight = false;
+    state.intervalMs = changed ? state.baseMs : std::min(state.maxMs, state.intervalMs * 2);
+    // A fetch that started before a user action may have missed its effect.
+    if (state.boosted) {
+        state.intervalMs = state.baseMs;
+        state.due = now;
+    } else {
+        state.due = now + std::chrono::milliseconds(EffectiveIntervalMs(state));
+    }
+    state.boosted = false;
+}
+
+void RefreshScheduler::Boost(Clock::time_point now) {
+    for (auto& state : states) {
+        state.intervalMs = state.baseMs;
+        state.due = now;
+        state.boosted = state.inFlight;
+    }
+}
+
+int RefreshScheduler::MillisUntilNext(Clock::time_point now) const {
+    int next = -1;
+    for (const auto& state : states) {
+        if (!IsActive(state)) continue;
+        auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(state.due - now).count();
+        int ms = static_cast<int>(std::max<long long>(0, wait));
+        if (next < 0 || ms < next) next = ms;
+    }
+    return next;
+}
+
+int RefreshScheduler::CurrentIntervalMs(Resource resource) const {
+    return EffectiveIntervalMs(states[resource]);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <chrono>
+
+// Decides when each kind of data is fetched again. Every resource has its
+// own base interval; a fetch that returns the same data as before doubles
+// the interval up to a ceiling, and any change drops it back to the base.
+// Resources nobody can see are held at their ceiling, and everything stops
+// while the window is minimized. A user action (Boost) makes everything due
+// immediately at the base interval.
+//
+// Not thread-safe; the frame drives it from the UI thread.
+class RefreshScheduler {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    // VolumeSizes are measured on disk rather than asked of the daemon.
+    enum Resource { Containers, Images, Volumes, Stats, VolumeSizes, ResourceCount };
+
+    RefreshScheduler();
+
+    void SetIntervals(Resource resource, int baseMs, int maxMs);
+
+    // Hidden resources are fetched at their slowest interval.
+    void SetVisible(Resource resource, bool visible);
+    // Paused resources are never due, e.g. lists kept live by the event stream.
+    void SetPaused(Resource resource, bool paused);
+    // Nothing is due while the window is minimized.
+    void SetIconized(bool iconized);
+
+    // Bit mask (1 << Resource) of resources due at `now`; they count as
+    // in flight until Completed().
+    unsigned TakeDue(Clock::time_point now = Clock::now());
+    void Completed(Resource resource, bool changed, Clock::time_point now = Clock::now());
+
+    // Back to the base intervals with everything due now.
+    void Boost(Clock::time_point now = Clock::now());
+
+    // Milliseconds until the next resource is due, 0 if one is due already,
+    // -1 if nothing will be due until something changes.
+    int MillisUntilNext(Clock::time_point now = Clock::now()) const;
+
+    int CurrentIntervalMs(Resource resource) const;
+
+private:
+    struct State {
+        int baseMs = 3000;
+        int maxMs = 60000;
+        int intervalMs = 3000;
+        bool visible = true;
+        bool paused = false;
+        bool inFlight = false;
+        bool boosted = false;  // Boost() arrived while in flight
+        Clock::time_point due;
+    };
+
+    State states[ResourceCount];
+    bool iconized;
+
+    bool IsActive(const State& state) const;
+    int EffectiveIntervalMs(const State& state) const;
+};
@@ -0,0 +1,43 @@
+#include "request_gate.h"
+
+AdmissionGate::AdmissionGate(size_t limit)
+    : limit(limit > 0 ? limit : 1), active(0), waiting(0) {}
+
+void AdmissionGate::SetLimit(size_t value) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        limit = value > 0 ? value : 1;
+    }
+    available.notify_all();
+}
+
+void AdmissionGate::Acquire() {
+    std::unique_lock<std::mutex> lock(mutex);
+    ++waiting;
+    available.wait(lock, [this] { return active < limit; });
+    --waiting;
+    ++active;
+}
+
+void AdmissionGate::Release() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        --active;
+    }
+    available.notify_one();
+}
+
+size_t AdmissionGate::Limit() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return limit;
+}
+
+size_t AdmissionGate::Active() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return active;
+}
+
+size_t AdmissionGate::Waiting() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return waiting;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <string>
+
+// Counting semaphore that also reports how many callers are waiting, so a
+// slow daemon shows up as queue depth rather than as more processes.
+class AdmissionGate {
+public:
+    explicit AdmissionGate(size_t limit);
+
+    // Takes effect for the next Acquire(); running calls are not interrupted.
+    void SetLimit(size_t limit);
+
+    void Acquire();
+    void Release();
+
+    size_t Limit() const;
+    size_t Active() const;
+    size_t Waiting() const;
+
+    // Holds one slot for its lifetime.
+    class Slot {
+    public:
+        explicit Slot(AdmissionGate& gate) : gate(gate) { gate.Acquire(); }
+        ~Slot() { gate.Release(); }
+
+        Slot(const Slot&) = delete;
+        Slot& operator=(const Slot&) = delete;
+
+    private:
+        AdmissionGate& gate;
+    };
+
+private:
+    mutable std::mutex mutex;
+    std::condition_variable available;
+    size_t limit;
+    size_t active;
+    size_t waiting;
+};
+
+// Deduplicates identical calls in flight: while one caller runs `fn` for a
+// key, later callers with the same key wait for it and receive a copy of
+// its result instead of issuing their own request.
+template <typename T>
+class SingleFlight {
+public:
+    // `shared` is set when the result came from another caller's call.
+    T Do(const std::string& key, const std::function<T()>& fn, bool* shared = nullptr) {
+        std::unique_lock<std::mutex> lock(mutex);
+        auto it = inFlight.find(key);
+        if (it != inFlight.end()) {
+            std::shared_future<T> result = it->second;
+            lock.unlock();
+            if (shared) *shared = true;
+            return result.get();
+        }
+
+        std::promise<T> promise;
+        inFlight[key] = promise.get_future().share();
+        lock.unlock();
+
+        // Waiters get the result or the exception; either way the key is
+        // free for the next call once this one is done.
+        Release release(*this, key);
+        if (shared) *shared = false;
+        try {
+            T value = fn();
+            promise.set_value(value);
+            return value;
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+            throw;
+        }
+    }
+
+private:
+    struct Release {
+        SingleFlight& owner;
+        const std::string& key;
+        Release(SingleFlight& owner, const std::string& key) : owner(owner), key(key) {}
+        ~Release() {
+            std::lock_guard<std::mutex> lock(owner.mutex);
+            owner.inFlight.erase(key);
+        }
+    };
+
+
+    std::mutex mutex;
+    std::map<std::string, std::shared_future<T>> inFlight;
+};
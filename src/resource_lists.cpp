@@ -0,0 +1,316 @@
+#include "resource_lists.h"
+#include "byte_size.h"
+#include "stats_collector.h"
+#include <cstdio>
+
+namespace {
+
+// Characters per sparkline; each covers 1/20 of the history window.
+const size_t kSparklineWidth = 20;
+
+std::string FormatPercent(double value) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.1f%%", value);
+    return buf;
+}
+
+std::string FormatRate(double value) {
+    return FormatBinaryBytes(value) + "/s";
+}
+
+// "CPU: min 0.1%  avg 2.3%  max 15.2%", or nothing without samples.
+std::string SummaryLine(const char* label, const MetricsHistory& history, const std::string& id,
+                        MetricsHistory::Series series, std::string (*format)(double)) {
+    MetricsHistory::Summary summary;
+    if (!history.Summarize(id, series, summary)) return std::string();
+    return std::string(label) + ": min " + format(summary.min) + "  avg " + format(summary.avg) +
+           "  max " + format(summary.max) + "\n";
+}
+
+}  // namespace
+
+ContainerListCtrl::ContainerListCtrl(wxWindow* parent, wxWindowID id)
+    : VirtualListCtrl<ContainerRow>(parent, id),
+      historyGeneration(0), tooltipItem(-1), tooltipGeneration(0) {
+    AppendColumn(wxT("ID"),     wxLIST_FORMAT_LEFT, 100);
+    AppendColumn(wxT("Name"),   wxLIST_FORMAT_LEFT, 200);
+    AppendColumn(wxT("State"),  wxLIST_FORMAT_LEFT, 80);
+    AppendColumn(wxT("CPU"),    wxLIST_FORMAT_LEFT, 190);
+    AppendColumn(wxT("Memory"), wxLIST_FORMAT_LEFT, 210);
+    AppendColumn(wxT("Status"), wxLIST_FORMAT_LEFT, 220);
+    AppendColumn(wxT("Image"),  wxLIST_FORMAT_LEFT, 300);
+
+    runningAttr.SetBackgroundColour(wxColour(200, 255, 200));  // green
+    pausedAttr.SetBackgroundColour(wxColour(255, 255, 180));   // yellow
+    stoppedAttr.SetBackgroundColour(wxColour(255, 210, 210));  // red
+
+    Bind(wxEVT_MOTION, &ContainerListCtrl::OnMotion, this);
+}
+
+StringRef ContainerListCtrl::Cell(const ContainerRow& row, long column) const {
+    switch (column) {
+        case 0: return row.id;
+        case 1: return row.name;
+        case 2: return ContainerStateName(row.state);
+        // Sparklines are drawn in OnGetItemText() for the visible rows only;
+        // comparing them here would build one for every row on each refresh.
+        case 3:
+        case 4: return StringRef();
+        case 5: return row.status;
+        default: return row.image;
+    }
+}
+
+bool ContainerListCtrl::Less(const ContainerRow& a, const ContainerRow& b, long column) const {
+    switch (column) {
+        case 2: return a.state < b.state;
+        case 5: {
+            // Running containers by uptime, then the rest by time since exit.
+            const bool upA = a.state == ContainerState::Running || a.state == ContainerState::Paused;
+            const bool upB = b.state == ContainerState::Running || b.state == ContainerState::Paused;
+            if (upA != upB) return upA;
+            return a.statusSeconds < b.statusSeconds;
+        }
+        default: return VirtualListCtrl<ContainerRow>::Less(a, b, column);
+    }
+}
+
+bool ContainerListCtrl::Sortable(long column) const {
+    // The sparkline columns change every few seconds.
+    return column != 3 && column != 4 && VirtualListCtrl<ContainerRow>::Sortable(column);
+}
+
+wxString ContainerListCtrl::OnGetItemText(long item, long column) const {
+    if (column != 3 && column != 4) {
+        return VirtualListCtrl<ContainerRow>::OnGetItemText(item, column);
+    }
+    const ContainerRow* row = GetRow(item);
+    if (!row) return wxString();
+    const Sparklines& lines = GetSparklines(row->id.str());
+    const std::string& text = column == 3 ? lines.cpu : lines.memory;
+    return wxString::FromUTF8(text.data(), text.size());
+}
+
+wxListItemAttr* ContainerListCtrl::OnGetItemAttr(long item) const {
+    const ContainerRow* row = GetRow(item);
+    if (!row) return nullptr;
+    if (row->state == ContainerState::Running) return &runningAttr;
+    if (row->state == ContainerState::Paused) return &pausedAttr;
+    return &stoppedAttr;
+}
+
+void ContainerListCtrl::RefreshHistory() {
+    uint64_t generation = StatsCollector::Instance().GetHistory().Generation();
+    if (generation == historyGeneration) return;
+    historyGeneration = generation;
+    sparklines.clear();
+
+    long count = GetItemCount();
+    if (count == 0) return;
+    long top = std::max(0L, GetTopItem());
+    long bottom = std::min(count - 1, top + GetCountPerPage());
+    RefreshItems(top, bottom);
+}
+
+const ContainerListCtrl::Sparklines& ContainerListCtrl::GetSparklines(const std::string& id) const {
+    auto it = sparklines.find(id);
+    if (it != sparklines.end()) return it->second;
+    // Scrolling leaves lines behind; keep about one page of them.
+    if (sparklines.size() > 2 * static_cast<size_t>(GetCountPerPage() + 1)) TrimSparklines();
+
+    const MetricsHistory& history = StatsCollector::Instance().GetHistory();
+    Sparklines& lines = sparklines[id];
+    MetricsHistory::Summary summary;
+    // CPU is drawn against one full core so idle containers stay flat.
+    std::vector<float> values = history.GetSeries(id, MetricsHistory::Cpu);
+    if (MetricsHistory::SummarizeValues(values, summary)) {
+        lines.cpu = MetricsHistory::SparklineFromValues(values, kSparklineWidth, 100.0) + " " +
+                    FormatPercent(summary.last);
+    }
+    values = history.GetSeries(id, MetricsHistory::Memory);
+    if (MetricsHistory::SummarizeValues(values, summary)) {
+        lines.memory = MetricsHistory::SparklineFromValues(values, kSparklineWidth, 0.0) + " " +
+                       FormatBinaryBytes(summary.last);
+    }
+    return lines;
+}
+
+void ContainerListCtrl::TrimSparklines() const {
+    std::unordered_map<std::string, Sparklines> visible;
+    const long top = std::max(0L, GetTopItem());
+    for (long i = top; i <= top + GetCountPerPage(); ++i) {
+        const ContainerRow* row = GetRow(i);
+        if (!row) break;
+        auto it = sparklines.find(row->id.str());
+        if (it != sparklines.end()) visible.insert(*it);
+    }
+    sparklines.swap(visible);
+}
+
+wxString ContainerListCtrl::HistoryTooltip(const std::string& id) const {
+    const MetricsHistory& history = StatsCollector::Instance().GetHistory();
+    std::string text = SummaryLine("CPU", history, id, MetricsHistory::Cpu, FormatPercent) +
+                       SummaryLine("Memory", history, id, MetricsHistory::Memory, FormatBinaryBytes) +
+                       SummaryLine("Net I/O", history, id, MetricsHistory::NetIO, FormatRate) +
+                       SummaryLine("Block I/O", history, id, MetricsHistory::BlockIO, FormatRate);
+    if (text.empty()) return wxString();
+
+    long seconds = static_cast<long>(history.Resolution().count() / 1000);
+    long minutes = static_cast<long>(history.Capacity()) * seconds / 60;
+    text += "Last " + std::to_string(minutes) + " min, one sample every " +
+            std::to_string(seconds) + " s";
+    return wxString::FromUTF8(text.c_str());
+}
+
+void ContainerListCtrl::OnMotion(wxMouseEvent& event) {
+    event.Skip();
+
+    int flags = 0;
+    long item = HitTest(event.GetPosition(), flags);
+    if (item == tooltipItem && historyGeneration == tooltipGeneration) return;
+    tooltipItem = item;
+    tooltipGeneration = historyGeneration;
+
+    const ContainerRow* row = GetRow(item);
+    wxString tip = row ? HistoryTooltip(row->id.str()) : wxString();
+    if (tip.empty()) {
+        UnsetToolTip();
+    } else {
+        SetToolTip(tip);
+    }
+}
+
+ImageListCtrl::ImageListCtrl(wxWindow* parent, wxWindowID id)
+    : VirtualListCtrl<ImageRow>(parent, id) {
+    AppendColumn(wxT("ID"),         wxLIST_FORMAT_LEFT, 120);
+    AppendColumn(wxT("Repository"), wxLIST_FORMAT_LEFT, 280);
+    AppendColumn(wxT("Tag"),        wxLIST_FORMAT_LEFT, 120);
+    AppendColumn(wxT("Size"),       wxLIST_FORMAT_LEFT, 100);
+    AppendColumn(wxT("Unique"),     wxLIST_FORMAT_LEFT, 100);
+    AppendColumn(wxT("Shared"),     wxLIST_FORMAT_LEFT, 100);
+}
+
+void ImageListCtrl::SetUsage(std::unordered_map<std::string, LayerUsage> next) {
+    usage.swap(next);
+    Resort();
+}
+
+int64_t ImageListCtrl::UsageBytes(const ImageRow& row, long column) const {
+    auto it = usage.find(row.id.str());
+    if (it == usage.end()) return -1;
+    return column == 4 ? it->second.unique : it->second.shared;
+}
+
+StringRef ImageListCtrl::Cell(const ImageRow& row, long column) const {
+    switch (column) {
+        case 0: return row.id;
+        case 1: return row.repository;
+        case 2: return row.tag;
+        // Sizes have no text of their own; an image ID fixes its size, so
+        // rows that match on the other columns match on this one too.
+        default: return StringRef();
+    }
+}
+
+bool ImageListCtrl::Less(const ImageRow& a, const ImageRow& b, long column) const {
+    if (column == 3) return a.size < b.size;
+    if (column >= 4) return UsageBytes(a, column) < UsageBytes(b, column);
+    return VirtualListCtrl<ImageRow>::Less(a, b, column);
+}
+
+wxString ImageListCtrl::OnGetItemText(long item, long column) const {
+    if (column < 3) return VirtualListCtrl<ImageRow>::OnGetItemText(item, column);
+    const ImageRow* row = GetRow(item);
+    if (!row) return wxString();
+    const int64_t bytes = column == 3 ? row->size : UsageBytes(*row, column);
+    if (bytes < 0) return wxString();
+    return wxString::FromUTF8(FormatDecimalBytes(static_cast<double>(bytes)).c_str());
+}
+
+VolumeListCtrl::VolumeListCtrl(wxWindow* parent, wxWindowID id, const wxSize& size)
+    : VirtualListCtrl<VolumeRow>(parent, id, size) {
+    AppendColumn(wxT("Name"),   wxLIST_FORMAT_LEFT, 450);
+    AppendColumn(wxT("Driver"), wxLIST_FORMAT_LEFT, 150);
+    AppendColumn(wxT("Size"),   wxLIST_FORMAT_LEFT, 100);
+}
+
+bool VolumeListCtrl::SetSizes(std::unordered_map<std::string, int64_t> next) {
+    if (next == sizes) return false;
+    sizes.swap(next);
+    Resort();
+    return true;
+}
+
+int64_t VolumeListCtrl::SizeOf(const VolumeRow& row) const {
+    auto it = sizes.find(row.name.str());
+    return it == sizes.end() ? -1 : it->second;
+}
+
+StringRef VolumeListCtrl::Cell(const VolumeRow& row, long column) const {
+    switch (column) {
+        case 0: return row.name;
+        case 1: return row.driver;
+        // A size only changes through SetSizes(), which repaints anyway.
+        default: return StringRef();
+    }
+}
+
+bool VolumeListCtrl::Less(const VolumeRow& a, const VolumeRow& b, long column) const {
+    if (column == 2) return SizeOf(a) < SizeOf(b);
+    return VirtualListCtrl<VolumeRow>::Less(a, b, column);
+}
+
+wxString VolumeListCtrl::OnGetItemText(long item, long column) const {
+    if (column < 2) return VirtualListCtrl<VolumeRow>::OnGetItemText(item, column);
+    const VolumeRow* row = GetRow(item);
+    const int64_t bytes = row ? SizeOf(*row) : -1;
+    if (bytes < 0) return wxString();
+    return wxString::FromUTF8(FormatDecimalBytes(static_cast<double>(bytes)).c_str());
+}
+
+JobRow JobRow::FromStatus(const JobStatus& status) {
+    static const char* states[] = {"queued", "running", "done", "failed", "cancelled"};
+
+    JobRow row;
+    row.id = status.id;
+    row.number = std::to_string(status.id);
+    row.title = status.title;
+    row.state = states[status.state];
+    if (status.total > 0) {
+        row.progress = std::to_string(status.done) + " / " + std::to_string(status.total);
+    }
+    row.message = status.message;
+    row.failed = status.state == JobStatus::Failed;
+    return row;
+}
+
+JobListCtrl::JobListCtrl(wxWindow* parent, wxWindowID id)
+    : VirtualListCtrl<JobRow>(parent, id) {
+    AppendColumn(wxT("#"),        wxLIST_FORMAT_LEFT, 50);
+    AppendColumn(wxT("Job"),      wxLIST_FORMAT_LEFT, 320);
+    AppendColumn(wxT("State"),    wxLIST_FORMAT_LEFT, 90);
+    AppendColumn(wxT("Progress"), wxLIST_FORMAT_LEFT, 90);
+    AppendColumn(wxT("Message"),  wxLIST_FORMAT_LEFT, 380);
+
+    failedAttr.SetBackgroundColour(wxColour(255, 210, 210));  // red
+}
+
+StringRef JobListCtrl::Cell(const JobRow& row, long column) const {
+    switch (column) {
+        case 0: return row.number;
+        case 1: return row.title;
+        case 2: return row.state;
+        case 3: return row.progress;
+        default: return row.message;
+    }
+}
+
+bool JobListCtrl::Less(const JobRow& a, const JobRow& b, long column) const {
+    if (column == 0) return a.id < b.id;
+    return VirtualListCtrl<JobRow>::Less(a, b, column);
+}
+
+wxListItemAttr* JobListCtrl::OnGetItemAttr(long item) const {
+    const JobRow* row = GetRow(item);
+    return row && row->failed ? &failedAttr : nullptr;
+}
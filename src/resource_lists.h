@@ -0,0 +1,349 @@
+#pragma once
+
+#include <wx/wx.h>
+#include <wx/listctrl.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "job_queue.h"
+#include "layer_analyzer.h"
+#include "resource_snapshot.h"
+#include "row_view.h"
+
+// Report list in wxLC_VIRTUAL mode: the control never stores rows itself,
+// it asks for the text of whatever is on screen. Cost therefore scales with
+// the visible rows rather than with the number of items.
+//
+// Clicking a column header sorts by that column (again to reverse), and
+// SetFilter() narrows the rows to those containing some text; both live in
+// a RowView, so a refresh keeps them without sorting from scratch.
+template <typename T>
+class VirtualListCtrl : public wxListCtrl {
+public:
+    typedef typename RowView<T>::RowsPtr RowsPtr;
+
+    VirtualListCtrl(wxWindow* parent, wxWindowID id, const wxSize& size = wxDefaultSize)
+        : wxListCtrl(parent, id, wxDefaultPosition, size, wxLC_REPORT | wxLC_VIRTUAL),
+          sortColumn(-1), sortAscending(true) {
+        Bind(wxEVT_LIST_COL_CLICK, &VirtualListCtrl::OnColumnClick, this);
+    }
+
+    // Swaps in a new snapshot, shared rather than copied. The selection
+    // follows its keys to the new positions and only rows whose text
+    // changed are repainted. Returns whether any row changed.
+    bool SetRows(RowsPtr nextPtr) {
+        RowView<T> before = view;
+        view.SetRows(std::move(nextPtr));
+        return Apply(before, true);
+    }
+
+    bool SetRows(const std::vector<T>& next) {
+        return SetRows(std::make_shared<const std::vector<T>>(next));
+    }
+
+    void SetFilter(const std::string& text) {
+        RowView<T> before = view;
+        view.SetFilter(text);
+        Apply(before, false);
+    }
+
+    // Every row of the snapshot, shown or filtered out, in its own order.
+    const std::vector<T>& GetRows() const { return *view.Rows(); }
+
+    // Rows as displayed, after sorting and filtering.
+    const T* GetRow(long index) const {
+        if (index < 0 || index >= static_cast<long>(view.size())) return nullptr;
+        return &view[index];
+    }
+
+    // First selected row.
+    const T* GetSelectedRow() const {
+        return GetRow(GetNextItem(-1, wxLIST_NEXT_ALL, wxLIST_STATE_SELECTED));
+    }
+
+    std::vector<const T*> GetSelectedRows() const {
+        std::vector<const T*> selected;
+        for (long i : GetSelectedIndexes()) {
+            if (const T* row = GetRow(i)) selected.push_back(row);
+        }
+        return selected;
+    }
+
+protected:
+    virtual std::string RowKey(const T& row) const = 0;
+    virtual int ColumnCount() const = 0;
+    virtual StringRef Cell(const T& row, long column) const = 0;
+
+    // Sort order for a column; by default the cell text. Columns that
+    // return false from Sortable() ignore header clicks.
+    virtual bool Less(const T& a, const T& b, long column) const {
+        return Cell(a, column) < Cell(b, column);
+    }
+    virtual bool Sortable(long column) const { return column >= 0 && column < ColumnCount(); }
+
+    wxString OnGetItemText(long item, long column) const override {
+        const T* row = GetRow(item);
+        if (!row || column < 0 || column >= ColumnCount()) return wxString();
+        StringRef text = Cell(*row, column);
+        return wxString::FromUTF8(text.data(), text.size());
+    }
+
+    // Sorts from scratch and repaints the page, for when Less() or the
+    // text depends on data kept outside the rows and that data changed.
+    void Resort() {
+        RowView<T> before = view;
+        if (sortColumn >= 0) {
+            const long column = sortColumn;
+            const bool ascending = sortAscending;
+            view.SetSort([this, column, ascending](const T& a, const T& b) {
+                return ascending ? Less(a, b, column) : Less(b, a, column);
+            });
+        }
+        Apply(before, false);
+    }
+
+private:
+    RowView<T> view;
+    long sortColumn;
+    bool sortAscending;
+    std::vector<wxString> titles;  // headers without the sort arrow
+
+    std::vector<long> GetSelectedIndexes() const {
+        std::vector<long> selected;
+        for (long i = GetNextItem(-1, wxLIST_NEXT_ALL, wxLIST_STATE_SELECTED); i >= 0;
+             i = GetNextItem(i, wxLIST_NEXT_ALL, wxLIST_STATE_SELECTED)) {
+            selected.push_back(i);
+        }
+        return selected;
+    }
+
+    bool SameText(const T& a, const T& b) const {
+        for (int col = 0; col < ColumnCount(); ++col) {
+            if (Cell(a, col) != Cell(b, col)) return false;
+        }
+        return true;
+    }
+
+    // Carries the selection over from `before` and repaints. With `diff`
+    // only rows whose text changed are repainted; a new sort or filter
+    // moves every row, so it repaints the page instead.
+    bool Apply(const RowView<T>& before, bool diff) {
+        std::vector<long> selectedBefore = GetSelectedIndexes();
+        std::unordered_set<std::string> selectedKeys;
+        for (long i : selectedBefore) {
+            if (i < static_cast<long>(before.size())) selectedKeys.insert(RowKey(before[i]));
+        }
+
+        long firstChanged = -1;
+        long lastChanged = -1;
+        const size_t common = std::min(before.size(), view.size());
+        if (!diff && common > 0) {
+            firstChanged = 0;
+            lastChanged = static_cast<long>(common) - 1;
+        }
+        for (size_t i = 0; diff && i < common; ++i) {
+            if (!SameText(before[i], view[i])) {
+                if (firstChanged < 0) firstChanged = static_cast<long>(i);
+                lastChanged = static_cast<long>(i);
+            }
+        }
+
+        const bool resized = before.size() != view.size();
+        if (resized) {
+            SetItemCount(static_cast<long>(view.size()));
+            if (firstChanged < 0) firstChanged = static_cast<long>(common);
+            lastChanged = static_cast<long>(view.size()) - 1;
+        }
+
+        std::vector<long> selectedAfter;
+        if (!selectedKeys.empty()) {
+            for (size_t i = 0; i < view.size(); ++i) {
+                if (selectedKeys.count(RowKey(view[i]))) {
+                    selectedAfter.push_back(static_cast<long>(i));
+                }
+            }
+        }
+        if (selectedAfter != selectedBefore) {
+            for (long i : selectedBefore) {
+                if (i < static_cast<long>(view.size())) {
+                    SetItemState(i, 0, wxLIST_STATE_SELECTED | wxLIST_STATE_FOCUSED);
+                }
+            }
+            for (long i : selectedAfter) {
+                SetItemState(i, wxLIST_STATE_SELECTED, wxLIST_STATE_SELECTED);
+            }
+            if (!selectedAfter.empty()) {
+                SetItemState(selectedAfter.front(), wxLIST_STATE_FOCUSED, wxLIST_STATE_FOCUSED);
+                if (!diff) EnsureVisible(selectedAfter.front());
+            }
+        }
+
+        if (firstChanged >= 0 && lastChanged >= firstChanged) {
+            if (!diff) {
+                // Only what is on screen needs text.
+                firstChanged = std::max(firstChanged, GetTopItem());
+                lastChanged = std::min(lastChanged, GetTopItem() + GetCountPerPage());
+            }
+            RefreshItems(firstChanged, lastChanged);
+        }
+        return resized || firstChanged >= 0;
+    }
+
+    void OnColumnClick(wxListEvent& event) {
+        const long column = event.GetColumn();
+        if (!Sortable(column)) return;
+        sortAscending = column == sortColumn ? !sortAscending : true;
+        sortColumn = column;
+        ShowSortArrow();
+        Resort();
+    }
+
+    void ShowSortArrow() {
+        if (titles.empty()) {
+            for (int col = 0; col < GetColumnCount(); ++col) {
+                wxListItem item;
+                item.SetMask(wxLIST_MASK_TEXT);
+                GetColumn(col, item);
+                titles.push_back(item.GetText());
+            }
+        }
+        for (int col = 0; col < static_cast<int>(titles.size()); ++col) {
+            wxListItem item;
+            item.SetMask(wxLIST_MASK_TEXT);
+            wxString title = titles[col];
+            if (col == sortColumn) {
+                // U+25B2 / U+25BC, black up- and down-pointing triangles.
+                title += wxString::FromUTF8(sortAscending ? " \xE2\x96\xB2" : " \xE2\x96\xBC");
+            }
+            item.SetText(title);
+            SetColumn(col, item);
+        }
+    }
+};
+
+// Container rows plus CPU and memory sparklines drawn from the stats
+// collector's history; hovering a row shows min/avg/max as a tooltip.
+class ContainerListCtrl : public VirtualListCtrl<ContainerRow> {
+public:
+    ContainerListCtrl(wxWindow* parent, wxWindowID id);
+
+    // Redraws the visible sparklines if new samples arrived.
+    void RefreshHistory();
+
+protected:
+    std::string RowKey(const ContainerRow& row) const override { return row.id.str(); }
+    int ColumnCount() const override { return 7; }
+    StringRef Cell(const ContainerRow& row, long column) const override;
+    bool Less(const ContainerRow& a, const ContainerRow& b, long column) const override;
+    bool Sortable(long column) const override;
+    // Draws the sparkline columns, which have no cell text.
+    wxString OnGetItemText(long item, long column) const override;
+    wxListItemAttr* OnGetItemAttr(long item) const override;
+
+private:
+    struct Sparklines {
+        std::string cpu;
+        std::string memory;
+    };
+
+    mutable wxListItemAttr runningAttr;
+    mutable wxListItemAttr pausedAttr;
+    mutable wxListItemAttr stoppedAttr;
+
+    // Built on first paint of a row and dropped when the history moves on
+    // or the row scrolls out of view.
+    mutable std::unordered_map<std::string, Sparklines> sparklines;
+    uint64_t historyGeneration;
+    long tooltipItem;
+    uint64_t tooltipGeneration;
+
+    const Sparklines& GetSparklines(const std::string& id) const;
+    // Drops the lines of rows outside the visible page.
+    void TrimSparklines() const;
+    wxString HistoryTooltip(const std::string& id) const;
+    void OnMotion(wxMouseEvent& event);
+};
+
+// Image rows plus the bytes each image has to itself and shares with
+// others, once a LayerAnalyzer has been through its layers.
+class ImageListCtrl : public VirtualListCtrl<ImageRow> {
+public:
+    ImageListCtrl(wxWindow* parent, wxWindowID id);
+
+    // Keyed by image ID; images missing from `usage` show blank columns.
+    void SetUsage(std::unordered_map<std::string, LayerUsage> usage);
+
+protected:
+    // An image ID appears once per tag, so the tag is part of the key.
+    std::string RowKey(const ImageRow& row) const override {
+        return row.id.str() + '|' + row.repository + ':' + row.tag;
+    }
+    int ColumnCount() const override { return 6; }
+    StringRef Cell(const ImageRow& row, long column) const override;
+    bool Less(const ImageRow& a, const ImageRow& b, long column) const override;
+    // Formats the byte columns; the rows only hold the size.
+    wxString OnGetItemText(long item, long column) const override;
+
+private:
+    std::unordered_map<std::string, LayerUsage> usage;
+
+    // Column 4 or 5 of `row`, -1 while unknown.
+    int64_t UsageBytes(const ImageRow& row, long column) const;
+};
+
+// Volume rows plus the disk use a VolumeScanner measured for each.
+class VolumeListCtrl : public VirtualListCtrl<VolumeRow> {
+public:
+    VolumeListCtrl(wxWindow* parent, wxWindowID id, const wxSize& size);
+
+    // Keyed by volume name, -1 or missing while unknown. Returns whether
+    // any size changed.
+    bool SetSizes(std::unordered_map<std::string, int64_t> sizes);
+
+protected:
+    std::string RowKey(const VolumeRow& row) const override { return row.name.str(); }
+    int ColumnCount() const override { return 3; }
+    StringRef Cell(const VolumeRow& row, long column) const override;
+    bool Less(const VolumeRow& a, const VolumeRow& b, long column) const override;
+    wxString OnGetItemText(long item, long column) const override;
+
+private:
+    std::unordered_map<std::string, int64_t> sizes;
+
+    int64_t SizeOf(const VolumeRow& row) const;
+};
+
+// JobStatus with its state and progress already rendered as text.
+struct JobRow {
+    uint64_t id;
+    std::string number;
+    std::string title;
+    std::string state;
+    std::string progress;
+    std::string message;
+    bool failed;
+
+    static JobRow FromStatus(const JobStatus& status);
+
+    template <typename F> void ForEachString(F f) const {
+        f(number); f(title); f(state); f(progress); f(message);
+    }
+};
+
+class JobListCtrl : public VirtualListCtrl<JobRow> {
+public:
+    JobListCtrl(wxWindow* parent, wxWindowID id);
+
+protected:
+    std::string RowKey(const JobRow& row) const override { return row.number; }
+    int ColumnCount() const override { return 5; }
+    StringRef Cell(const JobRow& row, long column) const override;
+    bool Less(const JobRow& a, const JobRow& b, long column) const override;
+    wxListItemAttr* OnGetItemAttr(long item) const override;
+
+private:
+    mutable wxListItemAttr failedAttr;
+};
@@ -0,0 +1,104 @@
+#include "resource_snapshot.h"
+#include <cstring>
+
+namespace {
+
+struct StateName {
+    ContainerState state;
+    std::string name;
+};
+
+const StateName kStateNames[] = {
+    {ContainerState::Unknown, "unknown"},
+    {ContainerState::Created, "created"},
+    {ContainerState::Running, "running"},
+    {ContainerState::Paused, "paused"},
+    {ContainerState::Restarting, "restarting"},
+    {ContainerState::Removing, "removing"},
+    {ContainerState::Exited, "exited"},
+    {ContainerState::Dead, "dead"},
+};
+
+struct DurationUnit {
+    const char* prefix;
+    int64_t seconds;
+};
+
+const DurationUnit kDurationUnits[] = {
+    {"se", 1}, {"mi", 60}, {"ho", 3600}, {"da", 86400},
+    {"we", 7 * 86400}, {"mo", 30 * 86400}, {"ye", 365 * 86400},
+};
+
+}  // namespace
+
+ContainerState ParseContainerState(const StringRef& state) {
+    for (const auto& entry : kStateNames) {
+        if (state == entry.name) return entry.state;
+    }
+    return ContainerState::Unknown;
+}
+
+const std::string& ContainerStateName(ContainerState state) {
+    return kStateNames[static_cast<size_t>(state)].name;
+}
+
+int64_t ParseStatusDuration(const StringRef& status) {
+    // "Up <duration>[ (Paused)]" or "Exited (0) <duration> ago".
+    const char* p = status.begin();
+    const char* const end = status.end();
+    if (status.size() > 3 && std::memcmp(p, "Up ", 3) == 0) {
+        p += 3;
+    } else {
+        const char* close = static_cast<const char*>(std::memchr(p, ')', status.size()));
+        if (!close || end - close < 2) return 0;
+        p = close + 2;
+    }
+
+    // docker's HumanDuration: "5 seconds", "About a minute", "Less than a second".
+    int64_t count = 1;
+    if (p < end && *p >= '0' && *p <= '9') {
+        count = 0;
+        while (p < end && *p >= '0' && *p <= '9') count = count * 10 + (*p++ - '0');
+    } else if (end - p >= 4 && std::memcmp(p, "Less", 4) == 0) {
+        count = 0;
+    }
+
+    // The unit is the first word that names one.
+    while (p < end) {
+        while (p < end && *p == ' ') ++p;
+        for (const auto& unit : kDurationUnits) {
+            if (end - p >= 2 && p[0] == unit.prefix[0] && p[1] == unit.prefix[1]) {
+                return count * unit.seconds;
+            }
+        }
+        while (p < end && *p != ' ') ++p;
+    }
+    return 0;
+}
+
+ContainerRow ContainerRow::From(const ContainerInfo& info) {
+    ContainerRow row;
+    row.id = info.id;
+    row.name = info.name;
+    row.status = info.status;
+    row.image = info.image;
+    row.state = ParseContainerState(info.state);
+    row.statusSeconds = ParseStatusDuration(row.status);
+    return row;
+}
+
+ImageRow ImageRow::From(const ImageInfo& info) {
+    ImageRow row;
+    row.id = info.id;
+    row.repository = info.repository;
+    row.tag = info.tag;
+    row.size = info.size;
+    return row;
+}
+
+VolumeRow VolumeRow::From(const VolumeInfo& info) {
+    VolumeRow row;
+    row.name = info.name;
+    row.driver = info.driver;
+    return row;
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "docker_commands.h"
+#include "string_arena.h"
+#include <memory>
+#include <vector>
+
+enum class ContainerState : uint8_t {
+    Unknown, Created, Running, Paused, Restarting, Removing, Exited, Dead
+};
+
+ContainerState ParseContainerState(const StringRef& state);
+// The daemon's spelling, e.g. "running".
+const std::string& ContainerStateName(ContainerState state);
+
+// Seconds in a status such as "Up 3 days" or "Exited (0) 5 minutes ago";
+// docker rounds them ("About an hour"), so this is a sort key, not a clock.
+int64_t ParseStatusDuration(const StringRef& status);
+
+// Rows of the immutable tables below. Their strings point into the table's
+// arena; the From() conversions point into the source object instead, and
+// Builder::Add() copies them over.
+struct ContainerRow {
+    StringRef id;
+    StringRef name;
+    StringRef status;
+    StringRef image;
+    ContainerState state;
+    int64_t statusSeconds;  // ParseStatusDuration(status)
+
+    static ContainerRow From(const ContainerInfo& info);
+
+    template <typename F> void ForEachString(F f) { f(id); f(name); f(status); f(image); }
+    template <typename F> void ForEachString(F f) const { f(id); f(name); f(status); f(image); }
+};
+
+struct ImageRow {
+    StringRef id;
+    StringRef repository;
+    StringRef tag;
+    int64_t size;  // bytes
+
+    static ImageRow From(const ImageInfo& info);
+
+    template <typename F> void ForEachString(F f) { f(id); f(repository); f(tag); }
+    template <typename F> void ForEachString(F f) const { f(id); f(repository); f(tag); }
+};
+
+struct VolumeRow {
+    StringRef name;
+    StringRef driver;
+
+    static VolumeRow From(const VolumeInfo& info);
+
+    template <typename F> void ForEachString(F f) { f(name); f(driver); }
+    template <typename F> void ForEachString(F f) const { f(name); f(driver); }
+};
+
+// A list of rows that never changes once built. Repeated strings (images,
+// statuses, drivers) are stored once in the table's own arena, so a table
+// costs a few large allocations however many rows it has, and is shared
+// between threads by pointer instead of being copied.
+template <typename Row>
+class SnapshotTable {
+public:
+    typedef std::shared_ptr<const SnapshotTable> Ptr;
+
+    class Builder {
+    public:
+        explicit Builder(size_t expectedRows = 0)
+            : table(new SnapshotTable(expectedRows)) {}
+
+        // Copies the row's strings into the table, wherever they live now.
+        void Add(Row row) {
+            StringArena& arena = table->arena;
+            row.ForEachString([&arena](StringRef& s) { s = arena.Intern(s); });
+            table->rows.push_back(row);
+        }
+
+        template <typename Info>
+        void AddAll(const std::vector<Info>& infos) {
+            for (const auto& info : infos) Add(Row::From(info));
+        }
+
+        Ptr Finish() {
+            table->arena.Seal();
+            return Ptr(table.release());
+        }
+
+    private:
+        std::unique_ptr<SnapshotTable> table;
+    };
+
+    template <typename Info>
+    static Ptr Build(const std::vector<Info>& infos) {
+        Builder builder(infos.size());
+        builder.AddAll(infos);
+        return builder.Finish();
+    }
+
+    static Ptr Empty() {
+        static const Ptr empty = Builder().Finish();
+        return empty;
+    }
+
+    // Keeps the table alive for as long as the returned rows are in use.
+    static std::shared_ptr<const std::vector<Row>> RowsOf(const Ptr& table) {
+        if (!table) return RowsOf(Empty());
+        return std::shared_ptr<const std::vector<Row>>(table, &table->rows);
+    }
+
+    size_t size() const { return rows.size(); }
+    bool empty() const { return rows.empty(); }
+    const Row& operator[](size_t i) const { return rows[i]; }
+    typename std::vector<Row>::const_iterator begin() const { return rows.begin(); }
+    typename std::vector<Row>::const_iterator end() const { return rows.end(); }
+
+    size_t MemoryUsage() const {
+        return sizeof(*this) + rows.capacity() * sizeof(Row) + arena.MemoryUsage();
+    }
+
+private:
+    explicit SnapshotTable(size_t expectedRows) : arena(expectedRows * 24) {
+        rows.reserve(expectedRows);
+    }
+
+    StringArena arena;
+    std::vector<Row> rows;
+};
+
+typedef SnapshotTable<ContainerRow> ContainerTable;
+typedef SnapshotTable<ImageRow> ImageTable;
+typedef SnapshotTable<VolumeRow> VolumeTable;
+
+// The daemon's containers, images and volumes at one moment. Copying it
+// copies three pointers; a change rebuilds only the table it touches and
+// shares the others with the previous snapshot.
+struct ResourceSnapshot {
+    ContainerTable::Ptr containers = ContainerTable::Empty();
+    ImageTable::Ptr images = ImageTable::Empty();
+    VolumeTable::Ptr volumes = VolumeTable::Empty();
+};
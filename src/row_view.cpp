@@ -0,0 +1,58 @@
+#include "row_view.h"
+
+namespace {
+
+char Fold(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+// First byte in [p, last] equal to the lower-case letter `c` in either
+// case, or last + 1. Eight bytes are tested at a time.
+const char* FindLetter(const char* p, const char* last, char c) {
+    const uint64_t kOnes = 0x0101010101010101ULL;
+    const uint64_t kHighs = 0x8080808080808080ULL;
+    const uint64_t pattern = kOnes * static_cast<unsigned char>(c);
+    for (; last - p >= 7; p += 8) {
+        uint64_t word;
+        std::memcpy(&word, p, 8);
+        const uint64_t x = (word | kOnes * 0x20) ^ pattern;  // zero byte on a match
+        if ((x - kOnes) & ~x & kHighs) break;
+    }
+    while (p <= last && (*p | 0x20) != c) ++p;
+    return p;
+}
+
+}  // namespace
+
+std::string FoldCase(const std::string& text) {
+    std::string folded(text);
+    for (char& c : folded) c = Fold(c);
+    return folded;
+}
+
+bool ContainsFolded(const StringRef& haystack, const std::string& needle) {
+    const size_t n = needle.size();
+    if (n == 0) return true;
+    if (haystack.size() < n) return false;
+
+    // Candidates are found by the first character, with memchr when it has
+    // no case; only candidates are compared in full.
+    const char first = needle[0];
+    const bool letter = first >= 'a' && first <= 'z';
+    const char* p = haystack.data();
+    const char* const last = p + haystack.size() - n;
+    while (p <= last) {
+        if (letter) {
+            p = FindLetter(p, last, first);
+        } else {
+            p = static_cast<const char*>(std::memchr(p, first, last - p + 1));
+            if (!p) return false;
+        }
+        if (p > last) return false;
+        size_t i = 1;
+        while (i < n && Fold(p[i]) == needle[i]) ++i;
+        if (i == n) return true;
+        ++p;
+    }
+    return false;
+}
@@ -0,0 +1,243 @@
+#pragma once
+
+#include "string_arena.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// ASCII lower case, for filter text.
+std::string FoldCase(const std::string& text);
+
+// Whether `haystack` contains `needle`, ignoring ASCII case; `needle` must
+// already be folded.
+bool ContainsFolded(const StringRef& haystack, const std::string& needle);
+
+// The rows of one snapshot that a list shows, and their order: a
+// permutation sorted by a caller-supplied key and narrowed by a filter.
+// Row types provide ForEachString() for the filter and for recognising
+// unchanged rows across snapshots.
+//
+// A new snapshot does not trigger a full sort. Rows whose strings and sort
+// key are unchanged keep their previous relative order; only new and
+// changed rows are sorted, then merged in, so a refresh that touches k of
+// n rows costs O(n + k log k).
+template <typename Row>
+class RowView {
+public:
+    typedef std::shared_ptr<const std::vector<Row>> RowsPtr;
+    typedef std::function<bool(const Row& a, const Row& b)> Less;
+
+    RowView() : rows(std::make_shared<const std::vector<Row>>()) {}
+
+    void SetRows(RowsPtr next) {
+        std::vector<uint32_t> order = less ? Reorder(*next) : Identity(next->size());
+        rows = std::move(next);
+        sorted.swap(order);
+        Refilter();
+    }
+
+    // An empty `less` restores the snapshot's own order.
+    void SetSort(Less nextLess) {
+        less = std::move(nextLess);
+        sorted = Identity(rows->size());
+        if (less) SortIndexes(sorted, *rows);
+        Refilter();
+    }
+
+    // Keeps rows with a string containing `text`, ignoring case. Typing
+    // one more character only re-checks the rows that matched before.
+    void SetFilter(const std::string& text) {
+        std::string folded = FoldCase(text);
+        const bool narrows = folded.find(filter) != std::string::npos;
+        filter.swap(folded);
+        if (!narrows) {
+            Refilter();
+            return;
+        }
+        const std::vector<Row>& all = *rows;
+        for (size_t i = 0; i < all.size(); ++i) {
+            if (matched[i]) matched[i] = Matches(all[i]);
+        }
+        visible.erase(std::remove_if(visible.begin(), visible.end(),
+                                     [this](uint32_t i) { return !matched[i]; }),
+                      visible.end());
+    }
+
+    size_t size() const { return visible.size(); }
+    bool empty() const { return visible.empty(); }
+    const Row& operator[](size_t i) const { return (*rows)[visible[i]]; }
+    const RowsPtr& Rows() const { return rows; }
+    bool Sorted() const { return static_cast<bool>(less); }
+
+private:
+    RowsPtr rows;
+    std::vector<uint32_t> sorted;   // every row, in display order
+    std::vector<uint32_t> visible;  // the part of `sorted` that matches
+    std::vector<char> matched;      // per row, in storage order
+    Less less;
+    std::string filter;             // folded
+
+    static uint64_t Hash(const Row& row) {
+        uint64_t h = 0;
+        row.ForEachString([&h](const StringRef& s) { h = HashString(h, s); });
+        return h;
+    }
+
+    static bool SameStrings(const Row& a, const Row& b) {
+        const size_t kMaxStrings = 8;
+        StringRef strings[kMaxStrings];
+        size_t count = 0;
+        a.ForEachString([&](const StringRef& s) {
+            if (count < kMaxStrings) strings[count] = s;
+            ++count;
+        });
+        size_t i = 0;
+        bool same = count <= kMaxStrings;
+        b.ForEachString([&](const StringRef& s) {
+            same = same && i < count && s == strings[i];
+            ++i;
+        });
+        return same && i == count;
+    }
+
+    static std::vector<uint32_t> Identity(size_t n) {
+        std::vector<uint32_t> order(n);
+        for (size_t i = 0; i < n; ++i) order[i] = static_cast<uint32_t>(i);
+        return order;
+    }
+
+    void SortIndexes(std::vector<uint32_t>& order, const std::vector<Row>& all) const {
+        std::stable_sort(order.begin(), order.end(),
+                         [this, &all](uint32_t a, uint32_t b) { return less(all[a], all[b]); });
+    }
+
+    bool Unchanged(const Row& old, const Row& row) const {
+        return SameStrings(old, row) && !less(old, row) && !less(row, old);
+    }
+
+    std::vector<uint32_t> Reorder(const std::vector<Row>& after) const {
+        const std::vector<Row>& before = *rows;
+        const uint32_t kNone = UINT32_MAX;
+        const ptrdiff_t kWindow = 8;
+
+        // Match old rows to new ones in storage order. Snapshots mostly
+        // keep their order, so the rows around the last matched offset are
+        // tried first; a content-hash table, built only if rows moved
+        // further, finds the rest.
+        std::vector<uint32_t> newIndex(before.size(), kNone);
+        std::vector<char> placed(after.size(), 0);
+        std::vector<uint64_t> afterHashes;
+        std::vector<uint32_t> slots;  // new row index + 1; 0 is empty
+        size_t mask = 0;
+        ptrdiff_t offset = 0;
+        const ptrdiff_t size = static_cast<ptrdiff_t>(after.size());
+        // Where old row `i` is among the new rows within kWindow of `center`.
+        auto near = [&](size_t i, ptrdiff_t center) -> ptrdiff_t {
+            auto fits = [&](ptrdiff_t j) {
+                return j >= 0 && j < size && !placed[j] && Unchanged(before[i], after[j]);
+            };
+            if (fits(center)) return center;
+            for (ptrdiff_t d = 1; d <= kWindow; ++d) {
+                if (fits(center + d)) return center + d;
+                if (fits(center - d)) return center - d;
+            }
+            return -1;
+        };
+        for (size_t i = 0; i < before.size(); ++i) {
+            const ptrdiff_t guess = static_cast<ptrdiff_t>(i) + offset;
+            const ptrdiff_t found = near(i, guess);
+            if (found >= 0) {
+                newIndex[i] = static_cast<uint32_t>(found);
+                placed[found] = 1;
+                offset = found - static_cast<ptrdiff_t>(i);
+                continue;
+            }
+            // Changed or removed, with the rows after it still in place.
+            if (i + 1 == before.size() || near(i + 1, guess + 1) >= 0) continue;
+
+            if (slots.empty()) {
+                size_t capacity = 16;
+                while (capacity < after.size() * 2) capacity *= 2;
+                mask = capacity - 1;
+                slots.assign(capacity, 0);
+                afterHashes.resize(after.size());
+                for (size_t j = 0; j < after.size(); ++j) {
+                    afterHashes[j] = Hash(after[j]);
+                    size_t s = afterHashes[j] & mask;
+                    while (slots[s]) s = (s + 1) & mask;
+                    slots[s] = static_cast<uint32_t>(j + 1);
+                }
+            }
+            const uint64_t hash = Hash(before[i]);
+            for (size_t s = hash & mask; slots[s]; s = (s + 1) & mask) {
+                const uint32_t j = slots[s] - 1;
+                if (placed[j] || afterHashes[j] != hash || !Unchanged(before[i], after[j])) {
+                    continue;
+                }
+                newIndex[i] = j;
+                placed[j] = 1;
+                offset = static_cast<ptrdiff_t>(j) - static_cast<ptrdiff_t>(i);
+                break;
+            }
+        }
+
+        // Unchanged rows keep their order. The others are sorted and each
+        // placed by binary search, after any equal unchanged rows.
+        std::vector<uint32_t> kept;
+        kept.reserve(after.size());
+        for (uint32_t i : sorted) {
+            if (newIndex[i] != kNone) kept.push_back(newIndex[i]);
+        }
+        std::vector<uint32_t> moved;
+        for (size_t j = 0; j < after.size(); ++j) {
+            if (!placed[j]) moved.push_back(static_cast<uint32_t>(j));
+        }
+        if (moved.empty()) return kept;
+        SortIndexes(moved, after);
+
+        std::vector<uint32_t> order;
+        order.reserve(after.size());
+        auto from = kept.begin();
+        for (uint32_t j : moved) {
+            auto to = std::upper_bound(from, kept.end(), j,
+                                       [this, &after](uint32_t a, uint32_t b) {
+                                           return less(after[a], after[b]);
+                                       });
+            order.insert(order.end(), from, to);
+            order.push_back(j);
+            from = to;
+        }
+        order.insert(order.end(), from, kept.end());
+        return order;
+    }
+
+    bool Matches(const Row& row) const {
+        if (filter.empty()) return true;
+        bool found = false;
+        row.ForEachString([this, &found](const StringRef& s) {
+            found = found || ContainsFolded(s, filter);
+        });
+        return found;
+    }
+
+    // Rows are checked in storage order, which reads the rows and their
+    // strings sequentially; only the one-byte flags are visited in display
+    // order.
+    void Refilter() {
+        const std::vector<Row>& all = *rows;
+        matched.assign(all.size(), 1);
+        if (filter.empty()) {
+            visible = sorted;
+            return;
+        }
+        for (size_t i = 0; i < all.size(); ++i) matched[i] = Matches(all[i]);
+        visible.clear();
+        for (uint32_t i : sorted) {
+            if (matched[i]) visible.push_back(i);
+        }
+    }
+};
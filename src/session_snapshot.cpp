@@ -0,0 +1,205 @@
+#include "session_snapshot.h"
+#include "file_util.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char kMagic[4] = {'D', 'M', 'S', 'S'};
+const uint32_t kVersion = 2;
+
+// Magic, version, saved time, container, image and volume counts, CPU
+// percent, container count, memory bytes.
+const size_t kHeaderSize = 4 + 4 + 8 + 4 + 4 + 4 + 8 + 4 + 8;
+
+void PutString(std::string& out, const StringRef& value) {
+    Put<uint32_t>(out, static_cast<uint32_t>(value.size()));
+    out.append(value.data(), value.size());
+}
+
+// Bounds-checked reads from the mapped file; every read after the first
+// one that runs past the end fails.
+class Cursor {
+public:
+    Cursor(const char* data, size_t size) : p(data), end(data + size), failed(false) {}
+
+    template <typename T>
+    T Get() {
+        T value = T();
+        if (failed || static_cast<size_t>(end - p) < sizeof(value)) {
+            failed = true;
+            return value;
+        }
+        std::memcpy(&value, p, sizeof(value));
+        p += sizeof(value);
+        return value;
+    }
+
+    // Points into the mapping; the table builders copy what they keep.
+    StringRef GetString() {
+        uint32_t length = Get<uint32_t>();
+        if (failed || static_cast<size_t>(end - p) < length) {
+            failed = true;
+            return StringRef();
+        }
+        StringRef value(p, length);
+        p += length;
+        return value;
+    }
+
+    bool Failed() const { return failed; }
+
+private:
+    const char* p;
+    const char* end;
+    bool failed;
+};
+
+bool Parse(const char* data, size_t size, SessionSnapshot& snapshot) {
+    if (size < kHeaderSize || std::memcmp(data, kMagic, sizeof(kMagic)) != 0) return false;
+
+    Cursor in(data + sizeof(kMagic), size - sizeof(kMagic));
+    if (in.Get<uint32_t>() != kVersion) return false;
+    snapshot.savedAt = in.Get<int64_t>();
+    uint32_t containers = in.Get<uint32_t>();
+    uint32_t images = in.Get<uint32_t>();
+    uint32_t volumes = in.Get<uint32_t>();
+    snapshot.system.cpu_usage = in.Get<double>();
+    snapshot.system.container_count = in.Get<int32_t>();
+    snapshot.system.mem_bytes = in.Get<int64_t>();
+
+    // Every record takes at least four bytes per field, so counts larger
+    // than the file are corrupt rather than merely large.
+    if (in.Failed() || containers > size / 20 || images > size / 20 || volumes > size / 8) {
+        return false;
+    }
+
+    ContainerTable::Builder containerRows(containers);
+    for (uint32_t i = 0; i < containers; ++i) {
+        ContainerRow row;
+        row.id = in.GetString();
+        row.name = in.GetString();
+        row.state = ParseContainerState(in.GetString());
+        row.status = in.GetString();
+        row.image = in.GetString();
+        row.statusSeconds = ParseStatusDuration(row.status);
+        containerRows.Add(row);
+    }
+    ImageTable::Builder imageRows(images);
+    for (uint32_t i = 0; i < images; ++i) {
+        ImageRow row;
+        row.id = in.GetString();
+        row.repository = in.GetString();
+        row.tag = in.GetString();
+        row.size = in.Get<int64_t>();
+        imageRows.Add(row);
+    }
+    VolumeTable::Builder volumeRows(volumes);
+    for (uint32_t i = 0; i < volumes; ++i) {
+        VolumeRow row;
+        row.name = in.GetString();
+        row.driver = in.GetString();
+        volumeRows.Add(row);
+    }
+    if (in.Failed()) return false;
+
+    snapshot.resources.containers = containerRows.Finish();
+    snapshot.resources.images = imageRows.Finish();
+    snapshot.resources.volumes = volumeRows.Finish();
+    return true;
+}
+
+}  // namespace
+
+std::string SessionStore::DefaultPath() {
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME")) {
+        if (*xdg) return std::string(xdg) + "/docker-manager/session.bin";
+    }
+    const char* home = std::getenv("HOME");
+    return std::string(home ? home : ".") + "/.cache/docker-manager/session.bin";
+}
+
+bool SessionStore::Save(const std::string& path, const SessionSnapshot& snapshot,
+                        std::string* error) {
+    const ResourceSnapshot& res = snapshot.resources;
+    std::string out;
+    out.reserve(kHeaderSize + 64 * (res.containers->size() + res.images->size() +
+                                    res.volumes->size()));
+    out.append(kMagic, sizeof(kMagic));
+    Put<uint32_t>(out, kVersion);
+    Put<int64_t>(out, snapshot.savedAt);
+    Put<uint32_t>(out, static_cast<uint32_t>(res.containers->size()));
+    Put<uint32_t>(out, static_cast<uint32_t>(res.images->size()));
+    Put<uint32_t>(out, static_cast<uint32_t>(res.volumes->size()));
+    Put<double>(out, snapshot.system.cpu_usage);
+    Put<int32_t>(out, snapshot.system.container_count);
+    Put<int64_t>(out, snapshot.system.mem_bytes);
+    for (const auto& c : *res.containers) {
+        PutString(out, c.id);
+        PutString(out, c.name);
+        PutString(out, ContainerStateName(c.state));
+        PutString(out, c.status);
+        PutString(out, c.image);
+    }
+    for (const auto& image : *res.images) {
+        PutString(out, image.id);
+        PutString(out, image.repository);
+        PutString(out, image.tag);
+        Put<int64_t>(out, image.size);
+    }
+    for (const auto& volume : *res.volumes) {
+        PutString(out, volume.name);
+        PutString(out, volume.driver);
+    }
+
+    size_t slash = path.rfind('/');
+    if (slash != std::string::npos && slash > 0 && !MakeDirectories(path.substr(0, slash))) {
+        if (error) *error = path.substr(0, slash) + ": " + std::strerror(errno);
+        return false;
+    }
+
+    // A crash mid-write leaves the previous snapshot in place.
+    std::string temp = path + ".tmp";
+    int fd = open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        if (error) *error = temp + ": " + std::strerror(errno);
+        return false;
+    }
+    const bool written = WriteAll(fd, out);
+    int savedErrno = errno;
+    close(fd);
+    if (!written || rename(temp.c_str(), path.c_str()) != 0) {
+        if (written) savedErrno = errno;
+        if (error) *error = path + ": " + std::strerror(savedErrno);
+        unlink(temp.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool SessionStore::Load(const std::string& path, SessionSnapshot& snapshot) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+    const size_t size = static_cast<size_t>(st.st_size);
+    void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return false;
+
+    SessionSnapshot loaded;
+    bool ok = Parse(static_cast<const char*>(map), size, loaded);
+    munmap(map, size);
+    if (ok) snapshot = std::move(loaded);
+    return ok;
+}
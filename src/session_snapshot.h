@@ -0,0 +1,29 @@
+#pragma once
+
+#include "docker_state.h"
+#include <cstdint>
+#include <ctime>
+#include <string>
+
+// What the window showed when it was last closed. Loaded at startup so the
+// lists appear at once, marked stale, while the daemon is still being
+// contacted.
+struct SessionSnapshot {
+    int64_t savedAt = 0;  // Unix seconds
+    ResourceSnapshot resources;
+    SystemInfo system = SystemInfo();
+};
+
+// Compact binary file: a fixed header followed by length-prefixed strings,
+// written to a temporary file and renamed into place, read through mmap.
+class SessionStore {
+public:
+    // $XDG_CACHE_HOME/docker-manager/session.bin, else
+    // ~/.cache/docker-manager/session.bin.
+    static std::string DefaultPath();
+
+    static bool Save(const std::string& path, const SessionSnapshot& snapshot,
+                     std::string* error = nullptr);
+    // False when the file is missing, from another version, or truncated.
+    static bool Load(const std::string& path, SessionSnapshot& snapshot);
+};
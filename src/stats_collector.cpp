@@ -0,0 +1,281 @@
+#include "stats_collector.h"
+#include "byte_size.h"
+#include "cgroup_stats.h"
+#include "cli_parser.h"
+#include "docker_api.h"
+#include "metrics_archive.h"
+#include "process_runner.h"
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <poll.h>
+#include <unistd.h>
+
+namespace {
+
+const int kRestartDelayMs = 2000;
+// Empty cgroup samples in a row before asking the daemon whether that is right.
+const int kEmptySamplesBeforeCheck = 10;
+
+// History matches the window's refresh rate: ten minutes at 3 s a bucket.
+const std::chrono::milliseconds kHistoryResolution(3000);
+const size_t kHistorySamples = 200;
+const size_t kHistoryContainers = 256;
+
+// One line of the stream started in FollowStream().
+struct StatsLine {
+    std::string id;
+    std::string name;
+    std::string cpu;
+    std::string memory;
+    std::string net;
+    std::string block;
+};
+typedef DelimitedParser<StatsLine, &StatsLine::id, &StatsLine::name, &StatsLine::cpu,
+                        &StatsLine::memory, &StatsLine::net, &StatsLine::block> StatsLineParser;
+
+// "1.2kB / 3.4MB" into its two byte counts.
+bool ParseSizePair(const std::string& text, uint64_t& first, uint64_t& second) {
+    size_t slash = text.find('/');
+    if (slash == std::string::npos) return false;
+    int64_t a = 0, b = 0;
+    if (!ParseByteSize(StringRef(text.data(), slash), a) ||
+        !ParseByteSize(StringRef(text.data() + slash + 1, text.size() - slash - 1), b)) {
+        return false;
+    }
+    first = static_cast<uint64_t>(a);
+    second = static_cast<uint64_t>(b);
+    return true;
+}
+
+}  // namespace
+
+StatsCollector& StatsCollector::Instance() {
+    static StatsCollector instance;
+    return instance;
+}
+
+StatsCollector::StatsCollector()
+    : running(false), stopping(false), childPid(0), frameCount(0), usingCgroups(false),
+      archive(nullptr),
+      cgroups(new CgroupStatsReader()), sampleIntervalMs(1000), haveTotals(false),
+      history(kHistoryResolution, kHistorySamples, kHistoryContainers) {
+    totals.cpu_usage = 0.0;
+    totals.mem_bytes = 0;
+    totals.container_count = 0;
+}
+
+StatsCollector::~StatsCollector() {
+    Stop();
+}
+
+void StatsCollector::SetCgroupRoot(const std::string& root) {
+    if (!running) cgroups->SetRoot(root);
+}
+
+void StatsCollector::SetSampleInterval(int ms) {
+    if (!running && ms > 0) sampleIntervalMs = ms;
+}
+
+void StatsCollector::Start() {
+    if (running.exchange(true)) return;
+    stopping = false;
+    thread = std::thread(&StatsCollector::Run, this);
+}
+
+void StatsCollector::Stop() {
+    if (!running) return;
+    {
+        std::lock_guard<std::mutex> lock(waitMutex);
+        stopping = true;
+    }
+    waitCond.notify_all();
+    int pid = childPid.load();
+    if (pid > 0) kill(pid, SIGTERM);
+    if (thread.joinable()) thread.join();
+    running = false;
+}
+
+bool StatsCollector::GetTotals(SystemInfo& info) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!haveTotals) return false;
+    info = totals;
+    return true;
+}
+
+std::vector<ContainerStats> StatsCollector::GetContainerStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return table;
+}
+
+void StatsCollector::Run() {
+    while (!stopping) {
+        // The cgroup tree only describes the local daemon's containers, and
+        // only if the daemon puts them where the reader looks.
+        usingCgroups = DockerApiClient::Instance().IsEnabled() && cgroups->IsAvailable() &&
+                       CgroupsCoverDaemon();
+        if (usingCgroups) {
+            FollowCgroups();
+        } else {
+            FollowStream();
+        }
+
+        std::unique_lock<std::mutex> lock(waitMutex);
+        waitCond.wait_for(lock, std::chrono::milliseconds(kRestartDelayMs),
+                          [this] { return stopping.load(); });
+    }
+}
+
+bool StatsCollector::CgroupsCoverDaemon() {
+    std::vector<std::string> ids;
+    for (const auto& container : DockerCommands::GetRunningContainers()) {
+        ids.push_back(container.id);
+    }
+    std::vector<ContainerStats> rows;
+    return cgroups->Covers(ids, rows);
+}
+
+void StatsCollector::FollowCgroups() {
+    std::vector<ContainerStats> rows;
+    bool primed = false;
+    int emptySamples = 0;
+
+    while (!stopping && cgroups->Sample(rows)) {
+        // The first pass only establishes the CPU baseline.
+        if (primed) {
+            CommitFrame(rows);
+        }
+        primed = true;
+
+        // Nothing was running when the backend was chosen. If the daemon
+        // now runs containers the tree still does not show, hand over to
+        // `docker stats`.
+        emptySamples = rows.empty() ? emptySamples + 1 : 0;
+        if (emptySamples >= kEmptySamplesBeforeCheck) {
+            emptySamples = 0;
+            if (!DockerCommands::GetRunningContainers().empty()) return;
+        }
+
+        std::unique_lock<std::mutex> lock(waitMutex);
+        waitCond.wait_for(lock, std::chrono::milliseconds(sampleIntervalMs),
+                          [this] { return stopping.load(); });
+    }
+}
+
+void StatsCollector::FollowStream() {
+    ChildProcess child;
+    if (!child.Start({DockerCommands::FindDockerBinary(), "stats", "--format",
+                      "{{.ID}}|{{.Name}}|{{.CPUPerc}}|{{.MemUsage}}|{{.NetIO}}|{{.BlockIO}}"},
+                     false)) {
+        return;
+    }
+    childPid = child.Pid();
+
+    int fd = child.StdoutFd();
+
+    // The CLI redraws the table in place: "ESC[H" (after "ESC[2J" on older
+    // releases) starts a frame, newer releases end it with "ESC[J".
+    enum { Text, Escape, Csi } state = Text;
+    std::string csiParams;
+    std::string line;
+    std::vector<ContainerStats> frame;
+    bool inFrame = false;
+    char buffer[16 * 1024];
+
+    while (!stopping) {
+        pollfd pfd = {fd, POLLIN, 0};
+        int ready = poll(&pfd, 1, 500);
+        if (ready < 0 && errno == EINTR) continue;
+        if (ready < 0) break;
+        if (ready == 0) continue;
+
+        ssize_t n = read(fd, buffer, sizeof(buffer));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+
+        for (ssize_t i = 0; i < n; ++i) {
+            char c = buffer[i];
+            switch (state) {
+                case Text:
+                    if (c == '\033') {
+                        state = Escape;
+                    } else if (c == '\n') {
+                        ContainerStats row;
+                        if (inFrame && ParseLine(line, row)) frame.push_back(row);
+                        line.clear();
+                    } else if (c != '\r') {
+                        line += c;
+                    }
+                    break;
+                case Escape:
+                    state = c == '[' ? Csi : Text;
+                    csiParams.clear();
+                    break;
+                case Csi:
+                    if (c >= 0x40 && c <= 0x7E) {
+                        state = Text;
+                        if (c == 'H') {
+                            if (inFrame) CommitFrame(frame);
+                            frame.clear();
+                            line.clear();
+                            inFrame = true;
+                        } else if (c == 'J' && csiParams != "2" && inFrame) {
+                            CommitFrame(frame);
+                            frame.clear();
+                            inFrame = false;
+                        }
+                    } else {
+                        csiParams += c;
+                    }
+                    break;
+            }
+        }
+    }
+
+    childPid = 0;
+    child.Signal(SIGTERM);
+    child.Wait();
+}
+
+void StatsCollector::CommitFrame(std::vector<ContainerStats>& frame) {
+    SystemInfo sum;
+    sum.cpu_usage = 0.0;
+    sum.container_count = static_cast<int>(frame.size());
+    sum.mem_bytes = 0;
+    for (const auto& s : frame) {
+        sum.cpu_usage += s.cpu_percent;
+        sum.mem_bytes += static_cast<int64_t>(s.mem_bytes);
+    }
+    history.Record(frame);
+    if (MetricsArchive* target = archive.load()) target->Append(frame);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    table.swap(frame);
+    totals = sum;
+    haveTotals = true;
+    ++frameCount;
+}
+
+bool StatsCollector::ParseLine(const std::string& line, ContainerStats& stats) {
+    StatsLine fields;
+    if (!StatsLineParser::ParseRecord(line.data(), line.size(), fields) || fields.id.empty() ||
+        fields.cpu.empty()) {
+        return false;
+    }
+    stats.id.swap(fields.id);
+    stats.name.swap(fields.name);
+
+    stats.cpu_percent = 0.0;
+    ParsePercent(fields.cpu, stats.cpu_percent);
+
+    uint64_t limit = 0;
+    stats.mem_bytes = 0;
+    if (!ParseSizePair(fields.memory, stats.mem_bytes, limit)) {
+        int64_t used = 0;
+        if (ParseByteSize(fields.memory, used)) stats.mem_bytes = static_cast<uint64_t>(used);
+    }
+    stats.has_net_io = ParseSizePair(fields.net, stats.net_rx, stats.net_tx);
+    ParseSizePair(fields.block, stats.block_read, stats.block_write);
+    return true;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "docker_commands.h"
+#include "metrics_history.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct ContainerStats {
+    std::string id;
+    std::string name;
+    double cpu_percent;
+    uint64_t mem_bytes = 0;  // excluding page cache
+    // Cumulative byte counters.
+    uint64_t net_rx = 0;
+    uint64_t net_tx = 0;
+    uint64_t block_read = 0;
+    uint64_t block_write = 0;
+    bool has_net_io = false;
+};
+
+class CgroupStatsReader;
+class MetricsArchive;
+
+// Keeps a per-container stats table and aggregated totals up to date in the
+// background, so readers never wait for a sample. For a local daemon on a
+// cgroup v2 host the numbers are read straight from the cgroup files; the
+// fallback is one long-lived `docker stats` stream per host.
+class StatsCollector {
+public:
+    static StatsCollector& Instance();
+
+    // Both take effect on the next Start().
+    void SetCgroupRoot(const std::string& root);
+    void SetSampleInterval(int ms);
+    bool IsUsingCgroups() const { return usingCgroups; }
+
+    void Start();
+    void Stop();
+
+    // False until the first frame has arrived.
+    bool GetTotals(SystemInfo& info) const;
+    std::vector<ContainerStats> GetContainerStats() const;
+    unsigned long GetFrameCount() const { return frameCount; }
+    const MetricsHistory& GetHistory() const { return history; }
+    // Every frame is also appended to `archive` while it is set.
+    void SetArchive(MetricsArchive* archive) { this->archive = archive; }
+
+    // One `docker stats` line: id|name|cpu|"used / limit"|"rx / tx"|"read / write".
+    static bool ParseLine(const std::string& line, ContainerStats& stats);
+
+private:
+    StatsCollector();
+    ~StatsCollector();
+
+    std::thread thread;
+    std::atomic<bool> running;
+    std::atomic<bool> stopping;
+    std::atomic<int> childPid;
+    std::atomic<unsigned long> frameCount;
+    std::atomic<bool> usingCgroups;
+    std::atomic<MetricsArchive*> archive;
+    std::unique_ptr<CgroupStatsReader> cgroups;
+    int sampleIntervalMs;
+    std::mutex waitMutex;
+    std::condition_variable waitCond;
+
+    mutable std::mutex mutex;
+    std::vector<ContainerStats> table;
+    SystemInfo totals;
+    bool haveTotals;
+    MetricsHistory history;
+
+    void Run();
+    void FollowStream();
+    void FollowCgroups();
+    bool CgroupsCoverDaemon();
+    void CommitFrame(std::vector<ContainerStats>& frame);
+};
@@ -0,0 +1,100 @@
+#include "string_arena.h"
+#include <algorithm>
+
+namespace {
+
+const size_t kMinBlockSize = 4096;
+const size_t kMaxBlockSize = 1 << 20;
+
+uint64_t Hash(const StringRef& s) {
+    uint64_t h = 14695981039346656037ULL;  // FNV-1a
+    for (size_t i = 0; i < s.size(); ++i) {
+        h ^= static_cast<unsigned char>(s[i]);
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+}  // namespace
+
+StringArena::StringArena(size_t expectedBytes)
+    : blockSize(std::min(std::max(expectedBytes, kMinBlockSize), kMaxBlockSize)),
+      blockUsed(0),
+      blockBytes(0),
+      count(0) {}
+
+StringRef StringArena::Intern(const StringRef& s) {
+    if (s.empty()) return StringRef();
+
+    if ((count + 1) * 2 > slots.size()) Grow();
+    const size_t mask = slots.size() - 1;
+    for (size_t i = Hash(s) & mask;; i = (i + 1) & mask) {
+        StringRef& slot = slots[i];
+        if (!slot.data()) {
+            slot = Store(s);
+            ++count;
+            return slot;
+        }
+        if (slot == s) return slot;
+    }
+}
+
+StringRef StringArena::Store(const StringRef& s) {
+    if (blocks.empty() || blockUsed + s.size() > blockSize) {
+        // Later blocks double up to the cap; an oversized string gets its own.
+        if (!blocks.empty()) blockSize = std::min(blockSize * 2, kMaxBlockSize);
+        size_t size = std::max(blockSize, s.size());
+        blocks.emplace_back(new char[size]);
+        blockBytes += size;
+        blockUsed = 0;
+        if (size > blockSize) {
+            std::memcpy(blocks.back().get(), s.data(), s.size());
+            blockUsed = size;
+            return StringRef(blocks.back().get(), s.size());
+        }
+    }
+    char* dest = blocks.back().get() + blockUsed;
+    std::memcpy(dest, s.data(), s.size());
+    blockUsed += s.size();
+    return StringRef(dest, s.size());
+}
+
+void StringArena::Grow() {
+    std::vector<StringRef> old;
+    old.swap(slots);
+    slots.assign(std::max<size_t>(64, old.size() * 2), StringRef(nullptr, 0));
+    const size_t mask = slots.size() - 1;
+    for (const auto& s : old) {
+        if (!s.data()) continue;
+        size_t i = Hash(s) & mask;
+        while (slots[i].data()) i = (i + 1) & mask;
+        slots[i] = s;
+    }
+}
+
+void StringArena::Seal() {
+    std::vector<StringRef>().swap(slots);
+    count = 0;
+}
+
+size_t StringArena::MemoryUsage() const {
+    return blockBytes + slots.capacity() * sizeof(StringRef) +
+           blocks.capacity() * sizeof(blocks[0]);
+}
+
+uint64_t HashString(uint64_t h, const StringRef& s) {
+    const uint64_t kMul = 0x9E3779B97F4A7C15ULL;
+    const char* p = s.data();
+    size_t left = s.size();
+    for (; left >= 8; p += 8, left -= 8) {
+        uint64_t chunk;
+        std::memcpy(&chunk, p, 8);
+        h = (h ^ chunk) * kMul;
+        h ^= h >> 29;
+    }
+    uint64_t tail = 0;
+    std::memcpy(&tail, p, left);
+    // The length separates "ab"+"c" from "a"+"bc".
+    h = (h ^ tail ^ (static_cast<uint64_t>(s.size()) << 56)) * kMul;
+    return h ^ (h >> 29);
+}
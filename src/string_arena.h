@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Non-owning view of characters kept alive by someone else, usually a
+// StringArena. Named and used like the std::string it stands in for.
+class StringRef {
+public:
+    StringRef() : ptr(""), len(0) {}
+    StringRef(const char* data, size_t size) : ptr(data), len(size) {}
+    StringRef(const char* s) : ptr(s), len(std::strlen(s)) {}
+    StringRef(const std::string& s) : ptr(s.data()), len(s.size()) {}
+
+    const char* data() const { return ptr; }
+    size_t size() const { return len; }
+    bool empty() const { return len == 0; }
+    char operator[](size_t i) const { return ptr[i]; }
+    const char* begin() const { return ptr; }
+    const char* end() const { return ptr + len; }
+    std::string str() const { return std::string(ptr, len); }
+
+    int compare(const StringRef& other) const {
+        int c = std::memcmp(ptr, other.ptr, len < other.len ? len : other.len);
+        if (c != 0) return c;
+        return len < other.len ? -1 : (len > other.len ? 1 : 0);
+    }
+
+private:
+    const char* ptr;
+    size_t len;
+};
+
+inline bool operator==(const StringRef& a, const StringRef& b) {
+    return a.size() == b.size() &&
+           (a.data() == b.data() || std::memcmp(a.data(), b.data(), a.size()) == 0);
+}
+inline bool operator!=(const StringRef& a, const StringRef& b) { return !(a == b); }
+inline bool operator<(const StringRef& a, const StringRef& b) { return a.compare(b) < 0; }
+
+inline std::string operator+(const std::string& a, const StringRef& b) {
+    std::string s(a);
+    s.append(b.data(), b.size());
+    return s;
+}
+
+// Seeds with `h` and mixes in `s`, eight bytes at a time; chains of calls
+// hash a sequence of strings.
+uint64_t HashString(uint64_t h, const StringRef& s);
+
+// Append-only store of deduplicated strings. Characters live in large
+// blocks that never move, so a StringRef stays valid for the arena's
+// lifetime; identical strings are stored once and share a StringRef.
+class StringArena {
+public:
+    explicit StringArena(size_t expectedBytes = 0);
+
+    StringArena(const StringArena&) = delete;
+    StringArena& operator=(const StringArena&) = delete;
+
+    StringRef Intern(const StringRef& s);
+
+    // Frees the lookup table once nothing more will be interned.
+    void Seal();
+
+    // Bytes held by the blocks and the lookup table.
+    size_t MemoryUsage() const;
+
+private:
+    std::vector<std::unique_ptr<char[]>> blocks;
+    size_t blockSize;
+    size_t blockUsed;
+    size_t blockBytes;
+    std::vector<StringRef> slots;  // open addressing; data() == nullptr is empty
+    size_t count;
+
+    StringRef Store(const StringRef& s);
+    void Grow();
+};
@@ -0,0 +1,269 @@
+#include "volume_scanner.h"
+#include <algorithm>
+#include <atomic>
+#include <dirent.h>
+#include <fcntl.h>
+#include <memory>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+// Layout of the records getdents64 fills in; glibc has no declaration.
+struct LinuxDirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[1];
+};
+
+const size_t kListBufferSize = 64 * 1024;
+const size_t kMaxThreads = 16;
+
+int64_t MtimeNs(const struct stat& st) {
+    return static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+}
+
+// Bytes allocated on disk, which is what `du` reports.
+int64_t DiskBytes(const struct stat& st) {
+    return static_cast<int64_t>(st.st_blocks) * 512;
+}
+
+bool IsDotOrDotDot(const char* name) {
+    return name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'));
+}
+
+// Volume names come from the daemon, but end up in a path.
+bool IsPlainName(const std::string& name) {
+    return !name.empty() && name.find('/') == std::string::npos && name != "." && name != "..";
+}
+
+}  // namespace
+
+// State of one Scan(), shared by its threads.
+struct VolumeScanner::Walk {
+    std::vector<int> rootFds;      // per volume, -1 if it cannot be opened
+    std::vector<uint64_t> devices;  // per volume; other file systems mounted inside are skipped
+    std::unique_ptr<std::atomic<int64_t>[]> bytes;
+    std::unique_ptr<Queue[]> queues;
+    size_t queueCount;
+    std::atomic<size_t> pending;  // tasks queued or being visited
+    std::atomic<size_t> directories;
+    std::atomic<size_t> listed;
+    std::atomic<size_t> files;
+    std::chrono::steady_clock::time_point now;
+
+    Walk() : queueCount(0), pending(0), directories(0), listed(0), files(0) {}
+};
+
+VolumeScanner::VolumeScanner(const std::string& root, size_t threads)
+    : root(root), threadCount(threads), maxAge(std::chrono::minutes(5)), generation(0) {
+    if (threadCount == 0) {
+        threadCount = std::min<size_t>(std::max(4u, std::thread::hardware_concurrency()),
+                                       kMaxThreads);
+    }
+}
+
+void VolumeScanner::SetRoot(const std::string& newRoot) {
+    root = newRoot;
+    for (Shard& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.dirs.clear();
+    }
+}
+
+bool VolumeScanner::IsAvailable() const {
+    return access(root.c_str(), R_OK | X_OK) == 0;
+}
+
+std::unordered_map<std::string, int64_t> VolumeScanner::Scan(
+        const std::vector<std::string>& names, Stats* stats) {
+    ++generation;
+
+    std::vector<std::string> volumes;
+    std::unordered_map<std::string, int64_t> sizes;
+    for (const auto& name : names) {
+        if (sizes.insert({name, -1}).second && IsPlainName(name)) volumes.push_back(name);
+    }
+
+    Walk walk;
+    walk.now = std::chrono::steady_clock::now();
+    walk.bytes.reset(new std::atomic<int64_t>[volumes.size()]);
+    walk.queueCount = threadCount;
+    walk.queues.reset(new Queue[threadCount]);
+    for (size_t i = 0; i < volumes.size(); ++i) {
+        walk.bytes[i] = 0;
+        const std::string dir = root + "/" + volumes[i] + "/_data";
+        int fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        struct stat st;
+        if (fd >= 0 && fstat(fd, &st) != 0) {
+            close(fd);
+            fd = -1;
+        }
+        walk.rootFds.push_back(fd);
+        walk.devices.push_back(fd >= 0 ? static_cast<uint64_t>(st.st_dev) : 0);
+        if (fd < 0) continue;
+        // Volumes are dealt out round-robin; stealing evens out the rest.
+        walk.queues[i % threadCount].tasks.push_back(Task{i, std::string()});
+        ++walk.pending;
+    }
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < threadCount && walk.pending > 0; ++i) {
+        threads.emplace_back([this, &walk, i] { Worker(walk, i); });
+    }
+    Worker(walk, 0);
+    for (auto& thread : threads) thread.join();
+
+    for (size_t i = 0; i < volumes.size(); ++i) {
+        if (walk.rootFds[i] < 0) continue;
+        close(walk.rootFds[i]);
+        sizes[volumes[i]] = walk.bytes[i];
+    }
+    Evict();
+
+    if (stats) {
+        stats->directories = walk.directories;
+        stats->listed = walk.listed;
+        stats->files = walk.files;
+    }
+    return sizes;
+}
+
+void VolumeScanner::Worker(Walk& walk, size_t self) {
+    std::vector<char> buffer(kListBufferSize);
+    unsigned idle = 0;
+    while (walk.pending > 0) {
+        Task task;
+        if (!NextTask(walk, self, task)) {
+            // Someone is still listing a directory that may add work.
+            if (++idle < 64) {
+                std::this_thread::yield();
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+            continue;
+        }
+        idle = 0;
+        Visit(walk, self, task, buffer);
+        --walk.pending;
+    }
+}
+
+bool VolumeScanner::NextTask(Walk& walk, size_t self, Task& task) {
+    // Newest first from our own queue keeps the walk depth-first and the
+    // paths it holds few; the oldest of someone else's is the biggest
+    // subtree left to take.
+    {
+        Queue& own = walk.queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for (size_t i = 1; i < walk.queueCount; ++i) {
+        Queue& other = walk.queues[(self + i) % walk.queueCount];
+        std::lock_guard<std::mutex> lock(other.mutex);
+        if (other.tasks.empty()) continue;
+        task = std::move(other.tasks.front());
+        other.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void VolumeScanner::Visit(Walk& walk, size_t self, const Task& task, std::vector<char>& buffer) {
+    const char* path = task.path.empty() ? "." : task.path.c_str();
+    int fd = openat(walk.rootFds[task.volume], path,
+                    O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd < 0) return;  // removed since it was listed, or not readable
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<uint64_t>(st.st_dev) != walk.devices[task.volume]) {
+        close(fd);
+        return;
+    }
+    ++walk.directories;
+
+    const DirKey key{static_cast<uint64_t>(st.st_dev), static_cast<uint64_t>(st.st_ino)};
+    Shard& shard = shards[DirKeyHash()(key) % kShards];
+    int64_t bytes = 0;
+    std::vector<std::string> subdirs;
+    bool cached = false;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.dirs.find(key);
+        if (it != shard.dirs.end() && it->second.mtimeNs == MtimeNs(st) &&
+            walk.now - it->second.listedAt < maxAge) {
+            it->second.generation = generation;
+            bytes = it->second.bytes;
+            subdirs = it->second.subdirs;
+            cached = true;
+        }
+    }
+
+    if (!cached) {
+        ++walk.listed;
+        bytes = DiskBytes(st);
+        for (;;) {
+            long n = syscall(SYS_getdents64, fd, buffer.data(), buffer.size());
+            if (n <= 0) break;
+            for (long offset = 0; offset < n;) {
+                const LinuxDirent64* entry =
+                    reinterpret_cast<const LinuxDirent64*>(buffer.data() + offset);
+                offset += entry->d_reclen;
+                if (IsDotOrDotDot(entry->d_name)) continue;
+                if (entry->d_type == DT_DIR) {
+                    subdirs.push_back(entry->d_name);
+                    continue;
+                }
+                struct stat child;
+                if (fstatat(fd, entry->d_name, &child, AT_SYMLINK_NOFOLLOW) != 0) continue;
+                if (S_ISDIR(child.st_mode)) {
+                    subdirs.push_back(entry->d_name);  // d_type was DT_UNKNOWN
+                    continue;
+                }
+                ++walk.files;
+                bytes += DiskBytes(child);
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        CachedDir& entry = shard.dirs[key];
+        entry.mtimeNs = MtimeNs(st);
+        entry.bytes = bytes;
+        entry.subdirs = subdirs;
+        entry.listedAt = walk.now;
+        entry.generation = generation;
+    }
+    close(fd);
+
+    walk.bytes[task.volume] += bytes;
+    if (subdirs.empty()) return;
+    walk.pending += subdirs.size();
+    Queue& own = walk.queues[self];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    for (auto& name : subdirs) {
+        own.tasks.push_back(Task{task.volume,
+                                 task.path.empty() ? std::move(name) : task.path + '/' + name});
+    }
+}
+
+void VolumeScanner::Evict() {
+    // Directories this scan did not reach were removed, or belong to
+    // volumes that are gone.
+    for (Shard& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (auto it = shard.dirs.begin(); it != shard.dirs.end();) {
+            if (it->second.generation == generation) {
+                ++it;
+            } else {
+                it = shard.dirs.erase(it);
+            }
+        }
+    }
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Disk use of local-driver volumes, measured by walking their directories
+// under the daemon's volume root (`<root>/<name>/_data`) the way `du` does:
+// allocated blocks of every file and directory (a hard-linked file counts
+// once per link, as with `du -l`).
+// `docker system df -v` walks volumes one at a time; this walks all of them
+// at once on several threads, each taking subtrees from the others when it
+// runs out.
+//
+// What a directory holds is cached by inode and mtime, so a rescan lists
+// only the directories whose entries changed. A file that grows in place
+// leaves its directory's mtime alone, so cached directories are still
+// re-read once they are older than the maximum age.
+//
+// Scan() may run on any thread, one at a time.
+class VolumeScanner {
+public:
+    explicit VolumeScanner(const std::string& root = "/var/lib/docker/volumes",
+                           size_t threads = 0);
+
+    // Drops the cache along with the old root.
+    void SetRoot(const std::string& root);
+    const std::string& GetRoot() const { return root; }
+
+    void SetMaxAge(std::chrono::seconds age) { maxAge = age; }
+
+    // True when the root can be listed; it usually takes root privileges.
+    bool IsAvailable() const;
+
+    struct Stats {
+        size_t directories = 0;  // opened
+        size_t listed = 0;       // of those, read because the cache had nothing
+        size_t files = 0;        // stat'ed while listing
+    };
+
+    // Bytes per volume name; -1 for volumes whose directory cannot be opened.
+    std::unordered_map<std::string, int64_t> Scan(const std::vector<std::string>& names,
+                                                  Stats* stats = nullptr);
+
+private:
+    struct DirKey {
+        uint64_t dev;
+        uint64_t ino;
+        bool operator==(const DirKey& other) const {
+            return dev == other.dev && ino == other.ino;
+        }
+    };
+    struct DirKeyHash {
+        size_t operator()(const DirKey& key) const {
+            return static_cast<size_t>(key.ino * 0x9E3779B97F4A7C15ull ^ key.dev);
+        }
+    };
+    struct CachedDir {
+        int64_t mtimeNs;
+        int64_t bytes;                     // the directory and its files, not subdirectories
+        std::vector<std::string> subdirs;
+        std::chrono::steady_clock::time_point listedAt;
+        uint32_t generation;               // last scan that reached it
+    };
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<DirKey, CachedDir, DirKeyHash> dirs;
+    };
+    static const size_t kShards = 16;
+
+    struct Task {
+        size_t volume;
+        std::string path;  // relative to the volume's directory, "" for itself
+    };
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+    struct Walk;
+
+    std::string root;
+    size_t threadCount;
+    std::chrono::seconds maxAge;
+    uint32_t generation;
+    Shard shards[kShards];
+
+    void Worker(Walk& walk, size_t self);
+    bool NextTask(Walk& walk, size_t self, Task& task);
+    void Visit(Walk& walk, size_t self, const Task& task, std::vector<char>& buffer);
+    void Evict();
+};
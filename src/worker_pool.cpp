@@ -0,0 +1,57 @@
+#include "worker_pool.h"
+
+WorkerPool::WorkerPool(size_t threadCount) : nextSequence(0), stopping(false) {
+    if (threadCount == 0) threadCount = 1;
+    threads.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        threads.emplace_back(&WorkerPool::WorkerLoop, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    Shutdown();
+}
+
+bool WorkerPool::Submit(Task task, Priority priority) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) return false;
+        queue.push(Entry{priority, nextSequence++, std::move(task)});
+    }
+    cond.notify_one();
+    return true;
+}
+
+void WorkerPool::Shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping && threads.empty()) return;
+        stopping = true;
+        while (!queue.empty()) queue.pop();
+    }
+    cond.notify_all();
+    for (auto& t : threads) {
+        if (t.joinable()) t.join();
+    }
+    threads.clear();
+}
+
+size_t WorkerPool::Pending() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return queue.size();
+}
+
+void WorkerPool::WorkerLoop() {
+    for (;;) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cond.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (stopping) return;
+            // priority_queue::top() is const; the entry is popped right after.
+            task = std::move(const_cast<Entry&>(queue.top()).task);
+            queue.pop();
+        }
+        task();
+    }
+}
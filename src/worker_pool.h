@@ -0,0 +1,54 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Fixed set of long-lived threads draining a priority queue. Tasks of equal
+// priority run in submission order.
+class WorkerPool {
+public:
+    enum Priority {
+        Background = 0,   // periodic refreshes
+        Normal = 1,
+        Interactive = 2   // user-initiated actions
+    };
+    typedef std::function<void()> Task;
+
+    explicit WorkerPool(size_t threadCount);
+    ~WorkerPool();
+
+    // Returns false once Shutdown() has been called.
+    bool Submit(Task task, Priority priority = Normal);
+
+    // Drops queued tasks and waits for the running ones to finish.
+    void Shutdown();
+
+    size_t Pending() const;
+
+private:
+    struct Entry {
+        int priority;
+        uint64_t sequence;
+        Task task;
+    };
+    struct Order {
+        bool operator()(const Entry& a, const Entry& b) const {
+            if (a.priority != b.priority) return a.priority < b.priority;
+            return a.sequence > b.sequence;
+        }
+    };
+
+    void WorkerLoop();
+
+    mutable std::mutex mutex;
+    std::condition_variable cond;
+    std::priority_queue<Entry, std::vector<Entry>, Order> queue;
+    std::vector<std::thread> threads;
+    uint64_t nextSequence;
+    bool stopping;
+};
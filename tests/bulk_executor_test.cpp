@@ -0,0 +1,80 @@
+#include "bulk_executor.h"
+#include "check.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::vector<std::string> Targets(size_t count) {
+    std::vector<std::string> targets;
+    for (size_t i = 0; i < count; ++i) targets.push_back("t" + std::to_string(i));
+    return targets;
+}
+
+void TestResultsAndConcurrency() {
+    std::atomic<int> running(0);
+    std::atomic<int> peak(0);
+    auto operation = [&running, &peak](const std::string& target, std::string* error) {
+        int now = ++running;
+        int seen = peak;
+        while (now > seen && !peak.compare_exchange_weak(seen, now)) {}
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        --running;
+        if (target == "t3") {
+            *error = "refused";
+            return false;
+        }
+        return true;
+    };
+
+    std::vector<BulkItemResult> results = BulkExecutor(4).Run(Targets(20), operation);
+    CHECK(results.size() == 20);
+    for (size_t i = 0; i < results.size(); ++i) {
+        CHECK(results[i].target == "t" + std::to_string(i));
+        CHECK(results[i].success == (i != 3));
+    }
+    CHECK(results[3].error == "refused");
+    CHECK(peak > 1 && peak <= 4);
+    CHECK(BulkExecutor::Summarize(results) == "1 of 20 failed: t3: refused");
+}
+
+void TestCancel() {
+    auto operation = [](const std::string&, std::string*) { return true; };
+    int calls = 0;
+    auto progress = [&calls](int done, int total) {
+        ++calls;
+        CHECK(total == 10);
+        return done < 2;
+    };
+    std::vector<BulkItemResult> results = BulkExecutor(1).Run(Targets(10), operation, progress);
+    CHECK(calls == 2);
+    CHECK(results[0].success && results[1].success);
+    for (size_t i = 2; i < results.size(); ++i) {
+        CHECK(!results[i].success && results[i].error == "cancelled");
+    }
+}
+
+void TestNested() {
+    // Every pool thread blocks in an inner run; the callers finish the work.
+    auto inner = [](const std::string&, std::string*) { return true; };
+    auto outer = [&inner](const std::string&, std::string*) {
+        std::vector<BulkItemResult> results = BulkExecutor(8).Run(Targets(8), inner);
+        return std::all_of(results.begin(), results.end(),
+                           [](const BulkItemResult& r) { return r.success; });
+    };
+    std::vector<BulkItemResult> results = BulkExecutor(16).Run(Targets(32), outer);
+    for (const auto& r : results) CHECK(r.success);
+}
+
+}  // namespace
+
+int main() {
+    TestResultsAndConcurrency();
+    TestCancel();
+    TestNested();
+    return 0;
+}
@@ -0,0 +1,129 @@
+#include "cgroup_stats.h"
+#include "check.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+const std::string kId(64, 'a');
+const std::string kOtherId(64, 'b');
+
+void WriteFile(const std::string& path, const std::string& text) {
+    std::ofstream out(path, std::ios::trunc);
+    out << text;
+}
+
+// A container's cgroup directory with the four files the reader opens.
+void WriteCgroup(const std::string& dir, uint64_t usageUsec, uint64_t memory) {
+    mkdir(dir.c_str(), 0755);
+    WriteFile(dir + "/cpu.stat", "usage_usec " + std::to_string(usageUsec) +
+                                     "\nuser_usec 0\nsystem_usec 0\n");
+    WriteFile(dir + "/memory.current", std::to_string(memory) + "\n");
+    WriteFile(dir + "/memory.stat", "anon 1\ninactive_file 1000\nactive_file 5\n");
+    WriteFile(dir + "/io.stat", "8:0 rbytes=100 wbytes=20 rios=1 wios=1\n"
+                                "8:16 rbytes=50 wbytes=5 rios=1 wios=1\n");
+}
+
+void RemoveCgroup(const std::string& dir) {
+    for (const char* file : {"cpu.stat", "memory.current", "memory.stat", "io.stat"}) {
+        unlink((dir + "/" + file).c_str());
+    }
+    rmdir(dir.c_str());
+}
+
+const ContainerStats* Find(const std::vector<ContainerStats>& rows, const std::string& id) {
+    for (const auto& row : rows) {
+        if (row.id == id.substr(0, 12)) return &row;
+    }
+    return nullptr;
+}
+
+}  // namespace
+
+int main() {
+    char rootTemplate[] = "/tmp/cgroup-test-XXXXXX";
+    CHECK(mkdtemp(rootTemplate));
+    const std::string root = rootTemplate;
+
+    CgroupStatsReader reader(root);
+    CHECK(!reader.IsAvailable());
+    WriteFile(root + "/cgroup.controllers", "cpu io memory\n");
+    mkdir((root + "/system.slice").c_str(), 0755);
+    mkdir((root + "/docker").c_str(), 0755);
+    CHECK(reader.IsAvailable());
+
+    // One container per cgroup driver layout.
+    const std::string scope = root + "/system.slice/docker-" + kId + ".scope";
+    const std::string plain = root + "/docker/" + kOtherId;
+    WriteCgroup(scope, 1000000, 50000);
+    WriteCgroup(plain, 2000000, 8000);
+    mkdir((root + "/system.slice/cron.service").c_str(), 0755);
+
+    std::vector<ContainerStats> rows;
+    CHECK(reader.Sample(rows));
+    CHECK(rows.size() == 2);
+    const ContainerStats* row = Find(rows, kId);
+    CHECK(row && row->cpu_percent == 0.0);
+    CHECK(row->mem_bytes == 49000);
+    CHECK(row->block_read == 150 && row->block_write == 25);
+    CHECK(Find(rows, kOtherId) && Find(rows, kOtherId)->mem_bytes == 7000);
+
+    // The files stay open; new contents show up on the next sample.
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    WriteCgroup(scope, 1000000 + 25000, 60000);
+    CHECK(reader.Sample(rows));
+    row = Find(rows, kId);
+    CHECK(row && row->cpu_percent > 0.0 && row->cpu_percent <= 50.0);
+    CHECK(row->mem_bytes == 59000);
+
+    // A restart replaces the cgroup directory under the same name before
+    // the next sample. The old directory is moved aside first so the new
+    // one cannot reuse its inode.
+    const std::string aside = root + "/system.slice/old";
+    CHECK(rename(scope.c_str(), aside.c_str()) == 0);
+    WriteCgroup(scope, 300, 90000);
+    RemoveCgroup(aside);
+    CHECK(reader.Sample(rows));
+    row = Find(rows, kId);
+    CHECK(row && row->mem_bytes == 89000);
+    // Counters restarted from zero: no rate until the next sample.
+    CHECK(row->cpu_percent == 0.0);
+
+    // A stopped container drops out.
+    RemoveCgroup(plain);
+    CHECK(reader.Sample(rows));
+    CHECK(rows.size() == 1 && !Find(rows, kOtherId));
+
+    // The daemon's running containers, by short or full ID, have scopes.
+    CHECK(reader.Covers({kId.substr(0, 12)}, rows) && rows.size() == 1);
+    CHECK(reader.Covers({kId, kOtherId}, rows));
+    CHECK(reader.Covers({}, rows));
+
+    // Rootless Docker keeps its containers under user.slice. system.slice
+    // still exists, so the tree looks usable but never shows them.
+    RemoveCgroup(scope);
+    mkdir((root + "/user.slice").c_str(), 0755);
+    const std::string rootless = root + "/user.slice/docker-" + kOtherId + ".scope";
+    WriteCgroup(rootless, 500, 1000);
+    CHECK(reader.IsAvailable());
+    CHECK(reader.Sample(rows) && rows.empty());
+    CHECK(!reader.Covers({kOtherId.substr(0, 12)}, rows));
+    // With nothing running there is nothing to miss.
+    CHECK(reader.Covers({}, rows));
+    RemoveCgroup(rootless);
+    rmdir((root + "/user.slice").c_str());
+
+    rmdir((root + "/system.slice/cron.service").c_str());
+    rmdir((root + "/system.slice").c_str());
+    rmdir((root + "/docker").c_str());
+    unlink((root + "/cgroup.controllers").c_str());
+    rmdir(root.c_str());
+    return 0;
+}
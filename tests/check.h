@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+
+// Stops the test at the first failed check; ctest reports the exit code.
+#define CHECK(condition)                                                             \
+    do {                                                                             \
+        if (!(condition)) {                                                          \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__,   \
+                         #condition);                                                \
+            std::exit(1);                                                            \
+        }                                                                            \
+    } while (0)
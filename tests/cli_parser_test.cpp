@@ -0,0 +1,78 @@
+#include "check.h"
+#include "cli_parser.h"
+#include "stats_collector.h"
+#include <clocale>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Pair {
+    std::string a;
+    std::string b;
+};
+typedef DelimitedParser<Pair, &Pair::a, &Pair::b> PairParser;
+
+void TestParse() {
+    std::vector<std::string> malformed;
+    std::vector<Pair> pairs = PairParser::Parse("x|1\r\n\nonly\ny|2|extra\nz|\n", &malformed);
+    CHECK(pairs.size() == 2);
+    CHECK(pairs[0].a == "x" && pairs[0].b == "1");
+    CHECK(pairs[1].a == "z" && pairs[1].b.empty());
+    CHECK(malformed.size() == 2);
+    CHECK(malformed[0] == "only" && malformed[1] == "y|2|extra");
+
+    Pair pair;
+    CHECK(PairParser::ParseRecord("k|v", 3, pair) && pair.a == "k" && pair.b == "v");
+    CHECK(!PairParser::ParseRecord("k", 1, pair));
+    CHECK(!PairParser::ParseRecord("k|v|w", 5, pair));
+}
+
+void TestForEachField() {
+    std::vector<std::string> fields;
+    ForEachField(",app:1,,app:latest,", ',', [&fields](const char* p, size_t n) {
+        fields.emplace_back(p, n);
+    });
+    CHECK(fields.size() == 2);
+    CHECK(fields[0] == "app:1" && fields[1] == "app:latest");
+}
+
+void TestParsePercent() {
+    // A locale with a decimal comma must not change the result.
+    std::setlocale(LC_NUMERIC, "de_DE.UTF-8");
+    double value = -1.0;
+    CHECK(ParsePercent("12.5%", value) && value > 12.49 && value < 12.51);
+    CHECK(ParsePercent("0.00%", value) && value == 0.0);
+    CHECK(ParsePercent("250", value) && value == 250.0);
+    value = 3.0;
+    CHECK(!ParsePercent("--", value) && value == 3.0);
+    CHECK(!ParsePercent("", value));
+    CHECK(!ParsePercent("1,5%", value));
+    std::setlocale(LC_NUMERIC, "C");
+}
+
+void TestStatsLine() {
+    ContainerStats stats;
+    CHECK(StatsCollector::ParseLine(
+        "0123456789ab|web|1.50%|12.5MiB / 1.944GiB|1.2kB / 3.4MB|0B / 8.19kB", stats));
+    CHECK(stats.id == "0123456789ab" && stats.name == "web");
+    CHECK(stats.cpu_percent > 1.49 && stats.cpu_percent < 1.51);
+    CHECK(stats.mem_bytes == 13107200);
+    CHECK(stats.has_net_io && stats.net_rx == 1200 && stats.net_tx == 3400000);
+    CHECK(stats.block_read == 0 && stats.block_write == 8190);
+
+    CHECK(StatsCollector::ParseLine("0123456789ab|web|--|-- / --|-- / --|-- / --", stats));
+    CHECK(stats.cpu_percent == 0.0 && stats.mem_bytes == 0);
+    CHECK(!StatsCollector::ParseLine("0123456789ab|web|1.50%", stats));
+    CHECK(!StatsCollector::ParseLine("", stats));
+}
+
+}  // namespace
+
+int main() {
+    TestParse();
+    TestForEachField();
+    TestParsePercent();
+    TestStatsLine();
+    return 0;
+}
@@ -0,0 +1,191 @@
+#include "check.h"
+#include "docker_api.h"
+#include "docker_commands.h"
+#include "fake_engine.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+DockerApiClient& Api(const FakeEngine& engine) {
+    DockerApiClient& api = DockerApiClient::Instance();
+    api.SetSocketPath(engine.Path());
+    return api;
+}
+
+void TestContentLength() {
+    FakeEngine engine;
+    engine.Push(FakeEngine::Response(200, "OK"));
+    HttpResponse response;
+    CHECK(Api(engine).Request("GET", "/_ping", response));
+    CHECK(response.status == 200);
+    CHECK(response.body == "OK");
+    CHECK(engine.Requests().size() == 1);
+    CHECK(engine.Requests()[0] == "GET /_ping HTTP/1.1");
+}
+
+void TestChunked() {
+    FakeEngine engine;
+    engine.Push("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n"
+                "5\r\nhello\r\n6;ext=1\r\n world\r\n0\r\nX-Trailer: 1\r\n\r\n");
+    engine.Push(FakeEngine::Response(200, "again"));
+    DockerApiClient& api = Api(engine);
+    HttpResponse response;
+    CHECK(api.Request("GET", "/version", response));
+    CHECK(response.status == 200);
+    CHECK(response.body == "hello world");
+    // The chunked body was read to its end, so the connection is reusable.
+    CHECK(api.Request("GET", "/version", response));
+    CHECK(response.body == "again");
+    CHECK(engine.Connections() == 1);
+}
+
+void TestKeepAliveAndStaleConnection() {
+    FakeEngine engine;
+    engine.Push(FakeEngine::Response(200, "1"));
+    engine.Push(FakeEngine::Response(200, "2"), true);  // closes after answering
+    engine.Push(FakeEngine::Response(200, "3"));
+    DockerApiClient& api = Api(engine);
+    HttpResponse response;
+    CHECK(api.Request("GET", "/a", response) && response.body == "1");
+    CHECK(api.Request("GET", "/b", response) && response.body == "2");
+    CHECK(engine.Connections() == 1);
+    // The pooled connection is dead now; the request is retried on a new one.
+    CHECK(api.Request("GET", "/c", response) && response.body == "3");
+    CHECK(engine.Connections() == 2);
+}
+
+void TestErrorStatus() {
+    FakeEngine engine;
+    engine.Push(FakeEngine::Response(404, "{\"message\":\"No such container: x\"}"));
+    HttpResponse response;
+    CHECK(Api(engine).Request("GET", "/containers/x/json", response));
+    CHECK(response.status == 404);
+    CHECK(DockerApiClient::ErrorMessage(response.status, response.body) ==
+          "No such container: x");
+    CHECK(DockerApiClient::ErrorMessage(502, "<html>") == "HTTP 502");
+}
+
+void TestTimeout() {
+    FakeEngine engine;
+    engine.PushHang();
+    engine.Push(FakeEngine::Response(200, "late"));
+    DockerApiClient& api = Api(engine);
+    HttpResponse response;
+    std::string error;
+    const auto started = std::chrono::steady_clock::now();
+    CHECK(!api.Request("GET", "/hang", response, &error, 200));
+    const auto elapsed = std::chrono::steady_clock::now() - started;
+    CHECK(elapsed >= std::chrono::milliseconds(200));
+    CHECK(elapsed < std::chrono::seconds(2));
+    CHECK(error.find("timed out") != std::string::npos);
+    // The hung connection was dropped rather than pooled.
+    CHECK(api.Request("GET", "/next", response) && response.body == "late");
+    CHECK(engine.Connections() == 2);
+}
+
+void TestStream() {
+    FakeEngine engine;
+    engine.Push("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n"
+                "6\r\nevent1\r\n6\r\nevent2\r\n0\r\n\r\n");
+    int status = 0;
+    std::string received;
+    bool statusKnown = true;
+    auto onData = [&status, &received, &statusKnown](const char* data, size_t size) {
+        if (data) {
+            statusKnown = statusKnown && status == 200;
+            received.append(data, size);
+        }
+        return true;
+    };
+    CHECK(Api(engine).Stream("GET", "/events", onData, &status));
+    CHECK(status == 200);
+    CHECK(statusKnown);
+    CHECK(received == "event1event2");
+}
+
+void TestStreamError() {
+    FakeEngine engine;
+    engine.Push(FakeEngine::Response(500, "{\"message\":\"daemon is shutting down\"}"));
+    int status = 0;
+    std::string error;
+    bool gotData = false;
+    auto onData = [&gotData](const char* data, size_t) {
+        if (data) gotData = true;
+        return true;
+    };
+    CHECK(Api(engine).Stream("GET", "/events", onData, &status, &error));
+    CHECK(status == 500);
+    CHECK(!gotData);
+    CHECK(error == "daemon is shutting down");
+}
+
+void TestListStatus() {
+    // Keeps the CLI fallback away from any real daemon.
+    setenv("DOCKER_HOST", "unix:///nonexistent/docker.sock", 1);
+
+    FakeEngine engine;
+    engine.Push(FakeEngine::Response(
+        200, "[{\"Id\":\"0123456789abcdef\",\"Names\":[\"/web\"],\"State\":\"running\","
+             "\"Status\":\"Up 2 minutes\",\"Image\":\"nginx\"}]"));
+    engine.Push(FakeEngine::Response(500, "{\"message\":\"boom\"}"));
+    Api(engine);
+
+    std::vector<ContainerInfo> containers;
+    CHECK(DockerCommands::GetAllContainers(containers));
+    CHECK(containers.size() == 1);
+    CHECK(containers[0].id == "0123456789ab");
+    CHECK(containers[0].name == "web");
+    // An error status is a failure, not an empty list.
+    CHECK(!DockerCommands::GetAllContainers(containers));
+    CHECK(containers.empty());
+}
+
+void TestCliMalformed() {
+    // A `docker` whose listing has one line with a missing field.
+    char dirTemplate[] = "/tmp/fake-docker-XXXXXX";
+    CHECK(mkdtemp(dirTemplate));
+    const std::string dir = dirTemplate;
+    const std::string script = dir + "/docker";
+    FILE* file = std::fopen(script.c_str(), "w");
+    CHECK(file);
+    std::fputs("#!/bin/sh\n"
+               "printf '0123456789ab|web|running|Up|nginx\\nfedcba987654|db|exited\\n'\n",
+               file);
+    std::fclose(file);
+    chmod(script.c_str(), 0755);
+    const char* path = std::getenv("PATH");
+    const std::string oldPath = path ? path : "/usr/bin:/bin";
+    setenv("PATH", (dir + ":" + oldPath).c_str(), 1);
+    DockerApiClient::Instance().SetSocketPath("");
+
+    // Half a listing is a failure, like a JSON body that does not parse.
+    std::vector<ContainerInfo> containers;
+    CHECK(!DockerCommands::GetAllContainers(containers));
+    // Callers without an error path still get the well-formed rows.
+    containers = DockerCommands::GetRunningContainers();
+    CHECK(containers.size() == 1);
+    CHECK(containers[0].name == "web");
+
+    setenv("PATH", oldPath.c_str(), 1);
+    unlink(script.c_str());
+    rmdir(dir.c_str());
+}
+
+}  // namespace
+
+int main() {
+    TestContentLength();
+    TestChunked();
+    TestKeepAliveAndStaleConnection();
+    TestErrorStatus();
+    TestTimeout();
+    TestStream();
+    TestStreamError();
+    TestListStatus();
+    TestCliMalformed();
+    return 0;
+}
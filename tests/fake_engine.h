@@ -0,0 +1,170 @@
+#pragma once
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// Stands in for the Docker daemon on a Unix socket in a temporary
+// directory. Each request, on whichever connection, takes the next
+// scripted reply: raw bytes written back as they are, after which the
+// connection is closed or kept open. A reply can also hang, answering
+// nothing at all.
+class FakeEngine {
+public:
+    struct Reply {
+        std::string raw;
+        bool close = false;
+        bool hang = false;
+    };
+
+    FakeEngine() : listenFd(-1), stopping(false), connections(0) {
+        char dir[] = "/tmp/fake-engine-XXXXXX";
+        if (mkdtemp(dir)) directory = dir;
+        path = directory + "/docker.sock";
+
+        sockaddr_un addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+            listen(listenFd, 16) != 0) {
+            std::abort();
+        }
+        thread = std::thread(&FakeEngine::Serve, this);
+    }
+
+    ~FakeEngine() {
+        stopping = true;
+        thread.join();
+        close(listenFd);
+        unlink(path.c_str());
+        rmdir(directory.c_str());
+    }
+
+    const std::string& Path() const { return path; }
+
+    void Push(const std::string& raw, bool closeAfter = false) {
+        Reply reply;
+        reply.raw = raw;
+        reply.close = closeAfter;
+        std::lock_guard<std::mutex> lock(mutex);
+        replies.push_back(reply);
+    }
+
+    void PushHang() {
+        Reply reply;
+        reply.hang = true;
+        std::lock_guard<std::mutex> lock(mutex);
+        replies.push_back(reply);
+    }
+
+    // "GET /_ping HTTP/1.1" and so on, in the order they arrived.
+    std::vector<std::string> Requests() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return requests;
+    }
+
+    int Connections() const { return connections; }
+
+    // A complete HTTP/1.1 response with a Content-Length body.
+    static std::string Response(int status, const std::string& body) {
+        return "HTTP/1.1 " + std::to_string(status) + " Status\r\n"
+               "Content-Type: application/json\r\n"
+               "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+    }
+
+private:
+    struct Client {
+        int fd;
+        std::string pending;
+    };
+
+    std::string directory;
+    std::string path;
+    int listenFd;
+    std::thread thread;
+    std::atomic<bool> stopping;
+    std::atomic<int> connections;
+    mutable std::mutex mutex;
+    std::deque<Reply> replies;
+    std::vector<std::string> requests;
+
+    void Serve() {
+        std::vector<Client> clients;
+        while (!stopping) {
+            std::vector<pollfd> fds;
+            fds.push_back({listenFd, POLLIN, 0});
+            for (const Client& client : clients) fds.push_back({client.fd, POLLIN, 0});
+            if (poll(fds.data(), fds.size(), 20) <= 0) continue;
+
+            if (fds[0].revents & POLLIN) {
+                int fd = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+                if (fd >= 0) {
+                    clients.push_back({fd, std::string()});
+                    ++connections;
+                }
+            }
+            for (size_t i = 1; i < fds.size(); ++i) {
+                if (!(fds[i].revents & (POLLIN | POLLHUP))) continue;
+                Client& client = clients[i - 1];
+                char buffer[4096];
+                ssize_t n = read(client.fd, buffer, sizeof(buffer));
+                if (n <= 0) {
+                    close(client.fd);
+                    client.fd = -1;
+                    continue;
+                }
+                client.pending.append(buffer, n);
+                // The client never sends a request body.
+                size_t end;
+                while (client.fd >= 0 && (end = client.pending.find("\r\n\r\n")) !=
+                                             std::string::npos) {
+                    Answer(client, client.pending.substr(0, client.pending.find("\r\n")));
+                    client.pending.erase(0, end + 4);
+                }
+            }
+            std::vector<Client> open;
+            for (const Client& client : clients) {
+                if (client.fd >= 0) open.push_back(client);
+            }
+            clients.swap(open);
+        }
+        for (const Client& client : clients) close(client.fd);
+    }
+
+    void Answer(Client& client, const std::string& requestLine) {
+        Reply reply;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            requests.push_back(requestLine);
+            if (replies.empty()) {
+                reply.raw = Response(500, "{\"message\":\"no reply scripted\"}");
+            } else {
+                reply = replies.front();
+                replies.pop_front();
+            }
+        }
+        if (reply.hang) return;
+        size_t sent = 0;
+        while (sent < reply.raw.size()) {
+            ssize_t n = send(client.fd, reply.raw.data() + sent, reply.raw.size() - sent,
+                             MSG_NOSIGNAL);
+            if (n <= 0) break;
+            sent += n;
+        }
+        if (reply.close) {
+            close(client.fd);
+            client.fd = -1;
+        }
+    }
+};
@@ -0,0 +1,63 @@
+#include "check.h"
+#include "docker_api.h"
+#include "log_buffer.h"
+#include "log_follower.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+// A `docker` that writes half a line to stdout, a whole one to stderr,
+// then the rest of the stdout line and a last line without its newline.
+const char kFakeDocker[] =
+    "#!/bin/sh\n"
+    "printf 'out-'\n"
+    "sleep 0.2\n"
+    "printf 'err-line\\n' >&2\n"
+    "sleep 0.2\n"
+    "printf 'start\\ntail'\n";
+
+}  // namespace
+
+int main() {
+    char dirTemplate[] = "/tmp/fake-docker-XXXXXX";
+    CHECK(mkdtemp(dirTemplate));
+    const std::string dir = dirTemplate;
+    const std::string script = dir + "/docker";
+    FILE* file = std::fopen(script.c_str(), "w");
+    CHECK(file);
+    std::fputs(kFakeDocker, file);
+    std::fclose(file);
+    chmod(script.c_str(), 0755);
+
+    const char* path = std::getenv("PATH");
+    setenv("PATH", (dir + ":" + (path ? path : "/usr/bin:/bin")).c_str(), 1);
+    // No socket: the follower goes straight to the CLI.
+    DockerApiClient::Instance().SetSocketPath("");
+
+    LogBuffer buffer(1 << 20);
+    CHECK(buffer.IsValid());
+    LogFollower follower("0123456789ab", buffer);
+    follower.Start();
+    for (int i = 0; i < 500 && !follower.HasEnded(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    CHECK(follower.HasEnded());
+    CHECK(follower.GetError().empty());
+
+    // The streams interleave by whole lines only.
+    std::string line;
+    CHECK(buffer.EndLine() - buffer.FirstLine() == 3);
+    CHECK(buffer.GetLine(buffer.FirstLine(), line) && line == "err-line");
+    CHECK(buffer.GetLine(buffer.FirstLine() + 1, line) && line == "out-start");
+    CHECK(buffer.GetLine(buffer.FirstLine() + 2, line) && line == "tail");
+
+    unlink(script.c_str());
+    rmdir(dir.c_str());
+    return 0;
+}
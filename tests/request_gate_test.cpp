@@ -0,0 +1,86 @@
+#include "check.h"
+#include "request_gate.h"
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+void TestSharedResult() {
+    SingleFlight<int> flight;
+    std::atomic<int> calls(0);
+    std::atomic<bool> release(false);
+    auto slow = [&calls, &release]() {
+        ++calls;
+        while (!release) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        return 42;
+    };
+
+    int first = 0;
+    bool firstShared = true;
+    std::thread leader([&] { first = flight.Do("key", slow, &firstShared); });
+    while (calls == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    int second = 0;
+    bool secondShared = false;
+    std::thread follower([&] { second = flight.Do("key", slow, &secondShared); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    release = true;
+    leader.join();
+    follower.join();
+
+    CHECK(first == 42 && second == 42);
+    CHECK(!firstShared && secondShared);
+    CHECK(calls == 1);
+}
+
+void TestException() {
+    SingleFlight<int> flight;
+    std::atomic<bool> started(false);
+    std::atomic<bool> release(false);
+    auto failing = [&started, &release]() -> int {
+        started = true;
+        while (!release) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        throw std::runtime_error("lost the daemon");
+    };
+
+    bool leaderThrew = false;
+    std::thread leader([&] {
+        try {
+            flight.Do("key", failing);
+        } catch (const std::runtime_error&) {
+            leaderThrew = true;
+        }
+    });
+    while (!started) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    // A waiter sees the same exception instead of blocking forever.
+    bool followerThrew = false;
+    std::thread follower([&] {
+        try {
+            flight.Do("key", [] { return 1; });
+        } catch (const std::runtime_error&) {
+            followerThrew = true;
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    release = true;
+    leader.join();
+    follower.join();
+    CHECK(leaderThrew);
+    CHECK(followerThrew);
+
+    // The key was released, so the next call runs its own function.
+    bool shared = true;
+    CHECK(flight.Do("key", [] { return 7; }, &shared) == 7);
+    CHECK(!shared);
+}
+
+}  // namespace
+
+int main() {
+    TestSharedResult();
+    TestException();
+    return 0;
+}